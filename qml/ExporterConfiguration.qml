@@ -135,6 +135,29 @@ Item {
                 }
             }
 
+            Column {
+                anchors.left: parent.left
+                anchors.right: buttonRow.left
+                anchors.verticalCenter: buttonRow.verticalCenter
+                anchors.leftMargin: 20
+                anchors.rightMargin: 20
+                spacing: 5
+                visible: exporter.busy
+
+                Text {
+                    width: parent.width
+                    elide: Text.ElideRight
+                    font.pointSize: app.idealFontPointSize
+                    text: exporterProgress ? exporterProgress.progressText : ""
+                }
+
+                ProgressBar {
+                    width: parent.width
+                    from: 0; to: 1
+                    value: exporterProgress ? exporterProgress.progress : 0
+                }
+            }
+
             Row {
                 id: buttonRow
                 anchors.right: parent.right
@@ -145,6 +168,10 @@ Item {
                 Button2 {
                     text: "Cancel"
                     onClicked: {
+                        if(exporter.busy) {
+                            exporter.cancel()
+                            return
+                        }
                         exporter.discard()
                         modalDialog.close()
                     }
@@ -155,6 +182,10 @@ Item {
                         if(event.key === Qt.Key_Escape) {
                             result.acceptEvent = true
                             result.filter = true
+                            if(exporter.busy) {
+                                exporter.cancel()
+                                return
+                            }
                             exporter.discard()
                             modalDialog.close()
                         }
@@ -162,13 +193,10 @@ Item {
                 }
 
                 Button2 {
-                    enabled: fileSelector.absoluteFilePath !== ""
+                    enabled: fileSelector.absoluteFilePath !== "" && !exporter.busy
                     text: "Export"
                     onClicked: {
-                        if(exporter.write()) {
-                            app.revealFileOnDesktop(exporter.fileName)
-                            modalDialog.close()
-                        }
+                        exporter.writeInBackground()
                     }
                 }
             }
@@ -176,6 +204,17 @@ Item {
     }
 
     property ErrorReport exporterErrors: Aggregation.findErrorReport(exporter)
+    property ProgressReport exporterProgress: Aggregation.findProgressReport(exporter)
+
+    Connections {
+        target: exporter
+        onFinished: {
+            if(success) {
+                app.revealFileOnDesktop(exporter.fileName)
+                modalDialog.close()
+            }
+        }
+    }
     Notification.title: exporter.formatName + " - Export"
     Notification.text: exporterErrors.errorMessage
     Notification.active: exporterErrors.hasError
@@ -256,6 +256,29 @@ Item {
                 }
             }
 
+            Column {
+                anchors.left: parent.left
+                anchors.right: buttonRow.left
+                anchors.verticalCenter: buttonRow.verticalCenter
+                anchors.leftMargin: 20
+                anchors.rightMargin: 20
+                spacing: 5
+                visible: generator.busy
+
+                Text {
+                    width: parent.width
+                    elide: Text.ElideRight
+                    font.pointSize: app.idealFontPointSize
+                    text: generatorProgress ? generatorProgress.progressText : ""
+                }
+
+                ProgressBar {
+                    width: parent.width
+                    from: 0; to: 1
+                    value: generatorProgress ? generatorProgress.progress : 0
+                }
+            }
+
             Row {
                 id: buttonRow
                 anchors.right: parent.right
@@ -269,6 +292,10 @@ Item {
                     Material.background: primaryColors.c100.background
                     Material.foreground: primaryColors.c100.text
                     onClicked: {
+                        if(generator.busy) {
+                            generator.cancel()
+                            return
+                        }
                         generator.discard()
                         modalDialog.close()
                     }
@@ -279,6 +306,10 @@ Item {
                         if(event.key === Qt.Key_Escape) {
                             result.acceptEvent = true
                             result.filter = true
+                            if(generator.busy) {
+                                generator.cancel()
+                                return
+                            }
                             generator.discard()
                             modalDialog.close()
                         }
@@ -286,16 +317,13 @@ Item {
                 }
 
                 Button2 {
-                    enabled: fileSelector.absoluteFilePath !== ""
+                    enabled: fileSelector.absoluteFilePath !== "" && !generator.busy
                     text: "Generate"
                     Material.background: primaryColors.c100.background
                     Material.foreground: primaryColors.c100.text
 
                     onClicked: {
-                        if(generator.generate()) {
-                            app.revealFileOnDesktop(generator.fileName)
-                            modalDialog.close()
-                        }
+                        generator.generateInBackground()
                     }
                 }
             }
@@ -303,6 +331,17 @@ Item {
     }
 
     property ErrorReport generatorErrors: Aggregation.findErrorReport(generator)
+    property ProgressReport generatorProgress: Aggregation.findProgressReport(generator)
+
+    Connections {
+        target: generator
+        onFinished: {
+            if(success) {
+                app.revealFileOnDesktop(generator.fileName)
+                modalDialog.close()
+            }
+        }
+    }
 
     Notification.title: formInfo.title
     Notification.text: generatorErrors.errorMessage
@@ -821,6 +821,8 @@ Rectangle {
                 forceSyncDocument: !sceneTextEditor.activeFocus
                 spellCheckEnabled: !scriteDocument.readOnly && spellCheckEnabledFlag.value
                 liveSpellCheckEnabled: sceneTextEditor.activeFocus
+                visible: contentView.isVisible(contentItem.theIndex)
+                visibleRect: Qt.rect(0, contentView.contentY - (contentItem.parent ? contentItem.parent.y : 0) - sceneTextEditor.y - sceneTextEditor.topPadding, sceneTextEditor.width, contentView.height)
                 onDocumentInitialized: sceneTextEditor.cursorPosition = 0
                 onRequestCursorPosition: app.execLater(contentItem, 100, function() { contentItem.assumeFocusAt(position) })
                 property var currentParagraphType: currentElement ? currentElement.type : SceneHeading.Action
@@ -1218,6 +1220,7 @@ Rectangle {
                         Completer {
                             id: completer
                             strings: sceneDocumentBinder.autoCompleteHints
+                            source: sceneDocumentBinder.currentElement && sceneDocumentBinder.currentElement.type === SceneElement.Character ? Completer.CharacterNamesSource : Completer.StringsSource
                             completionPrefix: sceneDocumentBinder.completionPrefix
                         }
 
@@ -1958,7 +1961,7 @@ Rectangle {
                     anchors.verticalCenter: parent.verticalCenter
                     text: sceneHeading.location
                     enableTransliteration: true
-                    completionStrings: scriteDocument.structure.allLocations()
+                    completionSource: Completer.LocationsSource
                     onEditingComplete: sceneHeading.location = text
                     tabItem: momentEdit
                     includeEmojiSymbols: app.isWindowsPlatform || app.isLinuxPlatform
@@ -2075,7 +2078,7 @@ Rectangle {
                         font.pointSize: 12
                         horizontalAlignment: Text.AlignLeft
                         wrapMode: Text.NoWrap
-                        completionStrings: scriteDocument.structure.characterNames
+                        completionSource: Completer.CharacterNamesSource
                         onEditingFinished: {
                             scene.addMuteCharacter(text)
                             newCharacterInput.active = false
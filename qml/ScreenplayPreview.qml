@@ -63,6 +63,7 @@ Rectangle {
     ImagePrinter {
         id: screenplayImagePrinter
         scale: 2
+        renderOnDemand: true
     }
 
     Text {
@@ -18,6 +18,7 @@ import Scrite 1.0
 TextField {
     id: textField
     property alias completionStrings: completer.strings
+    property alias completionSource: completer.source
     property Item tabItem
     property Item backTabItem
     property bool labelAlwaysVisible: false
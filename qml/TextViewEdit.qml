@@ -28,6 +28,7 @@ Loader {
     property int searchSequenceNumber: -1
     property bool hasFocus: item ? item.activeFocus : false
     property var completionStrings: []
+    property int completionSource: Completer.StringsSource
     property real contentWidth: item ? item.contentWidth : fontMetrics.advanceWidth(text)
     property bool frameVisible: false
     property alias fontAscent: fontMetrics.ascent
@@ -132,6 +133,7 @@ Loader {
             Completer {
                 id: completer
                 strings: completionStrings
+                source: completionSource
                 suggestionMode: Completer.CompleteSuggestion
                 completionPrefix: textArea.text
             }
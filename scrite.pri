@@ -0,0 +1,282 @@
+# Everything that goes into a Scrite binary, except main.cpp. This is included by
+# scrite.pro and by other targets (like tools/benchmark) that need to link against
+# the same code.
+
+QT += gui qml quick widgets xml concurrent network quickcontrols2 multimedia
+
+DEFINES += PHTRANSLATE_STATICLIB
+
+#DEFINES += SCRITE_ENABLE_AUTOMATION
+#QT += testlib
+
+CONFIG(release, debug|release): {
+    DEFINES += QT_NO_DEBUG_OUTPUT
+    CONFIG += qtquickcompiler
+}
+
+INCLUDEPATH += $$PWD \
+        $$PWD/src \
+        $$PWD/src/core \
+        $$PWD/src/importers \
+        $$PWD/src/exporters \
+        $$PWD/src/printing \
+        $$PWD/src/quick \
+        $$PWD/src/quick/objects \
+        $$PWD/src/quick/items \
+        $$PWD/src/utils \
+        $$PWD/src/document \
+        $$PWD/src/interfaces \
+        $$PWD/src/reports \
+        $$PWD/src/automation
+
+HEADERS += \
+    $$PWD/3rdparty/phtranslator/LanguageCodes.h \
+    $$PWD/3rdparty/phtranslator/PhTranslateLib.h \
+    $$PWD/3rdparty/phtranslator/PhTranslator.h \
+    $$PWD/3rdparty/phtranslator/stdafx.h \
+    $$PWD/3rdparty/phtranslator/targetver.h \
+    $$PWD/3rdparty/poly2tri/common/shapes.h \
+    $$PWD/3rdparty/poly2tri/common/utils.h \
+    $$PWD/3rdparty/poly2tri/poly2tri.h \
+    $$PWD/3rdparty/poly2tri/sweep/advancing_front.h \
+    $$PWD/3rdparty/poly2tri/sweep/cdt.h \
+    $$PWD/3rdparty/poly2tri/sweep/sweep.h \
+    $$PWD/3rdparty/poly2tri/sweep/sweep_context.h \
+    $$PWD/src/automation/automation.h \
+    $$PWD/src/automation/automationrecorder.h \
+    $$PWD/src/automation/eventautomationstep.h \
+    $$PWD/src/automation/pausestep.h \
+    $$PWD/src/automation/scriptautomationstep.h \
+    $$PWD/src/automation/windowcapture.h \
+    $$PWD/src/core/batchconverter.h \
+    $$PWD/src/core/scritetypes.h \
+    $$PWD/src/core/objectlistpropertymodel.h \
+    $$PWD/src/core/qobjectproperty.h \
+    $$PWD/src/core/systemtextinputmanager.h \
+    $$PWD/src/document/characterrelationshipsgraph.h \
+    $$PWD/src/document/notebooktabmodel.h \
+    $$PWD/src/document/screenplaytextdocumentoffsets.h \
+    $$PWD/src/importers/openfromlibrary.h \
+    $$PWD/src/printing/qtextdocumentpagedprinter.h \
+    $$PWD/src/printing/imageprinter.h \
+    $$PWD/src/printing/pageimagecache.h \
+    $$PWD/src/quick/items/boundingboxevaluator.h \
+    $$PWD/src/quick/items/textdocumentitem.h \
+    $$PWD/src/quick/objects/announcement.h \
+    $$PWD/src/quick/objects/colorimageprovider.h \
+    $$PWD/src/quick/objects/modelaggregator.h \
+    $$PWD/src/quick/objects/tabsequencemanager.h \
+    $$PWD/src/quick/objects/delayedpropertybinder.h \
+    $$PWD/src/quick/objects/notification.h \
+    $$PWD/src/quick/objects/fileinfo.h \
+    $$PWD/src/quick/objects/searchengine.h \
+    $$PWD/src/quick/objects/completer.h \
+    $$PWD/src/quick/objects/eventfilter.h \
+    $$PWD/src/quick/objects/polygontesselator.h \
+    $$PWD/src/quick/objects/shortcutsmodel.h \
+    $$PWD/src/quick/objects/trackobject.h \
+    $$PWD/src/quick/objects/notificationmanager.h \
+    $$PWD/src/quick/objects/materialcolors.h \
+    $$PWD/src/quick/objects/errorreport.h \
+    $$PWD/src/quick/objects/resetonchange.h \
+    $$PWD/src/quick/objects/focustracker.h \
+    $$PWD/src/quick/objects/standardpaths.h \
+    $$PWD/src/quick/objects/aggregation.h \
+    $$PWD/src/quick/items/textshapeitem.h \
+    $$PWD/src/quick/items/ruleritem.h \
+    $$PWD/src/quick/items/abstractshapeitem.h \
+    $$PWD/src/quick/items/gridbackgrounditem.h \
+    $$PWD/src/quick/items/painterpathitem.h \
+    $$PWD/src/reports/characterreport.h \
+    $$PWD/src/reports/locationreport.h \
+    $$PWD/src/reports/scenecharactermatrixreport.h \
+    $$PWD/src/utils/execlatertimer.h \
+    $$PWD/src/utils/graphlayout.h \
+    $$PWD/src/utils/timeprofiler.h \
+    $$PWD/src/utils/garbagecollector.h \
+    $$PWD/src/utils/stallwatchdog.h \
+    $$PWD/src/utils/completiontrie.h \
+    $$PWD/src/utils/hourglass.h \
+    $$PWD/src/utils/genericarraymodel.h \
+    $$PWD/src/utils/qobjectfactory.h \
+    $$PWD/src/utils/qobjectserializer.h \
+    $$PWD/src/utils/modifiable.h \
+    $$PWD/src/document/formatting.h \
+    $$PWD/src/document/transliteration.h \
+    $$PWD/src/document/scritedocument.h \
+    $$PWD/src/document/documentfilesystem.h \
+    $$PWD/src/document/structure.h \
+    $$PWD/src/document/screenplaytextdocument.h \
+    $$PWD/src/document/undoredo.h \
+    $$PWD/src/document/screenplayadapter.h \
+    $$PWD/src/document/note.h \
+    $$PWD/src/document/screenplay.h \
+    $$PWD/src/document/screenplaysnapshot.h \
+    $$PWD/src/document/paginationcache.h \
+    $$PWD/src/document/scene.h \
+    $$PWD/src/core/application.h \
+    $$PWD/src/core/autoupdate.h \
+    $$PWD/src/exporters/finaldraftexporter.h \
+    $$PWD/src/exporters/structureexporter.h \
+    $$PWD/src/exporters/textexporter.h \
+    $$PWD/src/exporters/fountainexporter.h \
+    $$PWD/src/exporters/htmlexporter.h \
+    $$PWD/src/exporters/pdfexporter.h \
+    $$PWD/src/exporters/odtexporter.h \
+    $$PWD/src/importers/fountainimporter.h \
+    $$PWD/src/importers/finaldraftimporter.h \
+    $$PWD/src/importers/htmlimporter.h \
+    $$PWD/src/interfaces/abstracttextdocumentexporter.h \
+    $$PWD/src/interfaces/abstractreportgenerator.h \
+    $$PWD/src/interfaces/abstractexporter.h \
+    $$PWD/src/interfaces/abstractimporter.h \
+    $$PWD/src/interfaces/abstractdeviceio.h \
+    $$PWD/src/interfaces/deviceiojob.h \
+    $$PWD/src/interfaces/abstractscreenplaysubsetreport.h \
+    $$PWD/src/reports/characterscreenplayreport.h \
+    $$PWD/src/reports/progressreport.h \
+    $$PWD/src/reports/screenplaysubsetreport.h \
+    $$PWD/src/reports/locationscreenplayreport.h \
+    $$PWD/src/utils/urlattributes.h
+
+SOURCES += \
+    $$PWD/3rdparty/phtranslator/PhTranslateLib.cpp \
+    $$PWD/3rdparty/phtranslator/PhTranslator.cpp \
+    $$PWD/3rdparty/phtranslator/stdafx.cpp \
+    $$PWD/3rdparty/poly2tri/common/shapes.cc \
+    $$PWD/3rdparty/poly2tri/sweep/advancing_front.cc \
+    $$PWD/3rdparty/poly2tri/sweep/cdt.cc \
+    $$PWD/3rdparty/poly2tri/sweep/sweep.cc \
+    $$PWD/3rdparty/poly2tri/sweep/sweep_context.cc \
+    $$PWD/src/automation/automation.cpp \
+    $$PWD/src/automation/automation_module.cpp \
+    $$PWD/src/automation/automationrecorder.cpp \
+    $$PWD/src/automation/eventautomationstep.cpp \
+    $$PWD/src/automation/pausestep.cpp \
+    $$PWD/src/automation/scriptautomationstep.cpp \
+    $$PWD/src/automation/windowcapture.cpp \
+    $$PWD/src/core/application_build_timestamp.cpp \
+    $$PWD/src/core/batchconverter.cpp \
+    $$PWD/src/core/scritetypes.cpp \
+    $$PWD/src/core/qobjectproperty.cpp \
+    $$PWD/src/core/systemtextinputmanager.cpp \
+    $$PWD/src/document/characterrelationshipsgraph.cpp \
+    $$PWD/src/document/notebooktabmodel.cpp \
+    $$PWD/src/document/screenplaytextdocumentoffsets.cpp \
+    $$PWD/src/importers/openfromlibrary.cpp \
+    $$PWD/src/printing/qtextdocumentpagedprinter.cpp \
+    $$PWD/src/printing/imageprinter.cpp \
+    $$PWD/src/printing/pageimagecache.cpp \
+    $$PWD/src/quick/items/boundingboxevaluator.cpp \
+    $$PWD/src/quick/items/textdocumentitem.cpp \
+    $$PWD/src/quick/objects/announcement.cpp \
+    $$PWD/src/quick/objects/colorimageprovider.cpp \
+    $$PWD/src/quick/objects/modelaggregator.cpp \
+    $$PWD/src/quick/objects/tabsequencemanager.cpp \
+    $$PWD/src/quick/objects/fileinfo.cpp \
+    $$PWD/src/quick/objects/focustracker.cpp \
+    $$PWD/src/quick/objects/delayedpropertybinder.cpp \
+    $$PWD/src/quick/objects/notificationmanager.cpp \
+    $$PWD/src/quick/objects/notification.cpp \
+    $$PWD/src/quick/objects/resetonchange.cpp \
+    $$PWD/src/quick/objects/completer.cpp \
+    $$PWD/src/quick/objects/eventfilter.cpp \
+    $$PWD/src/quick/objects/aggregation.cpp \
+    $$PWD/src/quick/objects/shortcutsmodel.cpp \
+    $$PWD/src/quick/objects/trackobject.cpp \
+    $$PWD/src/quick/objects/materialcolors.cpp \
+    $$PWD/src/quick/objects/errorreport.cpp \
+    $$PWD/src/quick/objects/standardpaths.cpp \
+    $$PWD/src/quick/objects/polygontesselator.cpp \
+    $$PWD/src/quick/objects/searchengine.cpp \
+    $$PWD/src/quick/items/gridbackgrounditem.cpp \
+    $$PWD/src/quick/items/painterpathitem.cpp \
+    $$PWD/src/quick/items/textshapeitem.cpp \
+    $$PWD/src/quick/items/abstractshapeitem.cpp \
+    $$PWD/src/quick/items/ruleritem.cpp \
+    $$PWD/src/reports/characterreport.cpp \
+    $$PWD/src/reports/locationreport.cpp \
+    $$PWD/src/reports/scenecharactermatrixreport.cpp \
+    $$PWD/src/utils/execlatertimer.cpp \
+    $$PWD/src/utils/genericarraymodel.cpp \
+    $$PWD/src/utils/graphlayout.cpp \
+    $$PWD/src/utils/timeprofiler.cpp \
+    $$PWD/src/utils/garbagecollector.cpp \
+    $$PWD/src/utils/stallwatchdog.cpp \
+    $$PWD/src/utils/completiontrie.cpp \
+    $$PWD/src/utils/qobjectserializer.cpp \
+    $$PWD/src/document/scritedocument.cpp \
+    $$PWD/src/document/screenplay.cpp \
+    $$PWD/src/document/screenplaysnapshot.cpp \
+    $$PWD/src/document/paginationcache.cpp \
+    $$PWD/src/document/scene.cpp \
+    $$PWD/src/document/documentfilesystem.cpp \
+    $$PWD/src/document/structure.cpp \
+    $$PWD/src/document/screenplaytextdocument.cpp \
+    $$PWD/src/document/undoredo.cpp \
+    $$PWD/src/document/transliteration.cpp \
+    $$PWD/src/document/screenplayadapter.cpp \
+    $$PWD/src/document/note.cpp \
+    $$PWD/src/document/formatting.cpp \
+    $$PWD/src/core/autoupdate.cpp \
+    $$PWD/src/core/application.cpp \
+    $$PWD/src/exporters/htmlexporter.cpp \
+    $$PWD/src/exporters/structureexporter.cpp \
+    $$PWD/src/exporters/odtexporter.cpp \
+    $$PWD/src/exporters/textexporter.cpp \
+    $$PWD/src/exporters/pdfexporter.cpp \
+    $$PWD/src/exporters/fountainexporter.cpp \
+    $$PWD/src/exporters/finaldraftexporter.cpp \
+    $$PWD/src/importers/finaldraftimporter.cpp \
+    $$PWD/src/importers/fountainimporter.cpp \
+    $$PWD/src/importers/htmlimporter.cpp \
+    $$PWD/src/interfaces/abstracttextdocumentexporter.cpp \
+    $$PWD/src/interfaces/abstractdeviceio.cpp \
+    $$PWD/src/interfaces/deviceiojob.cpp \
+    $$PWD/src/interfaces/abstractexporter.cpp \
+    $$PWD/src/interfaces/abstractscreenplaysubsetreport.cpp \
+    $$PWD/src/interfaces/abstractimporter.cpp \
+    $$PWD/src/interfaces/abstractreportgenerator.cpp \
+    $$PWD/src/reports/screenplaysubsetreport.cpp \
+    $$PWD/src/reports/characterscreenplayreport.cpp \
+    $$PWD/src/reports/progressreport.cpp \
+    $$PWD/src/reports/locationscreenplayreport.cpp \
+    $$PWD/src/utils/urlattributes.cpp
+
+RESOURCES += \
+    $$PWD/scrite_bengali_font.qrc \
+    $$PWD/scrite_english_font.qrc \
+    $$PWD/scrite_gujarati_font.qrc \
+    $$PWD/scrite_hindi_font.qrc \
+    $$PWD/scrite_kannada_font.qrc \
+    $$PWD/scrite_malayalam_font.qrc \
+    $$PWD/scrite_marathi_font.qrc \
+    $$PWD/scrite_misc.qrc \
+    $$PWD/scrite_oriya_font.qrc \
+    $$PWD/scrite_punjabi_font.qrc \
+    $$PWD/scrite_sanskrit_font.qrc \
+    $$PWD/scrite_tamil_font.qrc \
+    $$PWD/scrite_telugu_font.qrc \
+    $$PWD/scrite_raleway_font.qrc \
+    $$PWD/scrite_icons.qrc \
+    $$PWD/scrite_images.qrc \
+    $$PWD/scrite_ui.qrc
+
+# https://doc.qt.io/qt-5/qtwebengine-deploying.html#javascript-files-in-qt-resource-files
+QTQUICK_COMPILER_SKIPPED_RESOURCES += $$PWD/scrite_misc.qrc
+
+macx {
+    HEADERS += $$PWD/src/core/systemtextinputmanager_macos.h
+    OBJECTIVE_SOURCES += $$PWD/src/core/systemtextinputmanager_macos.mm
+    LIBS += -framework Carbon
+    CONFIG+=sdk_no_version_check
+}
+
+win32 {
+    HEADERS += $$PWD/src/core/systemtextinputmanager_windows.h
+    SOURCES += $$PWD/src/core/systemtextinputmanager_windows.cpp
+    LIBS += User32.lib
+}
+
+include($$PWD/3rdparty/sonnet/sonnet.pri)
+include($$PWD/3rdparty/quazip/quazip.pri)
@@ -15,12 +15,14 @@
 #include "hourglass.h"
 #include "autoupdate.h"
 #include "application.h"
+#include "stallwatchdog.h"
 #include "execlatertimer.h"
 #include "scritedocument.h"
 
 #include <QDir>
 #include <QUuid>
 #include <QtMath>
+#include <QTimer>
 #include <QScreen>
 #include <QtDebug>
 #include <QCursor>
@@ -117,6 +119,8 @@ Application::Application(int &argc, char **argv, const QVersionNumber &version)
 
     m_settings->sync();
 
+    StallWatchdog::instance()->configure(m_settings);
+
     TransliterationEngine::instance(this);
     SystemTextInputManager::instance();
 }
@@ -641,6 +645,10 @@ bool QtApplicationEventNotificationCallback(void **cbdata)
 
 bool Application::notify(QObject *object, QEvent *event)
 {
+    // Times this dispatch, if the stall watchdog is enabled. Only the outermost
+    // dispatch on the UI thread is timed, nested ones count towards it.
+    StallWatchdog::DispatchScope stallWatch(object, event);
+
     // Note that notifyInternal() will be called first before we get here.
     if(event->type() == QEvent::DeferredDelete)
         return QtApplicationClass::notify(object, event);
@@ -687,7 +695,13 @@ bool Application::notify(QObject *object, QEvent *event)
         QChildEvent *childEvent = reinterpret_cast<QChildEvent*>(event);
         QObject *childObject = childEvent->child();
 
-        if(!childObject->isWidgetType() && !childObject->isWindowType())
+        // ChildAdded is also sent from within the QObject constructor of the
+        // child. At that point the child is still just a QObject, so its event()
+        // would ignore ParentChange anyway. Classes that care about their parent
+        // pick it up from the constructor argument.
+        const bool constructing = childObject->metaObject() == &QObject::staticMetaObject;
+
+        if(!constructing && !childObject->isWidgetType() && !childObject->isWindowType())
         {
             /**
              * For whatever reason, ParentChange event is only sent
@@ -701,7 +715,10 @@ bool Application::notify(QObject *object, QEvent *event)
              * despatch ParentChange events.
              */
             QEvent parentChangeEvent(QEvent::ParentChange);
-            QtApplicationClass::notify(childObject, &parentChangeEvent);
+            if(m_bulkLoadCounter > 0)
+                childObject->event(&parentChangeEvent);
+            else
+                QtApplicationClass::notify(childObject, &parentChangeEvent);
         }
     }
 
@@ -28,6 +28,7 @@
 
 #include "undoredo.h"
 #include "errorreport.h"
+#include "stallwatchdog.h"
 #include "transliteration.h"
 #include "systemtextinputmanager.h"
 
@@ -178,6 +179,9 @@ public:
     Q_PROPERTY(AutoUpdate* autoUpdate READ autoUpdate CONSTANT)
     AutoUpdate *autoUpdate() const;
 
+    Q_PROPERTY(StallWatchdog* stallWatchdog READ stallWatchdog CONSTANT)
+    StallWatchdog *stallWatchdog() const { return StallWatchdog::instance(); }
+
     Q_INVOKABLE QJsonObject objectConfigurationFormInfo(const QObject *object, const QMetaObject *from) const;
 
     Q_PROPERTY(QVariantList standardColors READ standardColorsVariantList NOTIFY standardColorsChanged STORED false)
@@ -246,6 +250,14 @@ public:
 
     Q_INVOKABLE void log(const QString &message);
 
+    // Document loaders and importers create thousands of objects in one go.
+    // While a bulk load is in progress, children added to a non-widget parent
+    // are told about it directly, instead of through a ParentChange event
+    // dispatched from notify(). Calls can be nested.
+    void beginBulkLoad() { ++m_bulkLoadCounter; }
+    void endBulkLoad() { m_bulkLoadCounter = qMax(m_bulkLoadCounter-1, 0); }
+    bool isBulkLoading() const { return m_bulkLoadCounter > 0; }
+
     bool event(QEvent *event);
 
 signals:
@@ -267,6 +279,7 @@ private:
     ErrorReport *m_errorReport = new ErrorReport(this);
     QVersionNumber m_versionNumber;
     QVariantList m_standardColors;
+    int m_bulkLoadCounter = 0;
 };
 
 #endif // APPLICATION_H
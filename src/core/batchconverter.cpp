@@ -0,0 +1,334 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "batchconverter.h"
+#include "aggregation.h"
+#include "errorreport.h"
+#include "scritedocument.h"
+#include "abstractexporter.h"
+#include "abstractreportgenerator.h"
+
+#include <QDir>
+#include <QThread>
+#include <QProcess>
+#include <QFileInfo>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include <functional>
+
+static const char *batchConvertOption = "--batch-convert";
+
+bool BatchConverter::isRequested(int argc, char **argv)
+{
+    for(int i=1; i<argc; i++)
+    {
+        if(qstrcmp(argv[i], batchConvertOption) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+int BatchConverter::run(const QStringList &arguments)
+{
+    BatchConverter converter(arguments);
+    return converter.exec();
+}
+
+BatchConverter::BatchConverter(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Converts Scrite documents without showing any window."));
+
+    const QCommandLineOption batchOption(QStringLiteral("batch-convert"), QStringLiteral("Convert the given documents and quit."));
+    const QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("Comma separated export formats, by name or file suffix."), QStringLiteral("list"));
+    const QCommandLineOption reportOption(QStringLiteral("report"), QStringLiteral("Report to generate. Can be given more than once."), QStringLiteral("name"));
+    const QCommandLineOption outputDirOption(QStringLiteral("output-dir"), QStringLiteral("Folder to write into, instead of the folder of each document."), QStringLiteral("path"));
+    const QCommandLineOption jobsOption(QStringLiteral("jobs"), QStringLiteral("Number of documents to convert at a time."), QStringLiteral("count"), QString::number(QThread::idealThreadCount()));
+    parser.addOptions(QList<QCommandLineOption>() << batchOption << formatOption << reportOption << outputDirOption << jobsOption);
+    parser.addPositionalArgument(QStringLiteral("files"), QStringLiteral("Scrite documents to convert."), QStringLiteral("files..."));
+
+    if(!parser.parse(arguments))
+    {
+        m_usageError = parser.errorText();
+        return;
+    }
+
+    Q_FOREACH(QString format, parser.values(formatOption))
+    {
+        Q_FOREACH(QString item, format.split(QStringLiteral(","), QString::SkipEmptyParts))
+            m_formats << item.trimmed();
+    }
+    m_reports = parser.values(reportOption);
+    m_inputFiles = parser.positionalArguments();
+    m_jobs = qMax(parser.value(jobsOption).toInt(), 1);
+    if(parser.isSet(outputDirOption))
+        m_outputDirectory = QDir(parser.value(outputDirOption)).absolutePath();
+
+    if(m_inputFiles.isEmpty())
+        m_usageError = QStringLiteral("No documents to convert.");
+    else if(m_formats.isEmpty() && m_reports.isEmpty())
+        m_usageError = QStringLiteral("Nothing to convert into. Use --format or --report.");
+
+    // Workers are given the same job, one document at a time.
+    m_workerArguments << QString::fromLatin1(batchConvertOption) << QStringLiteral("--jobs") << QStringLiteral("1");
+    if(!m_formats.isEmpty())
+        m_workerArguments << QStringLiteral("--format") << m_formats.join(QStringLiteral(","));
+    Q_FOREACH(QString report, m_reports)
+        m_workerArguments << QStringLiteral("--report") << report;
+    if(!m_outputDirectory.isEmpty())
+        m_workerArguments << QStringLiteral("--output-dir") << m_outputDirectory;
+}
+
+BatchConverter::~BatchConverter()
+{
+
+}
+
+int BatchConverter::exec()
+{
+    if(!m_usageError.isEmpty())
+    {
+        fprintf(stderr, "%s\n", qPrintable(m_usageError));
+        fprintf(stderr, "Usage: %s %s [--format list] [--report name] [--output-dir path] [--jobs count] files...\n",
+                qPrintable(QFileInfo(QCoreApplication::applicationFilePath()).fileName()), batchConvertOption);
+        return 2;
+    }
+
+    if(!m_outputDirectory.isEmpty() && !QDir().mkpath(m_outputDirectory))
+    {
+        fprintf(stderr, "Cannot create folder %s\n", qPrintable(m_outputDirectory));
+        return 2;
+    }
+
+    if(m_jobs > 1 && m_inputFiles.size() > 1)
+        return this->dispatch();
+
+    int nrFailed = 0;
+    Q_FOREACH(QString fileName, m_inputFiles)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QString errorMessage;
+        const bool success = this->convert(fileName, &errorMessage);
+        if(success)
+            fprintf(stdout, "OK     %6lld ms  %s\n", timer.elapsed(), qPrintable(fileName));
+        else
+        {
+            fprintf(stdout, "FAILED %6lld ms  %s: %s\n", timer.elapsed(), qPrintable(fileName), qPrintable(errorMessage));
+            ++nrFailed;
+        }
+        fflush(stdout);
+    }
+
+    return nrFailed > 0 ? 1 : 0;
+}
+
+int BatchConverter::dispatch()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QEventLoop eventLoop;
+    QStringList pending = m_inputFiles;
+    int nrRunning = 0;
+    int nrFailed = 0;
+
+    // Each worker prints the line for its own document. Only workers that
+    // crash, or never start, have to be reported from here.
+    std::function<void()> launchNext = [&]() {
+        while(nrRunning < m_jobs && !pending.isEmpty())
+        {
+            const QString fileName = pending.takeFirst();
+
+            QProcess *worker = new QProcess(&eventLoop);
+            worker->setProcessChannelMode(QProcess::ForwardedChannels);
+
+            QElapsedTimer *workerTimer = new QElapsedTimer;
+            workerTimer->start();
+
+            auto workerDone = [&,worker,workerTimer]() {
+                delete workerTimer;
+                worker->deleteLater();
+                --nrRunning;
+                if(pending.isEmpty() && nrRunning == 0)
+                    eventLoop.quit();
+                else
+                    launchNext();
+            };
+
+            QObject::connect(worker, QOverload<int,QProcess::ExitStatus>::of(&QProcess::finished),
+                             [&,worker,workerTimer,fileName,workerDone](int exitCode, QProcess::ExitStatus exitStatus) {
+                if(exitStatus == QProcess::CrashExit)
+                {
+                    fprintf(stdout, "FAILED %6lld ms  %s: %s\n", workerTimer->elapsed(), qPrintable(fileName), qPrintable(worker->errorString()));
+                    fflush(stdout);
+                }
+                if(exitStatus == QProcess::CrashExit || exitCode != 0)
+                    ++nrFailed;
+                workerDone();
+            });
+            QObject::connect(worker, &QProcess::errorOccurred,
+                             [&,worker,workerTimer,fileName,workerDone](QProcess::ProcessError error) {
+                if(error != QProcess::FailedToStart)
+                    return;
+                fprintf(stdout, "FAILED %6lld ms  %s: %s\n", workerTimer->elapsed(), qPrintable(fileName), qPrintable(worker->errorString()));
+                fflush(stdout);
+                ++nrFailed;
+                workerDone();
+            });
+
+            ++nrRunning;
+            worker->start(QCoreApplication::applicationFilePath(), QStringList(m_workerArguments) << fileName);
+        }
+    };
+
+    launchNext();
+    if(nrRunning > 0)
+        eventLoop.exec();
+
+    const int nrConverted = m_inputFiles.size() - nrFailed;
+    fprintf(stdout, "Converted %d of %d documents in %lld ms\n", nrConverted, m_inputFiles.size(), timer.elapsed());
+    fflush(stdout);
+
+    return nrFailed > 0 ? 1 : 0;
+}
+
+bool BatchConverter::convert(const QString &fileName, QString *errorMessage)
+{
+    const QFileInfo fileInfo(fileName);
+    if(!fileInfo.exists() || !fileInfo.isFile())
+    {
+        *errorMessage = QStringLiteral("File not found.");
+        return false;
+    }
+
+    ScriteDocument *document = ScriteDocument::instance();
+    document->setAutoSave(false);
+
+    Aggregation aggregation;
+    ErrorReport *documentErrors = aggregation.findErrorReport(document);
+
+    document->openAnonymously(fileInfo.absoluteFilePath());
+    if(documentErrors != nullptr && documentErrors->hasError())
+    {
+        *errorMessage = documentErrors->errorMessage();
+        return false;
+    }
+
+    const QStringList formats = this->resolveExportFormats(document, errorMessage);
+    if(!errorMessage->isEmpty())
+        return false;
+
+    Q_FOREACH(QString format, formats)
+    {
+        AbstractExporter *exporter = document->createExporter(format);
+        if(exporter == nullptr)
+        {
+            *errorMessage = QStringLiteral("Cannot export to %1.").arg(format);
+            return false;
+        }
+
+        exporter->setFileName( this->outputFilePath(fileInfo.absoluteFilePath(), fileInfo.completeBaseName()) );
+
+        const bool success = exporter->write();
+        ErrorReport *exporterErrors = aggregation.findErrorReport(exporter);
+        if(!success || (exporterErrors != nullptr && exporterErrors->hasError()))
+        {
+            *errorMessage = exporterErrors != nullptr && exporterErrors->hasError() ? exporterErrors->errorMessage()
+                                                                                     : QStringLiteral("Cannot export to %1.").arg(format);
+            delete exporter;
+            return false;
+        }
+
+        delete exporter;
+    }
+
+    Q_FOREACH(QString report, m_reports)
+    {
+        AbstractReportGenerator *reportGenerator = document->createReportGenerator(report);
+        if(reportGenerator == nullptr)
+        {
+            *errorMessage = QStringLiteral("There is no report called %1.").arg(report);
+            return false;
+        }
+
+        reportGenerator->setFileName( this->outputFilePath(fileInfo.absoluteFilePath(), fileInfo.completeBaseName() + QStringLiteral(" - ") + report) );
+
+        const bool success = reportGenerator->generate();
+        ErrorReport *reportErrors = aggregation.findErrorReport(reportGenerator);
+        if(!success || (reportErrors != nullptr && reportErrors->hasError()))
+        {
+            *errorMessage = reportErrors != nullptr && reportErrors->hasError() ? reportErrors->errorMessage()
+                                                                                 : QStringLiteral("Cannot generate %1.").arg(report);
+            delete reportGenerator;
+            return false;
+        }
+
+        delete reportGenerator;
+    }
+
+    return true;
+}
+
+QStringList BatchConverter::resolveExportFormats(ScriteDocument *document, QString *errorMessage) const
+{
+    const QStringList supportedFormats = document->supportedExportFormats();
+
+    QStringList ret;
+    Q_FOREACH(QString format, m_formats)
+    {
+        QString resolvedFormat;
+        Q_FOREACH(QString supportedFormat, supportedFormats)
+        {
+            // The list has empty entries, where the menu has separators.
+            if(supportedFormat.isEmpty())
+                continue;
+
+            if(supportedFormat.compare(format, Qt::CaseInsensitive) == 0)
+            {
+                resolvedFormat = supportedFormat;
+                break;
+            }
+
+            const QString nameFilters = document->exportFormatFileSuffix(supportedFormat);
+            if(nameFilters.contains(QStringLiteral("*.") + format, Qt::CaseInsensitive))
+            {
+                resolvedFormat = supportedFormat;
+                break;
+            }
+        }
+
+        if(resolvedFormat.isEmpty())
+        {
+            *errorMessage = QStringLiteral("Unknown export format %1.").arg(format);
+            return QStringList();
+        }
+
+        if(!ret.contains(resolvedFormat))
+            ret << resolvedFormat;
+    }
+
+    return ret;
+}
+
+QString BatchConverter::outputFilePath(const QString &inputFileName, const QString &name) const
+{
+    // Exporters and report generators add the suffix they need themselves.
+    const QDir dir = m_outputDirectory.isEmpty() ? QFileInfo(inputFileName).absoluteDir() : QDir(m_outputDirectory);
+    return dir.absoluteFilePath(name);
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef BATCHCONVERTER_H
+#define BATCHCONVERTER_H
+
+#include <QStringList>
+
+class ScriteDocument;
+
+/**
+ * Converts Scrite documents from the command line, without creating any
+ * window or loading QML. For example
+ *
+ *    scrite --batch-convert --format pdf,fdx --output-dir archive *.scrite
+ *
+ * writes a PDF and a Final Draft file for each document into archive. Export
+ * formats can be given by name (as listed in the File > Export menu) or by
+ * file suffix. Reports are asked for by name using --report, once for each
+ * report, and are generated with their default options.
+ *
+ * Documents are converted in worker processes, as many at a time as --jobs
+ * says (the number of CPU cores by default). ScriteDocument is a singleton,
+ * so a process can only work on one document at a time. One line is printed
+ * for each document, with the time it took. The exit code is non-zero if any
+ * document could not be converted.
+ */
+class BatchConverter
+{
+public:
+    static bool isRequested(int argc, char **argv);
+    static int run(const QStringList &arguments);
+
+private:
+    BatchConverter(const QStringList &arguments);
+    ~BatchConverter();
+
+    int exec();
+    int dispatch();
+    bool convert(const QString &fileName, QString *errorMessage);
+    QStringList resolveExportFormats(ScriteDocument *document, QString *errorMessage) const;
+    QString outputFilePath(const QString &inputFileName, const QString &name) const;
+
+private:
+    int m_jobs = 1;
+    QString m_outputDirectory;
+    QStringList m_inputFiles;
+    QStringList m_reports;
+    QStringList m_formats;
+    QStringList m_workerArguments;
+    QString m_usageError;
+};
+
+#endif // BATCHCONVERTER_H
@@ -14,6 +14,7 @@
 #ifndef OBJECTLISTPROPERTYMODEL_H
 #define OBJECTLISTPROPERTYMODEL_H
 
+#include <QHash>
 #include <QList>
 #include <QMetaMethod>
 #include <QAbstractListModel>
@@ -46,8 +47,9 @@ public:
         : ObjectListPropertyModelBase(parent) { }
     ~ObjectListPropertyModel() { }
 
+    // The list is only handed out as a const reference, because all changes to
+    // it must go through this class to keep the row index in sync.
     operator QList<T> () { return m_list; }
-    QList<T>& list() { return m_list; }
     const QList<T> &list() const { return m_list; }
 
     bool empty() const { return m_list.empty(); }
@@ -60,10 +62,15 @@ public:
     void prepend(T ptr) {
         this->beginInsertRows(QModelIndex(), 0, 0);
         m_list.prepend(ptr);
+        m_rowIndexValid = false;
         this->endInsertRows();
     }
 
-    int indexOf(T ptr) const { return m_list.indexOf(ptr); }
+    int indexOf(T ptr) const {
+        if(!m_rowIndexValid)
+            this->updateRowIndex();
+        return m_rowIndex.value(ptr, -1);
+    }
 
     void removeAt(int row) {
         if(row < 0 || row >= m_list.size())
@@ -73,6 +80,10 @@ public:
         T ptr = m_list.at(row);
         ptr->disconnect(this);
         m_list.removeAt(row);
+        if(m_rowIndexValid && row == m_list.size() && m_rowIndex.value(ptr, -1) == row)
+            m_rowIndex.remove(ptr);
+        else
+            m_rowIndexValid = false;
         this->endRemoveRows();
     }
 
@@ -81,6 +92,11 @@ public:
 
         this->beginInsertRows(QModelIndex(), iidx, iidx);
         m_list.insert(iidx, ptr);
+        if(m_rowIndexValid && iidx == m_list.size()-1) {
+            if(!m_rowIndex.contains(ptr))
+                m_rowIndex.insert(ptr, iidx);
+        } else
+            m_rowIndexValid = false;
         this->endInsertRows();
     }
 
@@ -96,12 +112,14 @@ public:
 
         this->beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(), toRow < fromRow ? toRow : toRow+1);
         m_list.move(fromRow, toRow);
+        m_rowIndexValid = false;
         this->endMoveRows();
     }
 
     void assign(const QList<T> &list) {
         this->beginResetModel();
         m_list = list;
+        m_rowIndexValid = false;
         this->endResetModel();
     }
 
@@ -110,6 +128,8 @@ public:
         for(T ptr : m_list)
             ptr->disconnect(this);
         m_list.clear();
+        m_rowIndex.clear();
+        m_rowIndexValid = true;
         this->endResetModel();
     }
 
@@ -170,7 +190,7 @@ public:
         T ptr = qobject_cast<T>(this->sender());
         if(ptr == nullptr)
             return;
-        const int row = m_list.indexOf(ptr);
+        const int row = this->indexOf(ptr);
         if(row < 0)
             return;
         const QModelIndex index = this->index(row, 0, QModelIndex());
@@ -180,14 +200,28 @@ public:
     void objectDestroyed(T ptr) {
         if(ptr == nullptr)
             return;
-        const int row = m_list.indexOf(ptr);
+        const int row = this->indexOf(ptr);
         if(row < 0)
             return;
         this->removeAt(row);
     }
 
+private:
+    // Row index is updated in place for appends and removals at the end, which
+    // is what happens most of the time. Any other change causes it to be rebuilt
+    // upon the next lookup.
+    void updateRowIndex() const {
+        m_rowIndex.clear();
+        m_rowIndex.reserve(m_list.size());
+        for(int i=m_list.size()-1; i>=0; i--)
+            m_rowIndex.insert(m_list.at(i), i);
+        m_rowIndexValid = true;
+    }
+
 private:
     QList<T> m_list;
+    mutable QHash<T,int> m_rowIndex;
+    mutable bool m_rowIndexValid = true;
 };
 
 template <class T>
@@ -0,0 +1,25 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef SCRITETYPES_H
+#define SCRITETYPES_H
+
+/**
+ * Registers all Scrite types with the QML type system. This must be called
+ * before any document is loaded or saved, even when no QML is loaded, because
+ * QObjectSerializer walks QQmlListProperty lists through QQmlListReference,
+ * which only works for registered element types.
+ */
+void registerScriteTypes();
+
+#endif // SCRITETYPES_H
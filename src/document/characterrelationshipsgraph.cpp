@@ -16,11 +16,13 @@
 #include "hourglass.h"
 #include "application.h"
 
+#include <QMutex>
 #include <QtMath>
 #include <QtDebug>
 #include <QQuickItem>
 #include <QFontMetrics>
 #include <QElapsedTimer>
+#include <QtConcurrentRun>
 
 CharacterRelationshipsGraphNode::CharacterRelationshipsGraphNode(QObject *parent)
     : QObject(parent),
@@ -62,10 +64,15 @@ void CharacterRelationshipsGraphNode::setItem(QQuickItem *val)
         connect(m_item, &QQuickItem::xChanged, this, &CharacterRelationshipsGraphNode::updateRectFromItemLater);
         connect(m_item, &QQuickItem::yChanged, this, &CharacterRelationshipsGraphNode::updateRectFromItemLater);
 
-        m_placedByUser = true;
+        // While a layout is in progress, nodes are still finding their place. The
+        // graph marks them as placed once its layout finishes.
         CharacterRelationshipsGraph *graph = qobject_cast<CharacterRelationshipsGraph*>(this->parent());
-        if(graph)
-            graph->updateGraphJsonFromNode(this);
+        if(graph == nullptr || !graph->isLayoutInProgress())
+        {
+            m_placedByUser = true;
+            if(graph)
+                graph->updateGraphJsonFromNode(this);
+        }
     }
 
     emit itemChanged();
@@ -314,18 +321,87 @@ void CharacterRelationshipsGraphEdge::setReverseLabel(const QString &val)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Lays out plain copies of character graphs on a worker thread. Intermediate
+ * positions are published into a mutex guarded list, which the graph polls
+ * at a fixed rate from the GUI thread.
+ */
+class CharacterRelationshipsGraphLayoutJob
+{
+public:
+    // Accessed only from the worker thread, once the job has started
+    QList<GraphLayout::GraphData> graphs;
+    QList<qreal> minimumEdgeLengths;
+    int maxTime = 100;
+    int maxIterations = -1;
+
+    QAtomicInt cancelled;
+    bool isCancelled() const { return cancelled.loadAcquire() != 0; }
+    void cancel() { cancelled.storeRelease(1); }
+
+    // Shared between worker and GUI threads, guarded by mutex
+    QMutex mutex;
+    QList<GraphLayout::GraphData> publishedGraphs;
+    int revision = 0;
+    bool finished = false;
+
+    void run();
+
+private:
+    void publish(int index, const GraphLayout::GraphData &data);
+};
+
+void CharacterRelationshipsGraphLayoutJob::run()
+{
+    for(int i=0; i<graphs.size() && !this->isCancelled(); i++)
+    {
+        GraphLayout::GraphData &data = graphs[i];
+        if(data.edges.isEmpty())
+            continue;
+
+        // Small graphs are layed out using exact all-pairs forces, larger ones
+        // use the Barnes-Hut approximation so that they settle within maxTime.
+        GraphLayout::BarnesHutLayout layout;
+        layout.setTheta(data.positions.size() > 48 ? 0.8 : 0);
+        layout.setMaxTime(maxTime);
+        layout.setMaxIterations(maxIterations);
+        layout.setMinimumEdgeLength(minimumEdgeLengths.at(i));
+        layout.setProgressInterval(40);
+        const bool success = layout.layout(data, [=](const GraphLayout::GraphData &progressData) {
+            this->publish(i, progressData);
+            return !this->isCancelled();
+        });
+
+        if(success)
+            this->publish(i, data);
+    }
+
+    QMutexLocker locker(&mutex);
+    finished = true;
+}
+
+void CharacterRelationshipsGraphLayoutJob::publish(int index, const GraphLayout::GraphData &data)
+{
+    QMutexLocker locker(&mutex);
+    publishedGraphs[index] = data;
+    ++revision;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 CharacterRelationshipsGraph::CharacterRelationshipsGraph(QObject *parent)
     : QObject(parent),
       m_scene(this, "scene"),
+      m_layoutTimer("CharacterRelationshipsGraph.m_layoutTimer"),
       m_character(this, "character"),
       m_structure(this, "structure")
 {
-
+    m_layoutTimer.setRepeat(true);
 }
 
 CharacterRelationshipsGraph::~CharacterRelationshipsGraph()
 {
-
+    this->cancelLayout();
 }
 
 void CharacterRelationshipsGraph::setNodeSize(const QSizeF &val)
@@ -348,6 +424,7 @@ void CharacterRelationshipsGraph::setStructure(Structure *val)
         disconnect(m_structure, &Structure::characterCountChanged, this, &CharacterRelationshipsGraph::markDirty);
 
     m_structure = val;
+    m_layoutPositions.clear();
     emit structureChanged();
 
     if(!m_structure.isNull())
@@ -464,6 +541,7 @@ void CharacterRelationshipsGraph::reset()
     if(gjObject != nullptr)
         gjObject->setProperty("characterRelationshipGraph", QVariant::fromValue<QJsonObject>(QJsonObject()));
 
+    m_layoutPositions.clear();
     this->reload();
 }
 
@@ -516,6 +594,8 @@ void CharacterRelationshipsGraph::timerEvent(QTimerEvent *te)
         m_loadTimer.stop();
         this->load();
     }
+    else if(te->timerId() == m_layoutTimer.timerId())
+        this->pollLayout();
 }
 
 void CharacterRelationshipsGraph::setGraphBoundingRect(const QRectF &val)
@@ -553,6 +633,7 @@ void CharacterRelationshipsGraph::resetCharacter()
 void CharacterRelationshipsGraph::load()
 {
     HourGlass hourGlass;
+    this->cancelLayout();
     this->setBusy(true);
 
     QList<CharacterRelationshipsGraphEdge*> edges = m_edges.list();
@@ -575,6 +656,9 @@ void CharacterRelationshipsGraph::load()
     }
     nodes.clear();
 
+    m_graphs.clear();
+    m_graphsData.clear();
+
     if(m_structure.isNull() || !m_componentLoaded)
     {
         this->setBusy(false);
@@ -641,6 +725,23 @@ void CharacterRelationshipsGraph::load()
         CharacterRelationshipsGraphNode *node = new CharacterRelationshipsGraphNode(this);
         node->setCharacter(character);
         node->setRect( QRectF( QPointF(0,0), m_nodeSize) );
+
+        // Nodes previously placed by the user stay where they were placed.
+        const QJsonValue rectJsonValue = previousGraphJson.value(character->name());
+        if(!rectJsonValue.isUndefined() && rectJsonValue.isObject())
+        {
+            const QJsonObject rectJson = rectJsonValue.toObject();
+            const QRectF rect( rectJson.value("x").toDouble(),
+                               rectJson.value("y").toDouble(),
+                               rectJson.value("width").toDouble(),
+                               rectJson.value("height").toDouble() );
+            if(rect.isValid())
+            {
+                node->setRect(rect);
+                node->m_placedByUser = true;
+            }
+        }
+
         if(!m_scene.isNull())
             node->setMarked( sceneCharacters.contains(node->character()) );
         nodes.append(node);
@@ -686,29 +787,6 @@ void CharacterRelationshipsGraph::load()
         graphs.append(newGraph);
     }
 
-    // Layout the first graph in the form of a regular grid.
-    auto layoutNodesInAGrid = [](const GraphLayout::Graph &graph) {
-        const int nrNodes = graph.nodes.size();
-        const int nrCols = qFloor( qSqrt(qreal(nrNodes)) );
-
-        int col = 0;
-        QPointF pos;
-        for(GraphLayout::AbstractNode *agnode : graph.nodes) {
-            CharacterRelationshipsGraphNode *node =
-                    qobject_cast<CharacterRelationshipsGraphNode*>(agnode->containerObject());
-            node->move(pos);
-            ++col;
-            if(col < nrCols)
-                pos.setX( pos.x() + node->size().width()*1.5 );
-            else {
-                pos.setX(0);
-                pos.setY( pos.y() + node->size().height()*1.5 );
-                col = 0;
-            }
-        }
-    };
-    layoutNodesInAGrid(graphs[0]);
-
     // Lets now loop over all nodes within each graph (except for the first one, which only
     // constains lone character nodes) and bundle relationships.
     for(int i=1; i<graphs.size(); i++)
@@ -744,83 +822,62 @@ void CharacterRelationshipsGraph::load()
         }
     }
 
-    // Now lets layout all the graphs and arrange them in a row
+    // Now lets gather plain copies of all graphs, so that they can be layed out
+    // on a worker thread. Nodes start from where they were in the previous layout,
+    // if there was one. The first graph is arranged in a grid, so it needs no layout.
     auto longerText = [](const QString &s1, const QString &s2) {
         return s1.length() > s2.length() ? s1 : s2;
     };
-    QRectF boundingRect(m_leftMargin,m_topMargin,0,0);
+    const QFontMetricsF fm(qApp->font());
+    QList<qreal> minimumEdgeLengths;
     for(int i=0; i<graphs.size(); i++)
     {
         const GraphLayout::Graph &graph = graphs[i];
-        if(graph.nodes.isEmpty())
-            continue;
+        GraphLayout::GraphData data;
 
-        if(i >= 1)
+        if(i == 0 || graph.edges.isEmpty())
         {
-            QString longestRelationshipName;
-            for(GraphLayout::AbstractEdge *agedge : graph.edges)
-            {
-                CharacterRelationshipsGraphEdge *gedge =
-                        qobject_cast<CharacterRelationshipsGraphEdge*>(agedge->containerObject());
-                const QString relationshipName = gedge->relationship()->name();
-                longestRelationshipName = longerText(gedge->forwardLabel(), longestRelationshipName);
-                longestRelationshipName = longerText(gedge->reverseLabel(), longestRelationshipName);
-            }
-
-            const QFontMetricsF fm(qApp->font());
-
-            GraphLayout::ForceDirectedLayout layout;
-            layout.setMaxTime(m_maxTime);
-            layout.setMaxIterations(m_maxIterations);
-            layout.setMinimumEdgeLength(fm.horizontalAdvance(longestRelationshipName) * 0.5);
-            layout.layout(graph);
+            m_graphsData.append(data);
+            minimumEdgeLengths.append(0);
+            continue;
         }
 
-        // Compute bounding rect of the nodes.
-        QRectF graphRect;
-        for(GraphLayout::AbstractNode *agnode : graph.nodes)
+        QString longestRelationshipName;
+        for(GraphLayout::AbstractEdge *agedge : graph.edges)
         {
-            CharacterRelationshipsGraphNode *gnode =
-                    qobject_cast<CharacterRelationshipsGraphNode*>(agnode->containerObject());
-
-            const Character *character = gnode->character();
-
-            const QJsonValue rectJsonValue = previousGraphJson.value(character->name());
-            if(!rectJsonValue.isUndefined() && rectJsonValue.isObject())
-            {
-                const QJsonObject rectJson = rectJsonValue.toObject();
-                const QRectF rect( rectJson.value("x").toDouble(),
-                                   rectJson.value("y").toDouble(),
-                                   rectJson.value("width").toDouble(),
-                                   rectJson.value("height").toDouble() );
-                if(rect.isValid())
-                {
-                    gnode->setRect(rect);
-                    gnode->m_placedByUser = true;
-                }
-            }
-
-            graphRect |= gnode->rect();
+            CharacterRelationshipsGraphEdge *gedge =
+                    qobject_cast<CharacterRelationshipsGraphEdge*>(agedge->containerObject());
+            longestRelationshipName = longerText(gedge->forwardLabel(), longestRelationshipName);
+            longestRelationshipName = longerText(gedge->reverseLabel(), longestRelationshipName);
         }
+        minimumEdgeLengths.append(fm.horizontalAdvance(longestRelationshipName) * 0.5);
 
-        // Move the nodes such that they are layed out in a row.
-        const QPointF dp = -graphRect.topLeft() + boundingRect.topRight();
-        for(GraphLayout::AbstractNode *agnode : graph.nodes)
+        const int nrNodes = graph.nodes.size();
+        const qreal angleStep = 2*M_PI / qreal(nrNodes);
+        QHash<GraphLayout::AbstractNode*,int> nodeIndexMap;
+        data.positions.resize(nrNodes);
+        data.movable.fill(true, nrNodes);
+        for(int j=0; j<nrNodes; j++)
         {
+            GraphLayout::AbstractNode *agnode = graph.nodes.at(j);
             CharacterRelationshipsGraphNode *gnode =
                     qobject_cast<CharacterRelationshipsGraphNode*>(agnode->containerObject());
-            if(gnode->m_placedByUser)
-                continue;
+            nodeIndexMap.insert(agnode, j);
 
-            QRectF rect = gnode->rect();
-            rect.moveTopLeft( rect.topLeft() + dp );
-            gnode->setRect(rect);
+            const QString name = gnode->character()->name();
+            const qreal angle = angleStep * qreal(j);
+            data.positions[j] = m_layoutPositions.value(name, QPointF(qCos(angle),qSin(angle)));
+
+            const QSizeF nodeSize = gnode->size();
+            data.maxNodeSize.setWidth( qMax(nodeSize.width(),data.maxNodeSize.width()) );
+            data.maxNodeSize.setHeight( qMax(nodeSize.height(),data.maxNodeSize.height()) );
         }
-        graphRect.moveTopLeft( graphRect.topLeft() + dp );
 
-        boundingRect |= graphRect;
-        if(i < graphs.size()-1)
-            boundingRect.setRight( boundingRect.right() + 100 );
+        for(GraphLayout::AbstractEdge *agedge : graph.edges)
+            data.edges.append( qMakePair(nodeIndexMap.value(agedge->node1(), -1),
+                                         nodeIndexMap.value(agedge->node2(), -1)) );
+
+        m_graphsData.append(data);
     }
 
     for(CharacterRelationshipsGraphNode *node : nodes)
@@ -836,13 +893,196 @@ void CharacterRelationshipsGraph::load()
         edge->setEvaluatePathAllowed(true);
     }
 
-    // Update the models and bounding rectangle
+    // Update the models and lets nodes settle as the layout progresses.
+    m_graphs = graphs;
     m_nodes.assign(nodes);
     m_edges.assign(edges);
 
+    this->arrangeNodes();
+    this->startLayout(minimumEdgeLengths);
+}
+
+void CharacterRelationshipsGraph::loadLater()
+{
+    m_loadTimer.start(100, this);
+}
+
+void CharacterRelationshipsGraph::startLayout(const QList<qreal> &minimumEdgeLengths)
+{
+    bool layoutRequired = false;
+    for(const GraphLayout::GraphData &data : qAsConst(m_graphsData))
+    {
+        layoutRequired = !data.edges.isEmpty();
+        if(layoutRequired)
+            break;
+    }
+
+    if(!layoutRequired)
+    {
+        this->finishLayout();
+        return;
+    }
+
+    QSharedPointer<CharacterRelationshipsGraphLayoutJob> job(new CharacterRelationshipsGraphLayoutJob);
+    job->graphs = m_graphsData;
+    job->publishedGraphs = m_graphsData;
+    job->minimumEdgeLengths = minimumEdgeLengths;
+    job->maxTime = m_maxTime;
+    job->maxIterations = m_maxIterations;
+
+    m_layoutJob = job;
+    m_layoutRevision = 0;
+
+    // The job is kept alive by the worker, even if we cancel and drop it.
+    QtConcurrent::run([job]() { job->run(); });
+
+    m_layoutTimer.start(40, this);
+}
+
+void CharacterRelationshipsGraph::cancelLayout()
+{
+    m_layoutTimer.stop();
+
+    if(!m_layoutJob.isNull())
+    {
+        m_layoutJob->cancel();
+        m_layoutJob.clear();
+    }
+}
+
+void CharacterRelationshipsGraph::pollLayout()
+{
+    if(m_layoutJob.isNull())
+    {
+        m_layoutTimer.stop();
+        return;
+    }
+
+    bool changed = false;
+    bool finished = false;
+    {
+        QMutexLocker locker(&m_layoutJob->mutex);
+        finished = m_layoutJob->finished;
+        if(m_layoutJob->revision != m_layoutRevision)
+        {
+            m_graphsData = m_layoutJob->publishedGraphs;
+            m_layoutRevision = m_layoutJob->revision;
+            changed = true;
+        }
+    }
+
+    if(changed)
+        this->arrangeNodes();
+
+    if(finished)
+        this->finishLayout();
+}
+
+void CharacterRelationshipsGraph::arrangeNodes()
+{
+    // Nodes of each graph are placed where the layout wants them, after which
+    // all the graphs are arranged in a row. The first graph consists of lone
+    // characters, which are placed in a regular grid.
+    QRectF boundingRect(m_leftMargin,m_topMargin,0,0);
+    for(int i=0; i<m_graphs.size(); i++)
+    {
+        const GraphLayout::Graph &graph = m_graphs.at(i);
+        if(graph.nodes.isEmpty())
+            continue;
+
+        const GraphLayout::GraphData data = m_graphsData.value(i);
+        const int nrNodes = graph.nodes.size();
+        const int nrCols = qFloor( qSqrt(qreal(nrNodes)) );
+
+        int col = 0;
+        QPointF gridPos;
+        QRectF graphRect;
+        QVector<QRectF> nodeRects(nrNodes);
+        for(int j=0; j<nrNodes; j++)
+        {
+            CharacterRelationshipsGraphNode *gnode =
+                    qobject_cast<CharacterRelationshipsGraphNode*>(graph.nodes.at(j)->containerObject());
+
+            QRectF rect = gnode->rect();
+            if(!gnode->m_placedByUser)
+            {
+                if(i == 0)
+                {
+                    rect.moveCenter(gridPos);
+                    ++col;
+                    if(col < nrCols)
+                        gridPos.setX( gridPos.x() + rect.width()*1.5 );
+                    else {
+                        gridPos.setX(0);
+                        gridPos.setY( gridPos.y() + rect.height()*1.5 );
+                        col = 0;
+                    }
+                }
+                else if(j < data.positions.size())
+                    rect.moveCenter(data.positions.at(j) * data.scale);
+                else
+                    rect.moveTopLeft(QPointF(0,0));
+            }
+
+            nodeRects[j] = rect;
+            graphRect |= rect;
+        }
+
+        // Move the nodes such that they are layed out in a row.
+        const QPointF dp = -graphRect.topLeft() + boundingRect.topRight();
+        for(int j=0; j<nrNodes; j++)
+        {
+            CharacterRelationshipsGraphNode *gnode =
+                    qobject_cast<CharacterRelationshipsGraphNode*>(graph.nodes.at(j)->containerObject());
+            if(!gnode->m_placedByUser)
+                gnode->setRect( nodeRects.at(j).translated(dp) );
+        }
+        graphRect.moveTopLeft( graphRect.topLeft() + dp );
+
+        boundingRect |= graphRect;
+        if(i < m_graphs.size()-1)
+            boundingRect.setRight( boundingRect.right() + 100 );
+    }
+
     boundingRect.setRight( boundingRect.right() + m_rightMargin );
     boundingRect.setBottom( boundingRect.bottom() + m_bottomMargin );
     this->setGraphBoundingRect(boundingRect);
+}
+
+void CharacterRelationshipsGraph::finishLayout()
+{
+    m_layoutTimer.stop();
+    m_layoutJob.clear();
+
+    // Remember where nodes ended up, so that the next layout can start from there
+    // instead of starting all over again.
+    for(int i=1; i<m_graphs.size() && i<m_graphsData.size(); i++)
+    {
+        const GraphLayout::Graph &graph = m_graphs.at(i);
+        const GraphLayout::GraphData &data = m_graphsData.at(i);
+        if(data.positions.size() != graph.nodes.size())
+            continue;
+
+        for(int j=0; j<graph.nodes.size(); j++)
+        {
+            CharacterRelationshipsGraphNode *gnode =
+                    qobject_cast<CharacterRelationshipsGraphNode*>(graph.nodes.at(j)->containerObject());
+            if(gnode->character() != nullptr)
+                m_layoutPositions.insert(gnode->character()->name(), data.positions.at(j));
+        }
+    }
+
+    // Nodes whose items were created while the layout was in progress are now
+    // in their final place.
+    const QList<CharacterRelationshipsGraphNode*> nodes = m_nodes.list();
+    for(CharacterRelationshipsGraphNode *node : nodes)
+    {
+        if(node->item() != nullptr && node->character() != nullptr && !node->m_placedByUser)
+        {
+            node->m_placedByUser = true;
+            this->updateGraphJsonFromNode(node);
+        }
+    }
 
     this->setBusy(false);
     this->setDirty(false);
@@ -850,11 +1090,6 @@ void CharacterRelationshipsGraph::load()
     emit updated();
 }
 
-void CharacterRelationshipsGraph::loadLater()
-{
-    m_loadTimer.start(100, this);
-}
-
 void CharacterRelationshipsGraph::setDirty(bool val)
 {
     if(m_dirty == val)
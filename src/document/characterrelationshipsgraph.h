@@ -14,7 +14,9 @@
 #ifndef CHARACTERRELATIONSHIPSGRAPH_H
 #define CHARACTERRELATIONSHIPSGRAPH_H
 
+#include <QHash>
 #include <QObject>
+#include <QSharedPointer>
 
 #include "structure.h"
 #include "graphlayout.h"
@@ -22,6 +24,7 @@
 #include "objectlistpropertymodel.h"
 
 class CharacterRelationshipsGraph;
+class CharacterRelationshipsGraphLayoutJob;
 
 class CharacterRelationshipsGraphNode : public QObject, public GraphLayout::AbstractNode
 {
@@ -228,6 +231,8 @@ public:
     bool isBusy() const { return m_busy; }
     Q_SIGNAL void busyChanged();
 
+    bool isLayoutInProgress() const { return !m_layoutJob.isNull(); }
+
     Q_INVOKABLE void reload();
     Q_INVOKABLE void reset();
 
@@ -251,6 +256,11 @@ private:
     void resetCharacter();
     void load();
     void loadLater();
+    void startLayout(const QList<qreal> &minimumEdgeLengths);
+    void cancelLayout();
+    void pollLayout();
+    void arrangeNodes();
+    void finishLayout();
     void markDirty() { this->setDirty(true); }
     void setDirty(bool val);
     void setBusy(bool val);
@@ -269,6 +279,12 @@ private:
     bool m_componentLoaded = false;
     QRectF m_graphBoundingRect = QRectF(0,0,500,500);
     ExecLaterTimer m_loadTimer;
+    ExecLaterTimer m_layoutTimer;
+    int m_layoutRevision = 0;
+    QList<GraphLayout::Graph> m_graphs;
+    QList<GraphLayout::GraphData> m_graphsData;
+    QHash<QString,QPointF> m_layoutPositions;
+    QSharedPointer<CharacterRelationshipsGraphLayoutJob> m_layoutJob;
     QObjectProperty<Character> m_character;
     QObjectProperty<Structure> m_structure;
     ObjectListPropertyModel<CharacterRelationshipsGraphNode*> m_nodes;
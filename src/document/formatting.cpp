@@ -30,6 +30,11 @@
 #include <QClipboard>
 #include <QMimeData>
 #include <QJsonDocument>
+#include <QTextLayout>
+
+#include <limits>
+#include <numeric>
+#include <algorithm>
 
 static const int IsWordMisspelledProperty = QTextCharFormat::UserProperty+100;
 static const int WordSuggestionsProperty = IsWordMisspelledProperty+1;
@@ -1163,10 +1168,111 @@ SceneDocumentBlockUserData *SceneDocumentBlockUserData::get(QTextBlockUserData *
     return userData2;
 }
 
+RehighlightScheduler *RehighlightScheduler::instance()
+{
+    static RehighlightScheduler *theInstance = new RehighlightScheduler(qApp);
+    return theInstance;
+}
+
+RehighlightScheduler::RehighlightScheduler(QObject *parent)
+    : QObject(parent),
+      m_timer("RehighlightScheduler.m_timer")
+{
+
+}
+
+RehighlightScheduler::~RehighlightScheduler()
+{
+    m_timer.stop();
+}
+
+void RehighlightScheduler::setSliceBudget(int val)
+{
+    val = qMax(1, val);
+    if(m_sliceBudget == val)
+        return;
+
+    m_sliceBudget = val;
+    emit sliceBudgetChanged();
+}
+
+void RehighlightScheduler::schedule(SceneDocumentBinder *binder)
+{
+    if(binder == nullptr || m_binders.contains(binder))
+        return;
+
+    m_binders.append(binder);
+    emit pendingCountChanged();
+
+    // Requests that come in quick succession are handled together. While
+    // slices are being run, the next one is already scheduled.
+    if(!m_running)
+        m_timer.start(100, this);
+}
+
+void RehighlightScheduler::cancel(SceneDocumentBinder *binder)
+{
+    if(m_binders.removeOne(binder))
+    {
+        emit pendingCountChanged();
+        if(m_binders.isEmpty())
+        {
+            m_timer.stop();
+            m_running = false;
+        }
+    }
+}
+
+void RehighlightScheduler::timerEvent(QTimerEvent *event)
+{
+    if(event->timerId() == m_timer.timerId())
+    {
+        m_timer.stop();
+        this->runSlice();
+    }
+}
+
+void RehighlightScheduler::runSlice()
+{
+    PROFILE_THIS_FUNCTION;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const qint64 budget = qint64(m_sliceBudget) * 1000000;
+    const int countBefore = m_binders.size();
+
+    while(!m_binders.isEmpty() && timer.nsecsElapsed() < budget)
+    {
+        // The binder the user is typing into comes first, others are
+        // taken up in the order in which they asked for it.
+        SceneDocumentBinder *binder = m_binders.first();
+        for(SceneDocumentBinder *b : qAsConst(m_binders))
+        {
+            if(b->cursorPosition() >= 0)
+            {
+                binder = b;
+                break;
+            }
+        }
+
+        if( !binder->rehighlightQueuedBlocks(timer, budget) )
+            m_binders.removeOne(binder);
+    }
+
+    if(m_binders.size() != countBefore)
+        emit pendingCountChanged();
+
+    m_running = !m_binders.isEmpty();
+    if(m_running)
+        m_timer.start(0, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SceneDocumentBinder::SceneDocumentBinder(QObject *parent)
     : QSyntaxHighlighter(parent),
       m_scene(this, "scene"),
-      m_rehighlightTimer("SceneDocumentBinder.m_rehighlightTimer"),
       m_initializeDocumentTimer("SceneDocumentBinder.m_initializeDocumentTimer"),
       m_currentElement(this, "currentElement"),
       m_textDocument(this, "textDocument"),
@@ -1177,7 +1283,7 @@ SceneDocumentBinder::SceneDocumentBinder(QObject *parent)
 
 SceneDocumentBinder::~SceneDocumentBinder()
 {
-
+    RehighlightScheduler::instance()->cancel(this);
 }
 
 void SceneDocumentBinder::setScreenplayFormat(ScreenplayFormat *val)
@@ -1243,6 +1349,8 @@ void SceneDocumentBinder::setTextDocument(QQuickTextDocument *val)
     if(m_textDocument == val)
         return;
 
+    this->cancelRehighlight();
+
     if(this->document() != nullptr)
     {
         this->document()->setUndoRedoEnabled(true);
@@ -1332,6 +1440,39 @@ void SceneDocumentBinder::setTextWidth(qreal val)
     emit textWidthChanged();
 }
 
+void SceneDocumentBinder::setVisible(bool val)
+{
+    if(m_visible == val)
+        return;
+
+    m_visible = val;
+
+    // Queued blocks are kept, but nothing is done about them until the
+    // editor is back in view.
+    if(this->hasPendingRehighlight())
+    {
+        if(m_visible)
+        {
+            m_rehighlightQueueSorted = false;
+            RehighlightScheduler::instance()->schedule(this);
+        }
+        else
+            RehighlightScheduler::instance()->cancel(this);
+    }
+
+    emit visibleChanged();
+}
+
+void SceneDocumentBinder::setVisibleRect(const QRectF &val)
+{
+    if(m_visibleRect == val)
+        return;
+
+    m_visibleRect = val;
+    m_rehighlightQueueSorted = false;
+    emit visibleRectChanged();
+}
+
 void SceneDocumentBinder::setCursorPosition(int val)
 {
     if(m_initializingDocument)
@@ -1974,22 +2115,6 @@ void SceneDocumentBinder::timerEvent(QTimerEvent *te)
         m_initializeDocumentTimer.stop();
         this->initializeDocument();
     }
-    else if(te->timerId() == m_rehighlightTimer.timerId())
-    {
-        m_rehighlightTimer.stop();
-
-        const int nrBlocks = this->document()->blockCount();
-        const int nrTresholdBlocks = nrBlocks >> 1;
-        if(m_rehighlightBlockQueue.size() > nrTresholdBlocks || m_rehighlightBlockQueue.isEmpty())
-            this->QSyntaxHighlighter::rehighlight();
-        else
-        {
-            Q_FOREACH(QTextBlock block, m_rehighlightBlockQueue)
-                this->rehighlightBlock(block);
-        }
-
-        m_rehighlightBlockQueue.clear();
-    }
 }
 
 void SceneDocumentBinder::resetScene()
@@ -2060,6 +2185,7 @@ void SceneDocumentBinder::initializeDocument()
 
     this->setDocumentLoadCount(m_documentLoadCount+1);
     m_initializingDocument = false;
+    this->cancelRehighlight();
     this->QSyntaxHighlighter::rehighlight();
 
     emit documentInitialized();
@@ -2258,12 +2384,29 @@ void SceneDocumentBinder::onSpellCheckUpdated()
 
 void SceneDocumentBinder::onContentsChange(int from, int charsRemoved, int charsAdded)
 {
+    // Blocks queued for rehighlighting are kept by number. Blocks inserted or
+    // removed here shift the numbers of all blocks after this one. Queued
+    // blocks that were removed fall back to the block where the change is.
+    if(!m_rehighlightBlockQueue.isEmpty() && this->document() != nullptr)
+    {
+        const int blockCount = this->document()->blockCount();
+        const int delta = blockCount - m_rehighlightBlockCount;
+        if(delta != 0)
+        {
+            const int fromBlockNr = this->document()->findBlock(from).blockNumber();
+            for(int &blockNr : m_rehighlightBlockQueue)
+            {
+                if(blockNr > fromBlockNr)
+                    blockNr = qMax(fromBlockNr, blockNr+delta);
+            }
+            m_rehighlightQueueSorted = false;
+        }
+        m_rehighlightBlockCount = blockCount;
+    }
+
     if(m_initializingDocument || m_sceneIsBeingReset)
         return;
 
-    Q_UNUSED(charsRemoved)
-    Q_UNUSED(charsAdded)
-
     if(m_textDocument == nullptr || m_scene == nullptr || this->document() == nullptr)
         return;
 
@@ -2530,13 +2673,129 @@ void SceneDocumentBinder::onSceneReset(int position)
 
 void SceneDocumentBinder::rehighlightLater()
 {
-    m_rehighlightTimer.start(100, this);
+    m_rehighlightAll = true;
+    m_rehighlightBlockQueue.clear();
+    if(m_visible && this->document() != nullptr)
+        RehighlightScheduler::instance()->schedule(this);
 }
 
 void SceneDocumentBinder::rehighlightBlockLater(const QTextBlock &block)
 {
-    m_rehighlightBlockQueue << block;
-    this->rehighlightLater();
+    if(m_rehighlightAll || !block.isValid())
+        return;
+
+    if(m_rehighlightBlockQueue.isEmpty())
+        m_rehighlightBlockCount = block.document()->blockCount();
+
+    m_rehighlightBlockQueue << block.blockNumber();
+    m_rehighlightQueueSorted = false;
+    if(m_visible && this->document() != nullptr)
+        RehighlightScheduler::instance()->schedule(this);
+}
+
+void SceneDocumentBinder::cancelRehighlight()
+{
+    RehighlightScheduler::instance()->cancel(this);
+    m_rehighlightAll = false;
+    m_rehighlightBlockQueue.clear();
+}
+
+void SceneDocumentBinder::prepareRehighlightQueue()
+{
+    QTextDocument *document = this->document();
+
+    if(m_rehighlightAll)
+    {
+        m_rehighlightAll = false;
+        m_rehighlightBlockCount = document->blockCount();
+        m_rehighlightBlockQueue.clear();
+        m_rehighlightBlockQueue.reserve(m_rehighlightBlockCount);
+        for(int i=0; i<m_rehighlightBlockCount; i++)
+            m_rehighlightBlockQueue << i;
+    }
+
+    // Blocks on screen come first, then the ones closest to them. Positions
+    // are taken from the last layout, asking the document layout for them
+    // would lay out the whole document all over again. Without a visible
+    // rect, blocks are ordered by their distance from the cursor.
+    const bool hasVisibleRect = m_visibleRect.isValid();
+    const int blockCount = document->blockCount();
+    const int cursorBlockNr = m_cursorPosition >= 0 ? document->findBlock(m_cursorPosition).blockNumber() : 0;
+    const qreal top = m_visibleRect.top();
+    const qreal bottom = m_visibleRect.bottom();
+
+    QVector< QPair<qreal,int> > keys;
+    keys.reserve(m_rehighlightBlockQueue.size());
+    for(int i=0; i<m_rehighlightBlockQueue.size(); i++)
+    {
+        const int blockNr = m_rehighlightBlockQueue.at(i);
+        const QTextBlock block = hasVisibleRect ? document->findBlockByNumber(blockNr) : QTextBlock();
+        qreal distance = 0;
+        if(blockNr < 0 || blockNr >= blockCount)
+            distance = std::numeric_limits<qreal>::max();
+        else if(hasVisibleRect)
+        {
+            const QTextLayout *layout = block.layout();
+            const qreal y = layout->position().y();
+            const qreal h = layout->boundingRect().height();
+            distance = y > bottom ? y - bottom : (y+h < top ? top - (y+h) : 0);
+        }
+        else
+            distance = qAbs(blockNr - cursorBlockNr);
+        keys << qMakePair(distance, blockNr);
+    }
+
+    QVector<int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&keys](int a, int b) {
+        return keys.at(a) < keys.at(b);
+    });
+
+    // Sorting brings duplicates together, they only need one pass.
+    QList<int> sortedQueue;
+    sortedQueue.reserve(order.size());
+    int lastBlockNr = -1;
+    for(int index : qAsConst(order))
+    {
+        const int blockNr = keys.at(index).second;
+        if(blockNr == lastBlockNr)
+            continue;
+        sortedQueue << blockNr;
+        lastBlockNr = blockNr;
+    }
+
+    m_rehighlightBlockQueue = sortedQueue;
+    m_rehighlightQueueSorted = true;
+}
+
+bool SceneDocumentBinder::rehighlightQueuedBlocks(const QElapsedTimer &timer, qint64 budget)
+{
+    if(this->document() == nullptr)
+    {
+        m_rehighlightAll = false;
+        m_rehighlightBlockQueue.clear();
+        return false;
+    }
+
+    if(!m_visible)
+        return false;
+
+    if(m_rehighlightAll || !m_rehighlightQueueSorted)
+        this->prepareRehighlightQueue();
+
+    // Blocks are looked up only now. Whatever was queued may have been
+    // removed since, in which case there is nothing left to do for it.
+    while(!m_rehighlightBlockQueue.isEmpty())
+    {
+        const QTextBlock block = this->document()->findBlockByNumber( m_rehighlightBlockQueue.takeFirst() );
+        if(block.isValid())
+            this->rehighlightBlock(block);
+
+        if(timer.nsecsElapsed() >= budget)
+            break;
+    }
+
+    return this->hasPendingRehighlight();
 }
 
 void SceneDocumentBinder::onTextFormatChanged()
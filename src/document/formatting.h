@@ -22,6 +22,7 @@
 
 #include <QScreen>
 #include <QPageLayout>
+#include <QElapsedTimer>
 #include <QTextCharFormat>
 #include <QTextBlockFormat>
 #include <QPagedPaintDevice>
@@ -437,6 +438,51 @@ private:
     QColor m_backgroundColor = Qt::transparent;
 };
 
+class SceneDocumentBinder;
+
+/**
+ * Rehighlighting is shared by all SceneDocumentBinder instances, so that
+ * formatting changes which touch every open scene editor don't freeze the UI.
+ * Queued blocks are highlighted in slices of at most sliceBudget milliseconds,
+ * binder with the cursor first, and each binder's blocks in visible-first order.
+ * Binders that are destroyed or scrolled out of view are dropped from the queue.
+ */
+
+class RehighlightScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static RehighlightScheduler *instance();
+    ~RehighlightScheduler();
+
+    // In milliseconds
+    Q_PROPERTY(int sliceBudget READ sliceBudget WRITE setSliceBudget NOTIFY sliceBudgetChanged)
+    void setSliceBudget(int val);
+    int sliceBudget() const { return m_sliceBudget; }
+    Q_SIGNAL void sliceBudgetChanged();
+
+    Q_PROPERTY(int pendingCount READ pendingCount NOTIFY pendingCountChanged)
+    int pendingCount() const { return m_binders.size(); }
+    Q_SIGNAL void pendingCountChanged();
+
+    void schedule(SceneDocumentBinder *binder);
+    void cancel(SceneDocumentBinder *binder);
+
+protected:
+    RehighlightScheduler(QObject *parent=nullptr);
+    void timerEvent(QTimerEvent *event);
+
+private:
+    void runSlice();
+
+private:
+    bool m_running = false;
+    int m_sliceBudget = 4;
+    ExecLaterTimer m_timer;
+    QList<SceneDocumentBinder*> m_binders;
+};
+
 class SceneDocumentBinder : public QSyntaxHighlighter, public QQmlParserStatus
 {
     Q_OBJECT
@@ -484,6 +530,20 @@ public:
     Q_PROPERTY(TextFormat* textFormat READ textFormat CONSTANT)
     TextFormat* textFormat() const { return m_textFormat; }
 
+    // Whether the editor is within the view. Queued rehighlighting is
+    // dropped while it is not, and redone once it comes back into view.
+    Q_PROPERTY(bool visible READ isVisible WRITE setVisible NOTIFY visibleChanged)
+    void setVisible(bool val);
+    bool isVisible() const { return m_visible; }
+    Q_SIGNAL void visibleChanged();
+
+    // Part of the text document that is on screen, in document coordinates.
+    // Blocks within it are rehighlighted first.
+    Q_PROPERTY(QRectF visibleRect READ visibleRect WRITE setVisibleRect NOTIFY visibleRectChanged)
+    void setVisibleRect(const QRectF &val);
+    QRectF visibleRect() const { return m_visibleRect; }
+    Q_SIGNAL void visibleRectChanged();
+
     Q_SIGNAL void requestCursorPosition(int position);
 
     Q_PROPERTY(QStringList characterNames READ characterNames WRITE setCharacterNames NOTIFY characterNamesChanged)
@@ -604,11 +664,16 @@ private:
 
     void rehighlightLater();
     void rehighlightBlockLater(const QTextBlock &block);
+    void cancelRehighlight();
+    bool hasPendingRehighlight() const { return m_rehighlightAll || !m_rehighlightBlockQueue.isEmpty(); }
+    void prepareRehighlightQueue();
+    bool rehighlightQueuedBlocks(const QElapsedTimer &timer, qint64 budget);
 
     void onTextFormatChanged();
 
 private:
     friend class SpellCheckService;
+    friend class RehighlightScheduler;
     qreal m_textWidth = 0;
     int m_cursorPosition = -1;
     int m_documentLoadCount = 0;
@@ -621,14 +686,18 @@ private:
     QStringList m_characterNames;
     bool m_liveSpellCheckEnabled = true;
     QObjectProperty<Scene> m_scene;
-    ExecLaterTimer m_rehighlightTimer;
+    bool m_visible = true;
+    QRectF m_visibleRect;
+    bool m_rehighlightAll = false;
+    bool m_rehighlightQueueSorted = false;
     QStringList m_autoCompleteHints;
     QStringList m_spellingSuggestions;
     int m_currentElementCursorPosition = -1;
     bool m_wordUnderCursorIsMisspelled = false;
     ExecLaterTimer m_initializeDocumentTimer;
     QList<SceneElement::Type> m_tabHistory;
-    QList<QTextBlock> m_rehighlightBlockQueue;
+    QList<int> m_rehighlightBlockQueue; // block numbers
+    int m_rehighlightBlockCount = 0;
     QObjectProperty<SceneElement> m_currentElement;
     QObjectProperty<QQuickTextDocument> m_textDocument;
     QObjectProperty<ScreenplayFormat> m_screenplayFormat;
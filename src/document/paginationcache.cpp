@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "paginationcache.h"
+#include "timeprofiler.h"
+
+#include <QCoreApplication>
+
+PaginationCache *PaginationCache::instance()
+{
+    static PaginationCache *theInstance = new PaginationCache(qApp);
+    return theInstance;
+}
+
+PaginationCache::PaginationCache(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+PaginationCache::~PaginationCache()
+{
+    while(!m_entries.isEmpty())
+        this->removeAt(m_entries.size()-1);
+}
+
+PaginationCache::Key PaginationCache::key(Screenplay *screenplay, ScreenplayFormat *format, const QString &options)
+{
+    PROFILE_THIS_FUNCTION;
+
+    Key ret;
+    if(screenplay == nullptr || format == nullptr || options.isEmpty())
+        return ret;
+
+    ret.screenplay = screenplay;
+    ret.format = format;
+    ret.options = options;
+
+    // Modification times are counted per object, so the revision of a
+    // screenplay is the list of its objects along with their times. Scene
+    // numbers are resolved lazily, after the screenplay is marked modified,
+    // so they are part of the revision as well.
+    QVector<quintptr> &rev = ret.revision;
+    rev << quintptr(format->modificationTime());
+    rev << quintptr(format->pageLayout()->paperSize());
+    rev << quintptr(screenplay->modificationTime());
+
+    const int nrElements = screenplay->elementCount();
+    for(int i=0; i<nrElements; i++)
+    {
+        const ScreenplayElement *element = screenplay->elementAt(i);
+        rev << quintptr(element) << quintptr(element->modificationTime());
+        rev << quintptr(qHash(element->resolvedSceneNumber()));
+
+        const Scene *scene = element->scene();
+        if(scene == nullptr)
+            continue;
+
+        rev << quintptr(scene) << quintptr(scene->modificationTime());
+        rev << quintptr(scene->type()) << quintptr(scene->heading()->modificationTime());
+
+        const int nrParas = scene->elementCount();
+        rev << quintptr(nrParas);
+        for(int j=0; j<nrParas; j++)
+        {
+            const SceneElement *para = scene->elementAt(j);
+            rev << quintptr(para) << quintptr(para->modificationTime());
+        }
+    }
+
+    return ret;
+}
+
+QTextDocument *PaginationCache::find(const PaginationCache::Key &key)
+{
+    if(key.isValid())
+    {
+        for(int i=m_entries.size()-1; i>=0; i--)
+        {
+            const Entry &entry = m_entries.at(i);
+            if(entry.document.isNull() || !entry.key.isValid())
+            {
+                this->removeAt(i);
+                continue;
+            }
+
+            if(entry.key == key)
+            {
+                ++m_hitCount;
+                return entry.document;
+            }
+        }
+    }
+
+    ++m_missCount;
+    return nullptr;
+}
+
+void PaginationCache::publish(const PaginationCache::Key &key, QTextDocument *document)
+{
+    if(document == nullptr)
+        return;
+
+    const int index = this->indexOf(document);
+    if(index >= 0)
+    {
+        Entry &entry = m_entries[index];
+        entry.key = key;
+        m_entries.move(index, m_entries.size()-1);
+        return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.document = document;
+    m_entries.append(entry);
+
+    // Anything done to the document after this makes it a poor match for
+    // the key, even if it is only being cleared to be loaded again.
+    connect(document, &QTextDocument::contentsChanged, this, [=]() {
+        this->withdraw(document);
+    });
+    connect(document, &QObject::destroyed, this, &PaginationCache::removeDestroyedEntries);
+}
+
+void PaginationCache::withdraw(QTextDocument *document)
+{
+    const int index = this->indexOf(document);
+    if(index >= 0)
+        this->removeAt(index);
+}
+
+void PaginationCache::adopt(const PaginationCache::Key &key, QTextDocument *document)
+{
+    if(document == nullptr)
+        return;
+
+    this->publish(key, document);
+    document->setParent(this);
+
+    const int index = this->indexOf(document);
+    m_entries[index].owned = true;
+
+    int nrAdopted = 0;
+    for(int i=m_entries.size()-1; i>=0; i--)
+    {
+        if(m_entries.at(i).owned && ++nrAdopted > m_maxAdoptedCount)
+            this->removeAt(i);
+    }
+}
+
+int PaginationCache::indexOf(const QTextDocument *document) const
+{
+    for(int i=0; i<m_entries.size(); i++)
+    {
+        if(m_entries.at(i).document == document)
+            return i;
+    }
+
+    return -1;
+}
+
+void PaginationCache::removeDestroyedEntries()
+{
+    for(int i=m_entries.size()-1; i>=0; i--)
+    {
+        if(m_entries.at(i).document.isNull())
+            m_entries.removeAt(i);
+    }
+}
+
+void PaginationCache::removeAt(int index)
+{
+    const Entry entry = m_entries.takeAt(index);
+    if(entry.document.isNull())
+        return;
+
+    disconnect(entry.document, nullptr, this, nullptr);
+    if(entry.owned)
+        entry.document->deleteLater();
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef PAGINATIONCACHE_H
+#define PAGINATIONCACHE_H
+
+#include <QList>
+#include <QObject>
+#include <QVector>
+#include <QPointer>
+#include <QTextDocument>
+
+#include "formatting.h"
+#include "screenplay.h"
+
+/**
+ * Laying out a screenplay into pages is the most expensive part of showing
+ * a print preview or exporting a PDF. ScreenplayTextDocument instances
+ * publish the documents they have laid out here, so that a PDF export
+ * which asks for the same screenplay, format and options right after a
+ * preview can print the already paginated document instead of building
+ * and laying out one of its own.
+ *
+ * Documents are looked up by Key, which captures the revision of every
+ * object in the screenplay and format along with the options used to load
+ * the document. A published document is dropped the moment its contents
+ * change, so a document that is found always matches the key it was
+ * published with.
+ */
+class PaginationCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static PaginationCache *instance();
+    ~PaginationCache();
+
+    struct Key
+    {
+        QPointer<Screenplay> screenplay;
+        QPointer<ScreenplayFormat> format;
+        QString options;
+        QVector<quintptr> revision;
+
+        bool isValid() const {
+            return !screenplay.isNull() && !format.isNull() && !options.isEmpty();
+        }
+        bool operator == (const Key &other) const {
+            return screenplay == other.screenplay && format == other.format &&
+                   options == other.options && revision == other.revision;
+        }
+    };
+
+    // Options are empty if the document cannot be shared.
+    static Key key(Screenplay *screenplay, ScreenplayFormat *format, const QString &options);
+
+    // Returns a document laid out for the key, or null. The document must be
+    // used right away and must not be modified.
+    QTextDocument *find(const Key &key);
+
+    // The cache only borrows published documents. Publishing a document
+    // again replaces the key it was published with earlier.
+    void publish(const Key &key, QTextDocument *document);
+    void withdraw(QTextDocument *document);
+
+    // Takes ownership of the document. Only the most recently adopted
+    // documents are kept alive.
+    void adopt(const Key &key, QTextDocument *document);
+
+    int hitCount() const { return m_hitCount; }
+    int missCount() const { return m_missCount; }
+
+protected:
+    PaginationCache(QObject *parent=nullptr);
+
+private:
+    struct Entry
+    {
+        Key key;
+        QPointer<QTextDocument> document;
+        bool owned = false;
+    };
+    int indexOf(const QTextDocument *document) const;
+    void removeAt(int index);
+    void removeDestroyedEntries();
+
+private:
+    int m_hitCount = 0;
+    int m_missCount = 0;
+    int m_maxAdoptedCount = 2;
+    QList<Entry> m_entries;
+};
+
+#endif // PAGINATIONCACHE_H
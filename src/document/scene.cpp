@@ -453,15 +453,29 @@ bool CharacterElementMap::include(SceneElement *element)
 
     if(element->type() == SceneElement::Character)
     {
-        const bool ret = this->remove(element);
-
         QString newName = element->formattedText();
         newName = newName.section('(', 0, 0).trimmed();
+
+        // Most edits to a character paragraph dont change the name it refers to.
+        // No need to touch the maps in that case.
+        if(!newName.isEmpty() && m_forwardMap.value(element) == newName)
+            return false;
+
+        const bool ret = this->remove(element);
         if(newName.isEmpty())
             return ret;
 
+        QMap< QString, QList<SceneElement*> >::iterator it = m_reverseMap.find(newName);
+        if(it == m_reverseMap.end())
+        {
+            it = m_reverseMap.insert(newName, QList<SceneElement*>());
+            this->markNamesChanged();
+        }
+
         m_forwardMap[element] = newName;
-        m_reverseMap[newName].append(element);
+        it.value().append(element);
+        if(m_completionTrie)
+            m_completionTrie->add(newName);
         return true;
     }
 
@@ -481,9 +495,13 @@ bool CharacterElementMap::remove(SceneElement *element)
         QList<SceneElement*> &list = m_reverseMap[oldName];
         if(list.removeOne(element))
         {
+            if(m_completionTrie)
+                m_completionTrie->remove(oldName);
+
             if(list.isEmpty())
             {
                 m_reverseMap.remove(oldName);
+                this->markNamesChanged();
                 return true;
             }
 
@@ -511,12 +529,22 @@ bool CharacterElementMap::remove(const QString &name)
     Q_FOREACH(SceneElement *element, elements)
         m_forwardMap.take(element);
 
+    if(m_completionTrie)
+        m_completionTrie->removeAll(name);
+
+    this->markNamesChanged();
     return true;
 }
 
 QStringList CharacterElementMap::characterNames() const
 {
-    return m_reverseMap.keys();
+    if(!m_characterNamesValid)
+    {
+        m_characterNames = m_reverseMap.keys();
+        m_characterNamesValid = true;
+    }
+
+    return m_characterNames;
 }
 
 QList<SceneElement *> CharacterElementMap::characterElements() const
@@ -536,6 +564,30 @@ void CharacterElementMap::include(const CharacterElementMap &other)
         this->include(element);
 }
 
+void CharacterElementMap::setCompletionTrie(CompletionTrie *trie)
+{
+    if(m_completionTrie == trie)
+        return;
+
+    m_completionTrie = trie;
+    if(m_completionTrie == nullptr)
+        return;
+
+    m_completionTrie->clear();
+
+    QMap< QString, QList<SceneElement*> >::const_iterator it = m_reverseMap.constBegin();
+    QMap< QString, QList<SceneElement*> >::const_iterator end = m_reverseMap.constEnd();
+    for(; it != end; ++it)
+        m_completionTrie->add(it.key(), it.value().size());
+}
+
+void CharacterElementMap::markNamesChanged()
+{
+    m_characterNames.clear();
+    m_characterNamesValid = false;
+    ++m_version;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 Scene::Scene(QObject *parent)
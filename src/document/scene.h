@@ -29,6 +29,7 @@
 
 #include "note.h"
 #include "modifiable.h"
+#include "completiontrie.h"
 #include "execlatertimer.h"
 #include "qobjectproperty.h"
 #include "qobjectserializer.h"
@@ -152,15 +153,31 @@ public:
     bool remove(const QString &name);
     bool isEmpty() const { return m_forwardMap.isEmpty() && m_reverseMap.isEmpty(); }
 
+    // The names list is cached and shared (implicitly) with all callers until
+    // the set of names changes. version() is bumped each time that happens.
     QStringList characterNames() const;
+    int version() const { return m_version; }
+
     QList<SceneElement*> characterElements() const;
     QList<SceneElement*> characterElements(const QString &name) const;
 
     void include(const CharacterElementMap &other);
 
+    // If set, the trie is kept in sync with this map. Each name is weighed by
+    // the number of character paragraphs that refer to it.
+    void setCompletionTrie(CompletionTrie *trie);
+    CompletionTrie *completionTrie() const { return m_completionTrie; }
+
+private:
+    void markNamesChanged();
+
 private:
+    CompletionTrie *m_completionTrie = nullptr;
     QMap<SceneElement*,QString> m_forwardMap;
     QMap< QString, QList<SceneElement*> > m_reverseMap;
+    mutable QStringList m_characterNames;
+    mutable bool m_characterNamesValid = false;
+    int m_version = 0;
 };
 
 class Scene : public QAbstractListModel, public QObjectSerializer::Interface, public Modifiable
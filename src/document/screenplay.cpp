@@ -550,7 +550,7 @@ static int screenplayIndexOfElement(Screenplay *screenplay, ScreenplayElement *p
 
 void Screenplay::insertElementAt(ScreenplayElement *ptr, int index)
 {
-    if(ptr == nullptr || m_elements.indexOf(ptr) >= 0)
+    if(ptr == nullptr || this->indexOfElement(ptr) >= 0)
         return;
 
     index = (index < 0 || index >= m_elements.size()) ? m_elements.size() : index;
@@ -565,11 +565,23 @@ void Screenplay::insertElementAt(ScreenplayElement *ptr, int index)
 
     this->beginInsertRows(QModelIndex(), index, index);
     if(index == m_elements.size())
+    {
         m_elements.append(ptr);
+        if(m_elementIndexesValid)
+        {
+            m_elementIndexMap.insert(ptr, index);
+            if(ptr->scene() != nullptr)
+                m_sceneElementIndexMap[ptr->scene()].append(index);
+        }
+    }
     else
+    {
         m_elements.insert(index, ptr);
+        this->invalidateElementIndexes();
+    }
 
     ptr->setParent(this);
+    connect(ptr, &ScreenplayElement::sceneChanged, this, &Screenplay::invalidateElementIndexes);
     connect(ptr, &ScreenplayElement::elementChanged, this, &Screenplay::screenplayChanged);
     connect(ptr, &ScreenplayElement::aboutToDelete, this, &Screenplay::removeElement);
     connect(ptr, &ScreenplayElement::sceneReset, this, &Screenplay::onSceneReset);
@@ -595,7 +607,7 @@ void Screenplay::removeElement(ScreenplayElement *ptr)
     if(ptr == nullptr)
         return;
 
-    const int row = m_elements.indexOf(ptr);
+    const int row = this->indexOfElement(ptr);
     if(row < 0)
         return;
 
@@ -609,12 +621,14 @@ void Screenplay::removeElement(ScreenplayElement *ptr)
 
     this->beginRemoveRows(QModelIndex(), row, row);
     m_elements.removeAt(row);
+    this->invalidateElementIndexes();
 
     disconnect(ptr, &ScreenplayElement::elementChanged, this, &Screenplay::screenplayChanged);
     disconnect(ptr, &ScreenplayElement::aboutToDelete, this, &Screenplay::removeElement);
     disconnect(ptr, &ScreenplayElement::sceneReset, this, &Screenplay::onSceneReset);
     disconnect(ptr, &ScreenplayElement::evaluateSceneNumberRequest, this, &Screenplay::evaluateSceneNumbersLater);
     disconnect(ptr, &ScreenplayElement::sceneTypeChanged, this, &Screenplay::evaluateSceneNumbersLater);
+    disconnect(ptr, &ScreenplayElement::sceneChanged, this, &Screenplay::invalidateElementIndexes);
 
     this->endRemoveRows();
 
@@ -700,7 +714,7 @@ void Screenplay::moveElement(ScreenplayElement *ptr, int toRow)
     if(toRow < 0)
         toRow = m_elements.size()-1;
 
-    const int fromRow = m_elements.indexOf(ptr);
+    const int fromRow = this->indexOfElement(ptr);
     if(fromRow < 0)
         return;
 
@@ -709,6 +723,7 @@ void Screenplay::moveElement(ScreenplayElement *ptr, int toRow)
 
     this->beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(), toRow < fromRow ? toRow : toRow+1);
     m_elements.move(fromRow, toRow);
+    this->invalidateElementIndexes();
     this->endMoveRows();
 
     if(fromRow == m_currentElementIndex)
@@ -894,6 +909,7 @@ void Screenplay::moveSelectedElements(int toRow)
 
         selectedElements.prepend(element);
         m_elements.removeAt(i);
+        this->invalidateElementIndexes();
         fromRow = i;
     }
 
@@ -1034,6 +1050,7 @@ void Screenplay::clearElements()
         // this->removeElement(m_elements.first());
 
         ScreenplayElement *ptr = m_elements.takeLast();
+        this->invalidateElementIndexes();
         emit elementRemoved(ptr, m_elements.size());
         disconnect(ptr, nullptr, this, nullptr);
         GarbageCollector::instance()->add(ptr);
@@ -1416,7 +1433,10 @@ int Screenplay::firstIndexOfScene(Scene *scene) const
 
 int Screenplay::indexOfElement(ScreenplayElement *element) const
 {
-    return m_elements.indexOf(element);
+    if(!m_elementIndexesValid)
+        this->updateElementIndexes();
+
+    return m_elementIndexMap.value(element, -1);
 }
 
 QList<int> Screenplay::sceneElementIndexes(Scene *scene, int max) const
@@ -1425,18 +1445,31 @@ QList<int> Screenplay::sceneElementIndexes(Scene *scene, int max) const
     if(scene == nullptr || max == 0)
         return ret;
 
+    if(!m_elementIndexesValid)
+        this->updateElementIndexes();
+
+    ret = m_sceneElementIndexMap.value(scene);
+    if(max > 0 && ret.size() > max)
+        ret = ret.mid(0, max);
+
+    return ret;
+}
+
+void Screenplay::updateElementIndexes() const
+{
+    m_elementIndexMap.clear();
+    m_sceneElementIndexMap.clear();
+    m_elementIndexMap.reserve(m_elements.size());
+
     for(int i=0; i<m_elements.size(); i++)
     {
         ScreenplayElement *element = m_elements.at(i);
-        if(element->scene() == scene)
-        {
-            ret << i;
-            if(max > 0 && ret.size() == max)
-                break;
-        }
+        m_elementIndexMap.insert(element, i);
+        if(element->scene() != nullptr)
+            m_sceneElementIndexMap[element->scene()].append(i);
     }
 
-    return ret;
+    m_elementIndexesValid = true;
 }
 
 QList<ScreenplayElement *> Screenplay::sceneElements(Scene *scene, int max) const
@@ -1499,6 +1532,7 @@ bool Screenplay::setElements(const QList<ScreenplayElement *> &list)
 
     this->beginResetModel();
     m_elements = list;
+    this->invalidateElementIndexes();
     this->endResetModel();
 
     emit elementsChanged();
@@ -1757,10 +1791,13 @@ void Screenplay::setPropertyFromObjectList(const QString &propName, const QList<
             connect(ptr, &ScreenplayElement::sceneTypeChanged, this, &Screenplay::evaluateSceneNumbersLater);
             if(ptr->elementType() == ScreenplayElement::BreakElementType)
                 connect(ptr, &ScreenplayElement::breakTitleChanged, this, &Screenplay::breakTitleChanged);
+            connect(ptr, &ScreenplayElement::sceneChanged, this, &Screenplay::invalidateElementIndexes);
 
             m_elements.append(ptr);
         }
 
+        this->invalidateElementIndexes();
+
         this->endResetModel();
 
         emit elementCountChanged();
@@ -349,6 +349,15 @@ private:
     static int staticElementCount(QQmlListProperty<ScreenplayElement> *list);
     QList<ScreenplayElement *> m_elements; // We dont use ObjectListPropertyModel<ScreenplayElement*> for this because
                                            // the Screenplay class is already a list model of screenplay elements.
+
+    // Reverse indexes of m_elements. Appends update them in place, any other change
+    // to m_elements (or to the scene of an element) causes them to be rebuilt upon
+    // the next lookup.
+    void updateElementIndexes() const;
+    void invalidateElementIndexes() { m_elementIndexesValid = false; }
+    mutable bool m_elementIndexesValid = false;
+    mutable QHash<ScreenplayElement*,int> m_elementIndexMap;
+    mutable QHash<Scene*, QList<int> > m_sceneElementIndexMap;
     int m_currentElementIndex = -1;
     QObjectProperty<Scene> m_activeScene;
     bool m_hasNonStandardScenes = false;
@@ -0,0 +1,483 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "screenplaysnapshot.h"
+#include "timeprofiler.h"
+
+#include <QtMath>
+#include <algorithm>
+
+struct ScreenplaySnapshotData
+{
+    QStringList strings;
+    QHash<QString,int> stringIds;
+
+    QHash<const ScreenplayElement*,int> elementScenes;
+
+    QVector<int> sceneElementIndex;
+    QVector<int> sceneNumber;
+    QVector<int> sceneHeading;
+    QVector<int> sceneLocation;
+    QVector<int> sceneLocationType;
+    QVector<int> sceneMoment;
+    QVector<QString> sceneTitle;
+    QVector<int> sceneWordCount;
+    QVector<qreal> scenePageCount;
+
+    // Scene N owns entries [offset[N], offset[N+1]) of the arrays these
+    // offsets point into. Character ids of a scene are sorted by id.
+    QVector<int> sceneParagraphOffset;
+    QVector<int> sceneCharacterOffset;
+    QVector<int> sceneCharacterIds;
+
+    QVector<int> characters;
+    QHash<int,int> characterIndex;
+    QVector<int> characterSceneOffset;
+    QVector<int> characterSceneIds;
+
+    QVector<quint8> paragraphTypes;
+    QVector<QString> paragraphTexts;
+    QVector<int> paragraphScenes;
+
+    int wordCount = 0;
+    qreal pageCount = 0;
+
+    int intern(const QString &string) {
+        if(string.isEmpty())
+            return -1;
+        const int nextId = strings.size();
+        const int id = stringIds.value(string, nextId);
+        if(id == nextId) {
+            strings.append(string);
+            stringIds.insert(string, id);
+        }
+        return id;
+    }
+
+    inline QVector<int> range(const QVector<int> &array, const QVector<int> &offsets, int index) const {
+        if(index < 0 || index >= offsets.size()-1)
+            return QVector<int>();
+        return array.mid(offsets.at(index), offsets.at(index+1)-offsets.at(index));
+    }
+};
+
+Q_GLOBAL_STATIC(ScreenplaySnapshotData, EmptySnapshotData)
+
+ScreenplaySnapshot::ScreenplaySnapshot()
+{
+
+}
+
+ScreenplaySnapshot::~ScreenplaySnapshot()
+{
+
+}
+
+#define SNAPSHOT_DATA const ScreenplaySnapshotData *data = d.isNull() ? EmptySnapshotData() : d.data()
+
+QString ScreenplaySnapshot::string(int id) const
+{
+    SNAPSHOT_DATA;
+    return id >= 0 && id < data->strings.size() ? data->strings.at(id) : QString();
+}
+
+int ScreenplaySnapshot::stringId(const QString &string) const
+{
+    SNAPSHOT_DATA;
+    return data->stringIds.value(string, -1);
+}
+
+int ScreenplaySnapshot::sceneCount() const
+{
+    SNAPSHOT_DATA;
+    return data->sceneElementIndex.size();
+}
+
+int ScreenplaySnapshot::sceneIndexOf(const ScreenplayElement *element) const
+{
+    SNAPSHOT_DATA;
+    return data->elementScenes.value(element, -1);
+}
+
+int ScreenplaySnapshot::sceneElementIndex(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneElementIndex.value(scene, -1);
+}
+
+int ScreenplaySnapshot::sceneNumber(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneNumber.value(scene, -1);
+}
+
+int ScreenplaySnapshot::sceneHeading(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneHeading.value(scene, -1);
+}
+
+int ScreenplaySnapshot::sceneLocation(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneLocation.value(scene, -1);
+}
+
+int ScreenplaySnapshot::sceneLocationType(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneLocationType.value(scene, -1);
+}
+
+int ScreenplaySnapshot::sceneMoment(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneMoment.value(scene, -1);
+}
+
+QString ScreenplaySnapshot::sceneTitle(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneTitle.value(scene);
+}
+
+int ScreenplaySnapshot::sceneWordCount(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneWordCount.value(scene, 0);
+}
+
+qreal ScreenplaySnapshot::scenePageCount(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->scenePageCount.value(scene, 0);
+}
+
+QVector<int> ScreenplaySnapshot::characters() const
+{
+    SNAPSHOT_DATA;
+    return data->characters;
+}
+
+QVector<int> ScreenplaySnapshot::sceneCharacters(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->range(data->sceneCharacterIds, data->sceneCharacterOffset, scene);
+}
+
+QVector<int> ScreenplaySnapshot::characterScenes(int character) const
+{
+    SNAPSHOT_DATA;
+    return data->range(data->characterSceneIds, data->characterSceneOffset, data->characterIndex.value(character, -1));
+}
+
+bool ScreenplaySnapshot::sceneHasCharacter(int scene, int character) const
+{
+    SNAPSHOT_DATA;
+    if(scene < 0 || scene >= data->sceneElementIndex.size() || character < 0)
+        return false;
+
+    const int *begin = data->sceneCharacterIds.constData() + data->sceneCharacterOffset.at(scene);
+    const int *end = data->sceneCharacterIds.constData() + data->sceneCharacterOffset.at(scene+1);
+    return std::binary_search(begin, end, character);
+}
+
+int ScreenplaySnapshot::paragraphCount() const
+{
+    SNAPSHOT_DATA;
+    return data->paragraphTypes.size();
+}
+
+int ScreenplaySnapshot::sceneFirstParagraph(int scene) const
+{
+    SNAPSHOT_DATA;
+    return data->sceneParagraphOffset.value(scene, -1);
+}
+
+int ScreenplaySnapshot::sceneParagraphCount(int scene) const
+{
+    SNAPSHOT_DATA;
+    if(scene < 0 || scene >= data->sceneElementIndex.size())
+        return 0;
+    return data->sceneParagraphOffset.at(scene+1) - data->sceneParagraphOffset.at(scene);
+}
+
+SceneElement::Type ScreenplaySnapshot::paragraphType(int paragraph) const
+{
+    SNAPSHOT_DATA;
+    return SceneElement::Type( data->paragraphTypes.value(paragraph, SceneElement::Action) );
+}
+
+QString ScreenplaySnapshot::paragraphText(int paragraph) const
+{
+    SNAPSHOT_DATA;
+    return data->paragraphTexts.value(paragraph);
+}
+
+int ScreenplaySnapshot::paragraphScene(int paragraph) const
+{
+    SNAPSHOT_DATA;
+    return data->paragraphScenes.value(paragraph, -1);
+}
+
+int ScreenplaySnapshot::wordCount() const
+{
+    SNAPSHOT_DATA;
+    return data->wordCount;
+}
+
+qreal ScreenplaySnapshot::pageCount() const
+{
+    SNAPSHOT_DATA;
+    return data->pageCount;
+}
+
+qreal ScreenplaySnapshot::estimatePageCount(SceneElement::Type type, const QString &text)
+{
+    // Characters per line and blank lines after each paragraph type,
+    // on a US Letter page set in 12pt Courier, 55 lines to a page.
+    static const int linesPerPage = 55;
+    static const int charsPerLine[] = { 60, 38, 35, 25, 60, 60, 60 };
+    static const int spacingAfter[] = { 1, 0, 1, 0, 1, 1, 1 };
+
+    const int index = qBound(int(SceneElement::Min), int(type), int(SceneElement::Max));
+    const int nrLines = qMax(1, qCeil(qreal(text.length())/charsPerLine[index])) + spacingAfter[index];
+    return qreal(nrLines)/linesPerPage;
+}
+
+int ScreenplaySnapshot::countWords(const QString &text)
+{
+    int ret = 0;
+    bool inWord = false;
+    for(const QChar &ch : text)
+    {
+        const bool space = ch.isSpace();
+        if(!space && !inWord)
+            ++ret;
+        inWord = !space;
+    }
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct ScreenplaySnapshotBuilder::SceneRecord
+{
+    QString title;
+    QString heading;
+    QString location;
+    QString locationType;
+    QString moment;
+    QStringList characterNames;
+    QVector<quint8> paragraphTypes;
+    QVector<QString> paragraphTexts;
+    int wordCount = 0;
+    qreal pageCount = 0;
+};
+
+ScreenplaySnapshotBuilder::ScreenplaySnapshotBuilder(QObject *parent)
+    : QObject(parent),
+      m_screenplay(this, "screenplay")
+{
+
+}
+
+ScreenplaySnapshotBuilder::~ScreenplaySnapshotBuilder()
+{
+
+}
+
+void ScreenplaySnapshotBuilder::setScreenplay(Screenplay *val)
+{
+    if(m_screenplay == val)
+        return;
+
+    if(m_screenplay != nullptr)
+        disconnect(m_screenplay, &Screenplay::screenplayChanged, this, &ScreenplaySnapshotBuilder::invalidate);
+
+    m_screenplay = val;
+
+    if(m_screenplay != nullptr)
+        connect(m_screenplay, &Screenplay::screenplayChanged, this, &ScreenplaySnapshotBuilder::invalidate);
+
+    m_sceneRecords.clear();
+    emit screenplayChanged();
+
+    this->invalidate();
+}
+
+ScreenplaySnapshot ScreenplaySnapshotBuilder::snapshot()
+{
+    if(m_valid)
+        return m_snapshot;
+
+    PROFILE_THIS_FUNCTION;
+
+    ScreenplaySnapshotData *data = new ScreenplaySnapshotData;
+
+    const int nrElements = m_screenplay == nullptr ? 0 : m_screenplay->elementCount();
+    data->sceneParagraphOffset.append(0);
+    data->sceneCharacterOffset.append(0);
+
+    QVector<int> characterIds;
+    for(int i=0; i<nrElements; i++)
+    {
+        ScreenplayElement *element = m_screenplay->elementAt(i);
+
+        // Scene numbers are evaluated a while after the screenplay changes,
+        // which the screenplay doesn't signal by itself.
+        connect(element, &ScreenplayElement::resolvedSceneNumberChanged,
+                this, &ScreenplaySnapshotBuilder::invalidate, Qt::UniqueConnection);
+
+        Scene *scene = element->scene();
+        if(scene == nullptr)
+            continue;
+
+        const QSharedPointer<const SceneRecord> record = this->sceneRecord(scene);
+        const int sceneIndex = data->sceneElementIndex.size();
+        data->elementScenes.insert(element, sceneIndex);
+
+        data->sceneElementIndex.append(i);
+        data->sceneNumber.append( data->intern(element->resolvedSceneNumber()) );
+        data->sceneHeading.append( data->intern(record->heading) );
+        data->sceneLocation.append( data->intern(record->location) );
+        data->sceneLocationType.append( data->intern(record->locationType) );
+        data->sceneMoment.append( data->intern(record->moment) );
+        data->sceneTitle.append(record->title);
+        data->sceneWordCount.append(record->wordCount);
+        data->scenePageCount.append(record->pageCount);
+        data->wordCount += record->wordCount;
+        data->pageCount += record->pageCount;
+
+        data->paragraphTypes += record->paragraphTypes;
+        data->paragraphTexts += record->paragraphTexts;
+        data->paragraphScenes.insert(data->paragraphScenes.size(), record->paragraphTypes.size(), sceneIndex);
+        data->sceneParagraphOffset.append(data->paragraphTypes.size());
+
+        characterIds.clear();
+        for(const QString &name : record->characterNames)
+            characterIds.append( data->intern(name) );
+        std::sort(characterIds.begin(), characterIds.end());
+        data->sceneCharacterIds += characterIds;
+        data->sceneCharacterOffset.append(data->sceneCharacterIds.size());
+    }
+
+    // Scenes of each character, the other way around of what we have above.
+    const int nrScenes = data->sceneElementIndex.size();
+    QHash<int,int> sceneCounts;
+    for(int id : qAsConst(data->sceneCharacterIds))
+        ++sceneCounts[id];
+
+    data->characters = sceneCounts.keys().toVector();
+    std::sort(data->characters.begin(), data->characters.end(), [data](int a, int b) {
+        return data->strings.at(a) < data->strings.at(b);
+    });
+
+    data->characterSceneOffset.reserve(data->characters.size()+1);
+    data->characterSceneOffset.append(0);
+    for(int i=0; i<data->characters.size(); i++)
+    {
+        const int id = data->characters.at(i);
+        data->characterIndex.insert(id, i);
+        data->characterSceneOffset.append(data->characterSceneOffset.last() + sceneCounts.value(id));
+    }
+
+    data->characterSceneIds.resize(data->sceneCharacterIds.size());
+    QVector<int> fill = data->characterSceneOffset;
+    for(int s=0; s<nrScenes; s++)
+    {
+        for(int j=data->sceneCharacterOffset.at(s); j<data->sceneCharacterOffset.at(s+1); j++)
+        {
+            const int index = data->characterIndex.value(data->sceneCharacterIds.at(j));
+            data->characterSceneIds[ fill[index]++ ] = s;
+        }
+    }
+
+    m_snapshot.d = QSharedPointer<const ScreenplaySnapshotData>(data);
+    m_valid = true;
+    return m_snapshot;
+}
+
+QSharedPointer<const ScreenplaySnapshotBuilder::SceneRecord> ScreenplaySnapshotBuilder::sceneRecord(Scene *scene)
+{
+    QSharedPointer<const SceneRecord> ret = m_sceneRecords.value(scene);
+    if(!ret.isNull())
+        return ret;
+
+    SceneRecord *record = new SceneRecord;
+    record->title = scene->title();
+
+    const SceneHeading *heading = scene->heading();
+    if(heading->isEnabled())
+    {
+        record->heading = heading->text();
+        record->location = heading->location().toUpper();
+        record->locationType = heading->locationType();
+        record->moment = heading->moment();
+        record->wordCount = ScreenplaySnapshot::countWords(record->heading);
+        record->pageCount = ScreenplaySnapshot::estimatePageCount(SceneElement::Heading, record->heading);
+    }
+
+    record->characterNames = scene->characterNames();
+
+    const int nrElements = scene->elementCount();
+    record->paragraphTypes.reserve(nrElements);
+    record->paragraphTexts.reserve(nrElements);
+    for(int i=0; i<nrElements; i++)
+    {
+        const SceneElement *element = scene->elementAt(i);
+        const QString text = element->formattedText();
+        record->paragraphTypes.append( quint8(element->type()) );
+        record->paragraphTexts.append(text);
+        record->wordCount += ScreenplaySnapshot::countWords(text);
+        record->pageCount += ScreenplaySnapshot::estimatePageCount(element->type(), text);
+    }
+
+    connect(scene, &Scene::sceneChanged, this, &ScreenplaySnapshotBuilder::onSceneChanged, Qt::UniqueConnection);
+    connect(scene, &QObject::destroyed, this, &ScreenplaySnapshotBuilder::onSceneDestroyed, Qt::UniqueConnection);
+
+    ret = QSharedPointer<const SceneRecord>(record);
+    m_sceneRecords.insert(scene, ret);
+    return ret;
+}
+
+void ScreenplaySnapshotBuilder::resetScreenplay()
+{
+    m_screenplay = nullptr;
+    m_sceneRecords.clear();
+    emit screenplayChanged();
+
+    this->invalidate();
+}
+
+void ScreenplaySnapshotBuilder::invalidate()
+{
+    if(!m_valid)
+        return;
+
+    m_valid = false;
+    emit snapshotInvalidated();
+}
+
+void ScreenplaySnapshotBuilder::onSceneChanged()
+{
+    if(m_sceneRecords.remove(this->sender()) > 0)
+        this->invalidate();
+}
+
+void ScreenplaySnapshotBuilder::onSceneDestroyed(QObject *object)
+{
+    if(m_sceneRecords.remove(object) > 0)
+        this->invalidate();
+}
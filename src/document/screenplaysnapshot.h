@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef SCREENPLAYSNAPSHOT_H
+#define SCREENPLAYSNAPSHOT_H
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+#include <QSharedPointer>
+
+#include "scene.h"
+#include "screenplay.h"
+#include "qobjectproperty.h"
+
+struct ScreenplaySnapshotData;
+
+/**
+ * Read-only, flat copy of the scenes in a screenplay, meant for reports and
+ * views that need to look at all scenes at once. Scenes are numbered 0..N-1
+ * in screenplay order, and every per-scene value is stored in an array
+ * indexed by that number.
+ *
+ * Names (characters, locations, location types, moments, scene numbers and
+ * headings) are interned. They are referred to by an integer id, which can
+ * be turned back into a string using string(). Ids are -1 where there is no
+ * value, for instance the location of a scene whose heading is disabled.
+ *
+ * Snapshots are cheap to copy and never change once built. Use
+ * ScriteDocument::screenplaySnapshot() to get one.
+ */
+class ScreenplaySnapshot
+{
+public:
+    ScreenplaySnapshot();
+    ~ScreenplaySnapshot();
+
+    bool isEmpty() const { return this->sceneCount() == 0; }
+
+    // Interned strings
+    QString string(int id) const;
+    int stringId(const QString &string) const;
+
+    // Scenes, in screenplay order
+    int sceneCount() const;
+    int sceneIndexOf(const ScreenplayElement *element) const;
+    int sceneElementIndex(int scene) const;       // index of the ScreenplayElement
+    int sceneNumber(int scene) const;             // id of the resolved scene number
+    int sceneHeading(int scene) const;            // id of the heading text
+    int sceneLocation(int scene) const;
+    int sceneLocationType(int scene) const;
+    int sceneMoment(int scene) const;
+    QString sceneTitle(int scene) const;
+    int sceneWordCount(int scene) const;
+    qreal scenePageCount(int scene) const;        // estimate, see below
+
+    // Ids of character names present in at least one scene, sorted by name.
+    // Character ids are string ids, so stringId() finds a character by name.
+    QVector<int> characters() const;
+    QVector<int> sceneCharacters(int scene) const;
+    QVector<int> characterScenes(int character) const;
+    bool sceneHasCharacter(int scene, int character) const;
+
+    // Paragraphs of all scenes, one after the other
+    int paragraphCount() const;
+    int sceneFirstParagraph(int scene) const;
+    int sceneParagraphCount(int scene) const;
+    SceneElement::Type paragraphType(int paragraph) const;
+    QString paragraphText(int paragraph) const;
+    int paragraphScene(int paragraph) const;
+
+    int wordCount() const;
+    qreal pageCount() const;
+
+    // Page counts are estimated from the number of lines each paragraph
+    // would take up on a standard screenplay page, so they are only as good
+    // as the assumption that the printed format is close to the standard.
+    static qreal estimatePageCount(SceneElement::Type type, const QString &text);
+    static int countWords(const QString &text);
+
+private:
+    friend class ScreenplaySnapshotBuilder;
+    QSharedPointer<const ScreenplaySnapshotData> d;
+};
+
+/**
+ * Keeps a snapshot of a screenplay up to date. Scenes that have not changed
+ * since the last snapshot are not looked at again, only the parts of the
+ * snapshot that depend on scene order and numbering are put together afresh.
+ */
+class ScreenplaySnapshotBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    ScreenplaySnapshotBuilder(QObject *parent=nullptr);
+    ~ScreenplaySnapshotBuilder();
+
+    Q_PROPERTY(Screenplay* screenplay READ screenplay WRITE setScreenplay NOTIFY screenplayChanged RESET resetScreenplay)
+    void setScreenplay(Screenplay* val);
+    Screenplay* screenplay() const { return m_screenplay; }
+    Q_SIGNAL void screenplayChanged();
+
+    ScreenplaySnapshot snapshot();
+
+    // Emitted when the next call to snapshot() would return a new snapshot.
+    Q_SIGNAL void snapshotInvalidated();
+
+private:
+    struct SceneRecord;
+    QSharedPointer<const SceneRecord> sceneRecord(Scene *scene);
+
+    void resetScreenplay();
+    void invalidate();
+    Q_SLOT void onSceneChanged();
+    Q_SLOT void onSceneDestroyed(QObject *object);
+
+private:
+    bool m_valid = false;
+    ScreenplaySnapshot m_snapshot;
+    QObjectProperty<Screenplay> m_screenplay;
+    QHash<const QObject*, QSharedPointer<const SceneRecord> > m_sceneRecords;
+};
+
+#endif // SCREENPLAYSNAPSHOT_H
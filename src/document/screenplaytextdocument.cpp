@@ -454,11 +454,17 @@ void ScreenplayTextDocument::print(QObject *printerObject)
         printer->setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
     }
 
-    QTextDocumentPagedPrinter docPrinter;
-    docPrinter.header()->setVisibleFromPageOne(!m_titlePage);
-    docPrinter.footer()->setVisibleFromPageOne(!m_titlePage);
-    docPrinter.watermark()->setVisibleFromPageOne(!m_titlePage);
-    docPrinter.print(m_textDocument, printer);
+    QScopedPointer<QTextDocumentPagedPrinter> docPrinter(new QTextDocumentPagedPrinter);
+    docPrinter->header()->setVisibleFromPageOne(!m_titlePage);
+    docPrinter->footer()->setVisibleFromPageOne(!m_titlePage);
+    docPrinter->watermark()->setVisibleFromPageOne(!m_titlePage);
+
+    // Image printers paint pages from our paginated document by themselves,
+    // either as and when they are shown or all at once on many threads.
+    if(imagePrinter)
+        imagePrinter->paginate(m_textDocument, docPrinter.take());
+    else
+        docPrinter->print(m_textDocument, printer);
 }
 
 QList< QPair<int,int> > ScreenplayTextDocument::pageBreaksFor(ScreenplayElement *element) const
@@ -563,6 +569,11 @@ void ScreenplayTextDocument::syncNow()
     this->loadScreenplay();
 }
 
+PaginationCache::Key ScreenplayTextDocument::paginationKey() const
+{
+    return PaginationCache::key(m_screenplay, m_formatting, this->paginationOptions());
+}
+
 void ScreenplayTextDocument::classBegin()
 {
     m_updating = true;
@@ -821,6 +832,8 @@ void ScreenplayTextDocument::loadScreenplay()
 
     this->includeMoreAndContdMarkers();
     this->evaluatePageBoundariesLater();
+
+    PaginationCache::instance()->publish(this->paginationKey(), m_textDocument);
 }
 
 void ScreenplayTextDocument::includeMoreAndContdMarkers()
@@ -1957,6 +1970,30 @@ void ScreenplayTextDocument::resetInjection()
     emit injectionChanged();
 }
 
+QString ScreenplayTextDocument::paginationOptions() const
+{
+    AbstractScreenplayTextDocumentInjectionInterface *injection = qobject_cast<AbstractScreenplayTextDocumentInjectionInterface*>(m_injection);
+    if(injection != nullptr && !injection->isFilterOnly())
+        return QString();
+
+    // Everything that goes into loadScreenplay(), other than the screenplay
+    // and its format, which are part of the key by themselves.
+    const QList<bool> flags = QList<bool>() << m_titlePage << m_titlePageIsCentered
+                                            << m_sceneNumbers << m_sceneIcons
+                                            << m_listSceneCharacters << m_includeSceneSynopsis
+                                            << m_printEachSceneOnANewPage
+                                            << (injection != nullptr && injection->filterSceneElement());
+
+    QString ret = QString::number(m_purpose) + QStringLiteral(":");
+    for(bool flag : flags)
+        ret += flag ? QChar('1') : QChar('0');
+
+    if(!m_highlightDialoguesOf.isEmpty())
+        ret += QStringLiteral(":") + m_highlightDialoguesOf.join(QStringLiteral(","));
+
+    return ret;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 ScreenplayElementPageBreaks::ScreenplayElementPageBreaks(QObject *parent)
@@ -2072,6 +2109,60 @@ QSizeF ScreenplayTitlePageObjectInterface::intrinsicSize(QTextDocument *doc, int
     return ret;
 }
 
+QVariantMap ScreenplayTitlePageObjectInterface::snapshotProperties(const QTextDocument *document) const
+{
+    QVariantMap ret;
+
+    const QVector<QTextFormat> formats = document->allFormats();
+    for(const QTextFormat &format : formats)
+    {
+        if(format.objectType() != Kind)
+            continue;
+
+        const Screenplay *screenplay = qobject_cast<Screenplay*>(format.property(ScreenplayProperty).value<QObject*>());
+        if(screenplay != nullptr)
+        {
+            ret.insert(QStringLiteral("#titlePage"), ScreenplayTitlePageObjectInterface::fields(screenplay));
+            break;
+        }
+    }
+
+    return ret;
+}
+
+QVariantMap ScreenplayTitlePageObjectInterface::fields(const Screenplay *screenplay)
+{
+    const Screenplay *coverPageImageScreenplay = screenplay;
+    if(screenplay->property("#useDocumentScreenplayForCoverPagePhoto").toBool() == true)
+        coverPageImageScreenplay = ScriteDocument::instance()->screenplay();
+
+    auto fetch = [](const QString &given, const QString &defaultValue) {
+        const QString val = given.trimmed();
+        return val.isEmpty() ? defaultValue : val;
+    };
+
+    QVariantMap ret;
+    const QString authors = fetch(screenplay->author(), QStringLiteral("A Good Writer"));
+    ret.insert(QStringLiteral("title"), fetch(screenplay->title(), QStringLiteral("Untitled Screenplay")));
+    ret.insert(QStringLiteral("subtitle"), screenplay->subtitle());
+    ret.insert(QStringLiteral("basedOn"), screenplay->basedOn());
+    ret.insert(QStringLiteral("version"), fetch(screenplay->version(), QStringLiteral("Initial Draft")));
+    ret.insert(QStringLiteral("author"), authors);
+    ret.insert(QStringLiteral("contact"), fetch(screenplay->contact(), authors));
+    ret.insert(QStringLiteral("address"), screenplay->address());
+    ret.insert(QStringLiteral("phoneNumber"), screenplay->phoneNumber());
+    ret.insert(QStringLiteral("email"), screenplay->email());
+    ret.insert(QStringLiteral("website"), screenplay->website());
+
+    // The photo itself, not its path. The file lives in the document's
+    // folder, which is cleared when the document is closed.
+    if(!coverPageImageScreenplay->coverPagePhoto().isEmpty())
+        ret.insert(QStringLiteral("coverPagePhoto"), QImage(coverPageImageScreenplay->coverPagePhoto()));
+    ret.insert(QStringLiteral("coverPagePhotoSize"), int(coverPageImageScreenplay->coverPagePhotoSize()));
+
+    return ret;
+}
+
 void ScreenplayTitlePageObjectInterface::drawObject(QPainter *painter, const QRectF &givenRect, QTextDocument *doc, int posInDocument, const QTextFormat &format)
 {
     Q_UNUSED(posInDocument)
@@ -2107,31 +2198,29 @@ void ScreenplayTitlePageObjectInterface::drawObject(QPainter *painter, const QRe
     };
     const QRectF rect = format.property(TitlePageIsCentered).toBool() ? evaluateCenteredPaintRect() : givenRect;
 
-    const Screenplay *screenplay = qobject_cast<Screenplay*>(format.property(ScreenplayProperty).value<QObject*>());
-    if(screenplay == nullptr)
-        return;
-
-    const Screenplay *masterScreenplay = ScriteDocument::instance()->screenplay();
-    const Screenplay *coverPageImageScreenplay = screenplay;
-    if(screenplay->property("#useDocumentScreenplayForCoverPagePhoto").toBool() == true)
-        coverPageImageScreenplay = masterScreenplay;
+    // Copies of the document printed on another thread carry the fields
+    // with them, the screenplay may change or go away while they are printed.
+    QVariantMap fields = doc->property("#titlePage").toMap();
+    if(fields.isEmpty())
+    {
+        const Screenplay *screenplay = qobject_cast<Screenplay*>(format.property(ScreenplayProperty).value<QObject*>());
+        if(screenplay == nullptr)
+            return;
 
-    auto fetch = [](const QString &given, const QString &defaultValue) {
-        const QString val = given.trimmed();
-        return val.isEmpty() ? defaultValue : val;
-    };
+        fields = ScreenplayTitlePageObjectInterface::fields(screenplay);
+    }
 
-    const QString title = fetch(screenplay->title(), QStringLiteral("Untitled Screenplay"));
-    const QString subtitle = screenplay->subtitle();
+    const QString title = fields.value(QStringLiteral("title")).toString();
+    const QString subtitle = fields.value(QStringLiteral("subtitle")).toString();
     const QString writtenBy = QStringLiteral("Written By");
-    const QString basedOn = screenplay->basedOn();
-    const QString version = fetch(screenplay->version(), QStringLiteral("Initial Draft"));
-    const QString authors = fetch(screenplay->author(), QStringLiteral("A Good Writer"));
-    const QString contact = fetch(screenplay->contact(), authors);
-    const QString address = screenplay->address();
-    const QString phoneNumber = screenplay->phoneNumber();
-    const QString email = screenplay->email();
-    const QString website = screenplay->website();
+    const QString basedOn = fields.value(QStringLiteral("basedOn")).toString();
+    const QString version = fields.value(QStringLiteral("version")).toString();
+    const QString authors = fields.value(QStringLiteral("author")).toString();
+    const QString contact = fields.value(QStringLiteral("contact")).toString();
+    const QString address = fields.value(QStringLiteral("address")).toString();
+    const QString phoneNumber = fields.value(QStringLiteral("phoneNumber")).toString();
+    const QString email = fields.value(QStringLiteral("email")).toString();
+    const QString website = fields.value(QStringLiteral("website")).toString();
     const QString marketing = QStringLiteral("Written/Generated using Scrite (www.scrite.io)");
 
     const QFont normalFont = doc->defaultFont();
@@ -2199,9 +2288,9 @@ void ScreenplayTitlePageObjectInterface::drawObject(QPainter *painter, const QRe
 
     painter->save();
 
-    if(!coverPageImageScreenplay->coverPagePhoto().isEmpty())
+    QImage photo = fields.value(QStringLiteral("coverPagePhoto")).value<QImage>();
+    if(!photo.isNull())
     {
-        QImage photo(coverPageImageScreenplay->coverPagePhoto());
         QRectF photoRect = photo.rect();
         QSizeF photoSize = photoRect.size();
 
@@ -2209,7 +2298,7 @@ void ScreenplayTitlePageObjectInterface::drawObject(QPainter *painter, const QRe
         spaceAvailable.setBottom(titleFrameRect.top() - titleFrameRect.height());
         photoSize.scale(spaceAvailable.size(), Qt::KeepAspectRatio);
 
-        switch(coverPageImageScreenplay->coverPagePhotoSize())
+        switch(fields.value(QStringLiteral("coverPagePhotoSize")).toInt())
         {
         case Screenplay::LargeCoverPhoto:
             break;
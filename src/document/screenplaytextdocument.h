@@ -27,6 +27,7 @@
 #include "formatting.h"
 #include "screenplay.h"
 #include "qobjectproperty.h"
+#include "paginationcache.h"
 
 class ScreenplayTextDocument;
 class AbstractScreenplayTextDocumentInjectionInterface
@@ -43,6 +44,11 @@ public:
     virtual void inject(QTextCursor &, InjectLocation) { }
     virtual bool filterSceneElement() const { return false; }
 
+    // Documents loaded with an injection are shared through PaginationCache
+    // only if the injection never adds anything to them, and filters the
+    // same way for every scene element.
+    virtual bool isFilterOnly() const { return false; }
+
     const ScreenplayElement *screenplayElement() const { return m_screenplayElement; }
     const SceneElement *sceneElement() const { return m_sceneElement; }
 
@@ -202,6 +208,10 @@ public:
 
     void syncNow();
 
+    // Key under which the document is published to PaginationCache, each time
+    // it is loaded afresh.
+    PaginationCache::Key paginationKey() const;
+
 signals:
     void updateScheduled();
     void updateStarted();
@@ -286,6 +296,7 @@ private:
     void processSceneResetList();
 
     void resetInjection();
+    QString paginationOptions() const;
 
 private:
     int m_pageCount = 0;
@@ -368,7 +379,7 @@ class ScreenplayTitlePageObjectInterface : public QObject, public QTextObjectInt
     Q_INTERFACES(QTextObjectInterface)
 
 public:
-    ScreenplayTitlePageObjectInterface(QObject *parent=nullptr);
+    Q_INVOKABLE ScreenplayTitlePageObjectInterface(QObject *parent=nullptr);
     ~ScreenplayTitlePageObjectInterface();
 
     enum { Kind=QTextFormat::UserObject+2 };
@@ -380,6 +391,12 @@ public:
 
     QSizeF intrinsicSize(QTextDocument *doc, int posInDocument, const QTextFormat &format);
     void drawObject(QPainter *painter, const QRectF &rect, QTextDocument *doc, int posInDocument, const QTextFormat &format);
+
+    // See QTextDocumentSnapshot
+    Q_INVOKABLE QVariantMap snapshotProperties(const QTextDocument *document) const;
+
+private:
+    static QVariantMap fields(const Screenplay *screenplay);
 };
 
 class ScreenplayTextObjectInterface : public QObject, public QTextObjectInterface
@@ -388,7 +405,7 @@ class ScreenplayTextObjectInterface : public QObject, public QTextObjectInterfac
     Q_INTERFACES(QTextObjectInterface)
 
 public:
-    ScreenplayTextObjectInterface(QObject *parent=nullptr);
+    Q_INVOKABLE ScreenplayTextObjectInterface(QObject *parent=nullptr);
     ~ScreenplayTextObjectInterface();
 
     enum { Kind=QTextFormat::UserObject+1 };
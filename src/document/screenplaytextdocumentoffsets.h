@@ -15,6 +15,7 @@
 #define SCREENPLAYTEXTDOCUMENTOFFSETS_H
 
 #include <QTime>
+#include <QTimer>
 #include <QTextDocument>
 #include <QAbstractListModel>
 
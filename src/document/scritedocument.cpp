@@ -914,6 +914,7 @@ void ScriteDocument::setScreenplay(Screenplay *val)
     m_screenplay = val;
     m_screenplay->setParent(this);
     m_screenplay->setObjectName("Document Screenplay");
+    m_snapshotBuilder->setScreenplay(m_screenplay);
 
     emit screenplayChanged();
 }
@@ -1022,6 +1023,7 @@ bool ScriteDocument::load(const QString &fileName)
 
         ~LoadCleanup() {
             if(m_loadBegun) {
+                Application::instance()->endBulkLoad();
                 m_document->m_progressReport->finish();
                 m_document->setLoading(false);
             } else
@@ -1032,6 +1034,7 @@ bool ScriteDocument::load(const QString &fileName)
             m_loadBegun = true;
             m_document->m_progressReport->start();
             m_document->setLoading(true);
+            Application::instance()->beginBulkLoad();
         }
 
     private:
@@ -24,6 +24,7 @@
 #include "progressreport.h"
 #include "qobjectproperty.h"
 #include "qobjectserializer.h"
+#include "screenplaysnapshot.h"
 #include "documentfilesystem.h"
 
 class AbstractExporter;
@@ -199,6 +200,10 @@ public:
 
     // Callers must be responsible for how they use this.
     DocumentFileSystem *fileSystem() { return &m_docFileSystem; }
+
+    // Flat copy of the screenplay for reports and views that go over all of
+    // its scenes. It is put together again only after the screenplay changes.
+    ScreenplaySnapshot screenplaySnapshot() const { return m_snapshotBuilder->snapshot(); }
     Q_INVOKABLE void blockUI() { this->setLoading(true); }
     Q_INVOKABLE void unblockUI() { this->setLoading(false); }
 
@@ -267,6 +272,7 @@ private:
 
     ErrorReport *m_errorReport = new ErrorReport(this);
     ProgressReport *m_progressReport = new ProgressReport(this);
+    ScreenplaySnapshotBuilder *m_snapshotBuilder = new ScreenplaySnapshotBuilder(this);
 };
 
 #endif // SCRITEDOCUMENT_H
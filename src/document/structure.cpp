@@ -1388,9 +1388,10 @@ void Annotation::polishAttributes()
 
 Structure::Structure(QObject *parent)
     : QObject(parent),
-      m_scriteDocument(qobject_cast<ScriteDocument*>(parent)),
-      m_locationHeadingsMapTimer("Structure.m_locationHeadingsMapTimer")
+      m_scriteDocument(qobject_cast<ScriteDocument*>(parent))
 {
+    m_characterElementMap.setCompletionTrie(&m_characterNameTrie);
+
     connect(this, &Structure::noteCountChanged, this, &Structure::structureChanged);
     connect(this, &Structure::zoomLevelChanged, this, &Structure::structureChanged);
     connect(this, &Structure::elementCountChanged, this, &Structure::structureChanged);
@@ -1759,11 +1760,12 @@ void Structure::removeElement(StructureElement *ptr)
     }
 
     m_elements.removeAt(index);
+    this->unindexElement(ptr);
 
     disconnect(ptr, &StructureElement::elementChanged, this, &Structure::structureChanged);
     disconnect(ptr, &StructureElement::aboutToDelete, this, &Structure::removeElement);
-    disconnect(ptr, &StructureElement::sceneLocationChanged, this, &Structure::updateLocationHeadingMapLater);
-    this->updateLocationHeadingMapLater();
+    disconnect(ptr, &StructureElement::sceneHeadingChanged, this, &Structure::onStructureElementHeadingChanged);
+    this->removeLocationHeading(ptr);
 
     emit elementCountChanged();
     emit elementsChanged();
@@ -1792,14 +1794,14 @@ void Structure::insertElement(StructureElement *ptr, int index)
     else
         m_elements.insert(index, ptr);
 
+    this->indexElement(ptr);
     ptr->setParent(this);
 
     connect(ptr, &StructureElement::elementChanged, this, &Structure::structureChanged);
     connect(ptr, &StructureElement::aboutToDelete, this, &Structure::removeElement);
-    connect(ptr, &StructureElement::sceneLocationChanged, this, &Structure::updateLocationHeadingMapLater);
+    connect(ptr, &StructureElement::sceneHeadingChanged, this, &Structure::onStructureElementHeadingChanged);
     connect(ptr, &StructureElement::geometryChanged, &m_elements, &ObjectListPropertyModel<StructureElement*>::objectChanged);
     connect(ptr, &StructureElement::aboutToDelete, &m_elements, &ObjectListPropertyModel<StructureElement*>::objectDestroyed);
-    this->updateLocationHeadingMapLater();
 
     this->onStructureElementSceneChanged(ptr);
 
@@ -1843,13 +1845,18 @@ void Structure::setElements(const QList<StructureElement *> &list)
 
         connect(element, &StructureElement::elementChanged, this, &Structure::structureChanged);
         connect(element, &StructureElement::aboutToDelete, this, &Structure::removeElement);
-        connect(element, &StructureElement::sceneLocationChanged, this, &Structure::updateLocationHeadingMapLater);
+        connect(element, &StructureElement::sceneHeadingChanged, this, &Structure::onStructureElementHeadingChanged);
         connect(element, &StructureElement::geometryChanged, &m_elements, &ObjectListPropertyModel<StructureElement*>::objectChanged);
         connect(element, &StructureElement::aboutToDelete, &m_elements, &ObjectListPropertyModel<StructureElement*>::objectDestroyed);
-        this->onStructureElementSceneChanged(element);
+        this->indexElement(element);
     }
 
     m_elements.assign(list);
+
+    // Location headings are filed in structure order, so this can happen
+    // only after the element list has been assigned.
+    for(StructureElement *element : list)
+        this->onStructureElementSceneChanged(element);
     this->setCurrentElementIndex(0);
     emit elementCountChanged();
     emit elementsChanged();
@@ -1871,11 +1878,22 @@ int Structure::indexOfScene(Scene *scene) const
     if(scene == nullptr)
         return -1;
 
+    StructureElement *element = m_sceneElementMap.value(scene);
+    if(element != nullptr && element->scene() == scene)
+    {
+        const int index = m_elements.indexOf(element);
+        if(index >= 0)
+            return index;
+    }
+
     for(int i=0; i<m_elements.size(); i++)
     {
-        StructureElement *element = m_elements.at(i);
+        element = m_elements.at(i);
         if(element->scene() == scene)
+        {
+            m_sceneElementMap.insert(scene, element);
             return i;
+        }
     }
 
     return -1;
@@ -1888,15 +1906,46 @@ int Structure::indexOfElement(StructureElement *element) const
 
 StructureElement *Structure::findElementBySceneID(const QString &id) const
 {
-    Q_FOREACH(StructureElement *element, m_elements.list())
+    StructureElement *element = m_sceneIdElementMap.value(id);
+    if(element != nullptr && element->scene() != nullptr && element->scene()->id() == id)
+        return element;
+
+    for(StructureElement *e : m_elements.list())
     {
-        if(element->scene()->id() == id)
-            return element;
+        if(e->scene() != nullptr && e->scene()->id() == id)
+        {
+            m_sceneIdElementMap.insert(id, e);
+            return e;
+        }
     }
 
     return nullptr;
 }
 
+void Structure::indexElement(StructureElement *element)
+{
+    Scene *scene = element->scene();
+    if(scene == nullptr)
+        return;
+
+    m_sceneElementMap.insert(scene, element);
+    m_sceneIdElementMap.insert(scene->id(), element);
+}
+
+void Structure::unindexElement(StructureElement *element)
+{
+    Scene *scene = element->scene();
+    if(scene == nullptr)
+        return;
+
+    if(m_sceneElementMap.value(scene) == element)
+        m_sceneElementMap.remove(scene);
+
+    const QString id = scene->id();
+    if(m_sceneIdElementMap.value(id) == element)
+        m_sceneIdElementMap.remove(id);
+}
+
 QRectF Structure::layoutElements(Structure::LayoutType layoutType)
 {
     QRectF newBoundingRect;
@@ -2633,18 +2682,6 @@ bool Structure::event(QEvent *event)
     return QObject::event(event);
 }
 
-void Structure::timerEvent(QTimerEvent *event)
-{
-    if(m_locationHeadingsMapTimer.timerId() == event->timerId())
-    {
-        m_locationHeadingsMapTimer.stop();
-        this->updateLocationHeadingMap();
-        return;
-    }
-
-    QObject::timerEvent(event);
-}
-
 void Structure::resetCurentElementIndex()
 {
     int val = m_currentElementIndex;
@@ -2757,28 +2794,119 @@ int Structure::staticElementCount(QQmlListProperty<StructureElement> *list)
     return reinterpret_cast< Structure* >(list->data)->elementCount();
 }
 
-void Structure::updateLocationHeadingMap()
+QStringList Structure::allLocations() const
 {
-    QMap< QString, QList<SceneHeading*> > map;
-    Q_FOREACH(StructureElement *element, m_elements.list())
+    if(!m_allLocationsValid)
     {
-        Scene *scene = element->scene();
-        if(scene == nullptr || !scene->heading()->isEnabled())
-            continue;
+        m_allLocations = m_locationHeadingsMap.keys();
+        m_allLocationsValid = true;
+    }
 
-        const QString location = scene->heading()->location();
-        if(location.isEmpty())
-            continue;
+    return m_allLocations;
+}
 
-        map[location].append(scene->heading());
+void Structure::updateLocationHeading(StructureElement *element)
+{
+    Scene *scene = element ? element->scene() : nullptr;
+    if(scene == nullptr)
+        return;
+
+    SceneHeading *heading = scene->heading();
+    const QString newLocation = heading->isEnabled() ? heading->location() : QString();
+
+    QHash<SceneHeading*,QString>::iterator hit = m_headingLocationMap.find(heading);
+    const bool filed = hit != m_headingLocationMap.end();
+    if(filed && hit.value() == newLocation)
+        return;
+
+    if(!filed && newLocation.isEmpty())
+        return;
+
+    bool keysChanged = false;
+
+    if(filed)
+    {
+        QMap< QString, QList<SceneHeading*> >::iterator it = m_locationHeadingsMap.find(hit.value());
+        if(it != m_locationHeadingsMap.end())
+        {
+            it.value().removeOne(heading);
+            if(it.value().isEmpty())
+            {
+                m_locationHeadingsMap.erase(it);
+                keysChanged = true;
+            }
+        }
+
+        m_locationTrie.remove(hit.value());
+        m_headingLocationMap.erase(hit);
+    }
+
+    if(!newLocation.isEmpty())
+    {
+        QMap< QString, QList<SceneHeading*> >::iterator it = m_locationHeadingsMap.find(newLocation);
+        if(it == m_locationHeadingsMap.end())
+        {
+            it = m_locationHeadingsMap.insert(newLocation, QList<SceneHeading*>());
+            keysChanged = true;
+        }
+
+        // Keep headings within a location in structure order. Elements are mostly
+        // added at the end, so we look for the insert position from the back.
+        QList<SceneHeading*> &headings = it.value();
+        const int elementIndex = m_elements.indexOf(element);
+        int pos = headings.size();
+        while(pos > 0 && this->indexOfScene(headings.at(pos-1)->scene()) > elementIndex)
+            --pos;
+        headings.insert(pos, heading);
+
+        m_headingLocationMap.insert(heading, newLocation);
+        m_locationTrie.add(newLocation);
+    }
+
+    if(keysChanged)
+    {
+        m_allLocations.clear();
+        m_allLocationsValid = false;
+    }
+
+    ++m_locationHeadingsMapVersion;
+    emit locationHeadingsMapChanged();
+}
+
+void Structure::removeLocationHeading(StructureElement *element)
+{
+    Scene *scene = element ? element->scene() : nullptr;
+    if(scene == nullptr)
+        return;
+
+    SceneHeading *heading = scene->heading();
+    const QString location = m_headingLocationMap.take(heading);
+    if(location.isEmpty())
+        return;
+
+    m_locationTrie.remove(location);
+
+    QMap< QString, QList<SceneHeading*> >::iterator it = m_locationHeadingsMap.find(location);
+    if(it != m_locationHeadingsMap.end())
+    {
+        it.value().removeOne(heading);
+        if(it.value().isEmpty())
+        {
+            m_locationHeadingsMap.erase(it);
+            m_allLocations.clear();
+            m_allLocationsValid = false;
+        }
     }
 
-    m_locationHeadingsMap = map;
+    ++m_locationHeadingsMapVersion;
+    emit locationHeadingsMapChanged();
 }
 
-void Structure::updateLocationHeadingMapLater()
+void Structure::onStructureElementHeadingChanged()
 {
-    m_locationHeadingsMapTimer.start(0, this);
+    StructureElement *element = qobject_cast<StructureElement*>(this->sender());
+    if(element != nullptr && m_elements.indexOf(element) >= 0)
+        this->updateLocationHeading(element);
 }
 
 void Structure::onStructureElementSceneChanged(StructureElement *element)
@@ -2791,9 +2919,13 @@ void Structure::onStructureElementSceneChanged(StructureElement *element)
 
     connect(element->scene(), &Scene::sceneElementChanged, this, &Structure::onSceneElementChanged);
     connect(element->scene(), &Scene::aboutToRemoveSceneElement, this, &Structure::onAboutToRemoveSceneElement);
+
+    const int characterNamesVersion = m_characterElementMap.version();
     m_characterElementMap.include(element->scene()->characterElementMap());
+    if(m_characterElementMap.version() != characterNamesVersion)
+        emit characterNamesChanged();
 
-    this->updateLocationHeadingMapLater();
+    this->updateLocationHeading(element);
 }
 
 void Structure::onSceneElementChanged(SceneElement *element, Scene::SceneElementChangeType)
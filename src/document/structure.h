@@ -586,9 +586,18 @@ public:
     Q_INVOKABLE QStringList standardLocationTypes() const;
     Q_INVOKABLE QStringList standardMoments() const;
 
-    Q_INVOKABLE QStringList allLocations() const { return m_locationHeadingsMap.keys(); }
+    // Both of these return implicitly shared snapshots, which stay valid (and
+    // cheap to copy) until locationHeadingsMapVersion changes.
+    Q_INVOKABLE QStringList allLocations() const;
     QMap< QString, QList<SceneHeading*> > locationHeadingsMap() const { return m_locationHeadingsMap; }
 
+    Q_PROPERTY(int locationHeadingsMapVersion READ locationHeadingsMapVersion NOTIFY locationHeadingsMapChanged)
+    int locationHeadingsMapVersion() const { return m_locationHeadingsMapVersion; }
+    Q_SIGNAL void locationHeadingsMapChanged();
+
+    // Locations weighed by the number of scene headings that use them
+    const CompletionTrie &locationTrie() const { return m_locationTrie; }
+
     Q_PROPERTY(int currentElementIndex READ currentElementIndex WRITE setCurrentElementIndex NOTIFY currentElementIndexChanged STORED false)
     void setCurrentElementIndex(int val);
     int currentElementIndex() const { return m_currentElementIndex; }
@@ -603,6 +612,12 @@ public:
     QStringList characterNames() const { return m_characterElementMap.characterNames(); }
     Q_SIGNAL void characterNamesChanged();
 
+    Q_PROPERTY(int characterNamesVersion READ characterNamesVersion NOTIFY characterNamesChanged)
+    int characterNamesVersion() const { return m_characterElementMap.version(); }
+
+    // Character names weighed by the number of dialogues they have
+    const CompletionTrie &characterNameTrie() const { return m_characterNameTrie; }
+
     Q_PROPERTY(QAbstractListModel* annotationsModel READ annotationsModel CONSTANT STORED false)
     QAbstractListModel *annotationsModel() const { return &((const_cast<Structure*>(this))->m_annotations); }
 
@@ -647,7 +662,6 @@ public:
 
 protected:
     bool event(QEvent *event);
-    void timerEvent(QTimerEvent *event);
     void resetCurentElementIndex();
     void setCanPaste(bool val);
     void onClipboardDataChanged();
@@ -685,17 +699,34 @@ private:
     ObjectListPropertyModel<StructureElement *> m_elements;
     ModelAggregator m_elementsBoundingBoxAggregator;
     int m_currentElementIndex = -1;
+
+    // Reverse indexes for looking up elements by scene, kept in sync as elements
+    // are inserted and removed. Lookups verify hits and fall back to a scan (which
+    // repairs the index) for elements whose scene was assigned after insertion.
+    void indexElement(StructureElement *element);
+    void unindexElement(StructureElement *element);
+    mutable QHash<Scene*,StructureElement*> m_sceneElementMap;
+    mutable QHash<QString,StructureElement*> m_sceneIdElementMap;
     qreal m_zoomLevel = 1.0;
 
-    void updateLocationHeadingMap();
-    void updateLocationHeadingMapLater();
-    ExecLaterTimer m_locationHeadingsMapTimer;
+    // Scene headings are filed under their location as deltas, whenever an
+    // element is added / removed or its heading changes. m_headingLocationMap
+    // remembers the bucket each heading was last filed under.
+    void updateLocationHeading(StructureElement *element);
+    void removeLocationHeading(StructureElement *element);
+    void onStructureElementHeadingChanged();
     QMap< QString, QList<SceneHeading*> > m_locationHeadingsMap;
+    QHash<SceneHeading*,QString> m_headingLocationMap;
+    mutable QStringList m_allLocations;
+    mutable bool m_allLocationsValid = false;
+    int m_locationHeadingsMapVersion = 0;
+    CompletionTrie m_locationTrie;
 
     void onStructureElementSceneChanged(StructureElement *element=nullptr);
     void onSceneElementChanged(SceneElement *element, Scene::SceneElementChangeType type);
     void onAboutToRemoveSceneElement(SceneElement *element);
     CharacterElementMap m_characterElementMap;
+    CompletionTrie m_characterNameTrie;
 
     static void staticAppendAnnotation(QQmlListProperty<Annotation> *list, Annotation *ptr);
     static void staticClearAnnotations(QQmlListProperty<Annotation> *list);
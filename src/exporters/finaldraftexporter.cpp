@@ -13,10 +13,8 @@
 
 #include "finaldraftexporter.h"
 
-#include <QDomDocument>
-#include <QDomElement>
-#include <QDomAttr>
 #include <QFileInfo>
+#include <QXmlStreamWriter>
 
 FinalDraftExporter::FinalDraftExporter(QObject *parent)
                    :AbstractExporter(parent)
@@ -54,42 +52,44 @@ bool FinalDraftExporter::doExport(QIODevice *device)
 
     this->progress()->setProgressStep( 1.0/qreal(nrElements+1) );
 
-    QDomDocument doc;
+    // Paragraphs are written out as the screenplay is walked, so nothing
+    // more than the list of moments and location types is held in memory.
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(4);
+    xml.writeStartDocument(QStringLiteral("1.0"), false);
 
-    QDomElement rootE = doc.createElement(QStringLiteral("FinalDraft"));
-    rootE.setAttribute(QStringLiteral("DocumentType"), QStringLiteral("Script"));
-    rootE.setAttribute(QStringLiteral("Template"), QStringLiteral("No"));
-    rootE.setAttribute(QStringLiteral("Version"), QStringLiteral("2"));
-    doc.appendChild(rootE);
+    xml.writeStartElement(QStringLiteral("FinalDraft"));
+    xml.writeAttribute(QStringLiteral("DocumentType"), QStringLiteral("Script"));
+    xml.writeAttribute(QStringLiteral("Template"), QStringLiteral("No"));
+    xml.writeAttribute(QStringLiteral("Version"), QStringLiteral("2"));
 
-    QDomElement contentE = doc.createElement(QStringLiteral("Content"));
-    rootE.appendChild(contentE);
+    xml.writeStartElement(QStringLiteral("Content"));
 
-    auto addTextToParagraph = [&doc,this](QDomElement &element, const QString &text) {
+    auto writeParagraphText = [&xml,this](const QString &text) {
         if(m_markLanguagesExplicitly) {
             QList<TransliterationEngine::Boundary> breakup = TransliterationEngine::instance()->evaluateBoundaries(text);
             Q_FOREACH(TransliterationEngine::Boundary item, breakup) {
-                QDomElement textE = doc.createElement(QStringLiteral("Text"));
-                element.appendChild(textE);
+                xml.writeStartElement(QStringLiteral("Text"));
                 if(item.language == TransliterationEngine::English) {
-                    textE.setAttribute(QStringLiteral("Font"), QStringLiteral("Courier Final Draft"));
-                    textE.setAttribute(QStringLiteral("Language"), QStringLiteral("English"));
+                    xml.writeAttribute(QStringLiteral("Font"), QStringLiteral("Courier Final Draft"));
+                    xml.writeAttribute(QStringLiteral("Language"), QStringLiteral("English"));
                 } else {
                     const QFont font = TransliterationEngine::instance()->languageFont(item.language, false);
-                    textE.setAttribute(QStringLiteral("Font"), font.family());
-                    textE.setAttribute(QStringLiteral("Language"), TransliterationEngine::instance()->languageAsString(item.language));
+                    xml.writeAttribute(QStringLiteral("Font"), font.family());
+                    xml.writeAttribute(QStringLiteral("Language"), TransliterationEngine::instance()->languageAsString(item.language));
                 }
-                textE.appendChild(doc.createTextNode(item.string));
+                xml.writeCharacters(item.string);
+                xml.writeEndElement();
             }
         } else {
-            QDomElement textE = doc.createElement(QStringLiteral("Text"));
-            element.appendChild(textE);
-            textE.setAttribute(QStringLiteral("Font"), QStringLiteral("Courier Final Draft"));
-            textE.appendChild(doc.createTextNode(text));
+            xml.writeStartElement(QStringLiteral("Text"));
+            xml.writeAttribute(QStringLiteral("Font"), QStringLiteral("Courier Final Draft"));
+            xml.writeCharacters(text);
+            xml.writeEndElement();
         }
     };
 
-    QStringList locations;
     for(int i=0; i<nrElements; i++)
     {
         const ScreenplayElement *element = screenplay->elementAt(i);
@@ -101,15 +101,13 @@ bool FinalDraftExporter::doExport(QIODevice *device)
 
         if(heading->isEnabled())
         {
-            QDomElement paragraphE = doc.createElement(QStringLiteral("Paragraph"));
-            contentE.appendChild(paragraphE);
-
-            paragraphE.setAttribute(QStringLiteral("Type"), QStringLiteral("Scene Heading"));
+            xml.writeStartElement(QStringLiteral("Paragraph"));
+            xml.writeAttribute(QStringLiteral("Type"), QStringLiteral("Scene Heading"));
             if(element->hasUserSceneNumber())
-                paragraphE.setAttribute(QStringLiteral("Number"), element->userSceneNumber());
+                xml.writeAttribute(QStringLiteral("Number"), element->userSceneNumber());
 
-            addTextToParagraph(paragraphE, heading->text());
-            locations.append(heading->location());
+            writeParagraphText(heading->text());
+            xml.writeEndElement();
 
             if(!locationTypes.contains(heading->locationType()))
                 locationTypes.append(heading->locationType());
@@ -122,67 +120,52 @@ bool FinalDraftExporter::doExport(QIODevice *device)
         for(int j=0; j<nrSceneElements; j++)
         {
             const SceneElement *sceneElement = scene->elementAt(j);
-            QDomElement paragraphE = doc.createElement(QStringLiteral("Paragraph"));
-            contentE.appendChild(paragraphE);
-
-            paragraphE.setAttribute(QStringLiteral("Type"), sceneElement->typeAsString());
-            addTextToParagraph(paragraphE, sceneElement->formattedText());
+            xml.writeStartElement(QStringLiteral("Paragraph"));
+            xml.writeAttribute(QStringLiteral("Type"), sceneElement->typeAsString());
+            writeParagraphText(sceneElement->formattedText());
+            xml.writeEndElement();
         }
 
         this->progress()->tick();
     }
 
-    QDomElement watermarkingE = doc.createElement(QStringLiteral("Watermarking"));
-    rootE.appendChild(watermarkingE);
-    watermarkingE.setAttribute(QStringLiteral("Text"), qApp->applicationName());
+    xml.writeEndElement(); // Content
 
-    QDomElement smartTypeE = doc.createElement("SmartType");
-    rootE.appendChild(smartTypeE);
+    xml.writeStartElement(QStringLiteral("Watermarking"));
+    xml.writeAttribute(QStringLiteral("Text"), qApp->applicationName());
+    xml.writeEndElement();
+
+    xml.writeStartElement(QStringLiteral("SmartType"));
 
     const QStringList characters = structure->allCharacterNames();
-    QDomElement charactersE = doc.createElement(QStringLiteral("Characters"));
-    smartTypeE.appendChild(charactersE);
+    xml.writeStartElement(QStringLiteral("Characters"));
     Q_FOREACH(QString name, characters)
-    {
-        QDomElement characterE = doc.createElement(QStringLiteral("Character"));
-        charactersE.appendChild(characterE);
-        characterE.appendChild(doc.createTextNode(name));
-    }
-
-    locations.removeDuplicates();
-    std::sort(locations.begin(), locations.end());
+        xml.writeTextElement(QStringLiteral("Character"), name);
+    xml.writeEndElement();
 
-    QDomElement timesOfDayE = doc.createElement(QStringLiteral("TimesOfDay"));
-    smartTypeE.appendChild(timesOfDayE);
-    timesOfDayE.setAttribute(QStringLiteral("Separator"), QStringLiteral(" - "));
+    xml.writeStartElement(QStringLiteral("TimesOfDay"));
+    xml.writeAttribute(QStringLiteral("Separator"), QStringLiteral(" - "));
     std::sort(moments.begin(), moments.end());
     Q_FOREACH(QString moment, moments)
-    {
-        QDomElement timeOfDayE = doc.createElement(QStringLiteral("TimeOfDay"));
-        timesOfDayE.appendChild(timeOfDayE);
-        timeOfDayE.appendChild(doc.createTextNode(moment));
-    }
+        xml.writeTextElement(QStringLiteral("TimeOfDay"), moment);
+    xml.writeEndElement();
 
     std::sort(locationTypes.begin(), locationTypes.end());
-    QDomElement sceneIntrosE = doc.createElement(QStringLiteral("SceneIntros"));
-    smartTypeE.appendChild(sceneIntrosE);
-    sceneIntrosE.setAttribute(QStringLiteral("Separator"), QStringLiteral(". "));
+    xml.writeStartElement(QStringLiteral("SceneIntros"));
+    xml.writeAttribute(QStringLiteral("Separator"), QStringLiteral(". "));
     Q_FOREACH(QString locationType, locationTypes)
-    {
-        QDomElement sceneIntroE = doc.createElement(QStringLiteral("SceneIntro"));
-        sceneIntrosE.appendChild(sceneIntroE);
-        sceneIntroE.appendChild(doc.createTextNode(locationType));
-    }
-
-    const QString xml = doc.toString(4);
+        xml.writeTextElement(QStringLiteral("SceneIntro"), locationType);
+    xml.writeEndElement();
 
-    QTextStream ts(device);
-    ts.setCodec("utf-8");
-    ts.setAutoDetectUnicode(true);
+    xml.writeEndElement(); // SmartType
+    xml.writeEndElement(); // FinalDraft
+    xml.writeEndDocument();
 
-    ts << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n";
-    ts << xml;
-    ts.flush();
+    if(xml.hasError())
+    {
+        this->error()->setErrorMessage(QStringLiteral("Error writing Final Draft file."));
+        return false;
+    }
 
     return true;
 }
@@ -14,7 +14,10 @@
 #include "htmlexporter.h"
 
 #include <QDir>
+#include <QHash>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
 #include <QTextBoundaryFinder>
 
 HtmlExporter::HtmlExporter(QObject *parent)
@@ -46,6 +49,85 @@ void HtmlExporter::setIncludeSceneNumbers(bool val)
     emit includeSceneNumbersChanged();
 }
 
+void HtmlExporter::setSplitAtActBreaks(bool val)
+{
+    if(m_splitAtActBreaks == val)
+        return;
+
+    m_splitAtActBreaks = val;
+    emit splitAtActBreaksChanged();
+}
+
+void HtmlExporter::setScenesPerFile(int val)
+{
+    if(m_scenesPerFile == val)
+        return;
+
+    m_scenesPerFile = val;
+    emit scenesPerFileChanged();
+}
+
+// Hashes are remembered along with the size and modification time of the
+// file they were computed from, so that files which have not changed since
+// the last export are not read again.
+static QByteArray fileContentHash(const QString &filePath)
+{
+    static QHash< QString, QPair<QString,QByteArray> > hashCache;
+
+    const QFileInfo fi(filePath);
+    if(!fi.exists())
+        return QByteArray();
+
+    const QString key = fi.absoluteFilePath();
+    const QString stamp = QString::number(fi.size()) + "/" + QString::number(fi.lastModified().toMSecsSinceEpoch());
+    const QPair<QString,QByteArray> cached = hashCache.value(key);
+    if(cached.first == stamp)
+        return cached.second;
+
+    QFile file(filePath);
+    if(!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+
+    const QByteArray ret = hash.result();
+    hashCache.insert(key, qMakePair(stamp, ret));
+    return ret;
+}
+
+static bool bundleFont(const QString &source, const QString &dest)
+{
+    // Fonts copied by an earlier export are left alone, unless they differ
+    // from the ones installed now. QFile::copy() never overwrites anyway.
+    const QFileInfo destInfo(dest);
+    if(destInfo.exists())
+    {
+        if(destInfo.size() == QFileInfo(source).size() && fileContentHash(dest) == fileContentHash(source))
+            return true;
+
+        QFile::remove(dest);
+    }
+
+    QDir().mkpath(destInfo.absolutePath());
+    return QFile::copy(source, dest);
+}
+
+static bool writeFileIfChanged(const QString &filePath, const QByteArray &content)
+{
+    // Browsers and file sync tools only have to look at parts that changed.
+    const QFileInfo fi(filePath);
+    if(fi.exists() && fi.size() == content.size() &&
+       fileContentHash(filePath) == QCryptographicHash::hash(content, QCryptographicHash::Sha1))
+        return true;
+
+    QFile file(filePath);
+    if(!file.open(QFile::WriteOnly))
+        return false;
+
+    return file.write(content) == content.size();
+}
+
 bool HtmlExporter::doExport(QIODevice *device)
 {
     const Screenplay *screenplay = this->document()->screenplay();
@@ -70,18 +152,77 @@ bool HtmlExporter::doExport(QIODevice *device)
     typeStringMap[SceneElement::Shot] = "shot";
     typeStringMap[SceneElement::Transition] = "transition";
 
-    QTextStream ts(device);
-    ts.setCodec("utf-8");
-    ts.setAutoDetectUnicode(true);
+    // Scenes are grouped into parts, at act breaks or after every so many
+    // scenes. Each part goes into a file of its own, when there is more than
+    // one, and all of them share one style sheet.
+    struct Part
+    {
+        int from;
+        int to;
+        QString title;
+    };
+
+    QList<Part> parts;
+    QList<QColor> sceneColors;
+    QHash<QRgb,int> sceneColorIndexMap;
+
+    {
+        Part part;
+        part.from = 0;
+        part.to = -1;
+        int nrPartScenes = 0;
+
+        const int nrElements = screenplay->elementCount();
+        for(int i=0; i<nrElements; i++)
+        {
+            const ScreenplayElement *screenplayElement = screenplay->elementAt(i);
+            if(screenplayElement->elementType() == ScreenplayElement::BreakElementType)
+            {
+                if(m_splitAtActBreaks && screenplayElement->breakType() == Screenplay::Act)
+                {
+                    if(nrPartScenes > 0)
+                        parts.append(part);
 
-    ts << "<!DOCTYPE html>\n";
-    ts << "<html>\n";
-    ts << "  <head>\n";
-    ts << "    <title>" << screenplay->title() << "</title>\n";
-    ts << "    <meta charset=\"UTF-8\">\n";
-    ts << "  </head>\n";
-    ts << "  <body>\n";
-    ts << "    <style>\n";
+                    part.from = i;
+                    part.title = screenplayElement->breakTitle();
+                    nrPartScenes = 0;
+                }
+
+                part.to = i;
+                continue;
+            }
+
+            if(m_scenesPerFile > 0 && nrPartScenes == m_scenesPerFile)
+            {
+                parts.append(part);
+                part.from = i;
+                part.title.clear();
+                nrPartScenes = 0;
+            }
+
+            part.to = i;
+            ++nrPartScenes;
+
+            // Scenes of the same color share a style class.
+            if(m_exportWithSceneColors)
+            {
+                const QColor sceneColor = screenplayElement->scene()->color();
+                if(!sceneColorIndexMap.contains(sceneColor.rgba()))
+                {
+                    sceneColorIndexMap.insert(sceneColor.rgba(), sceneColors.size());
+                    sceneColors.append(sceneColor);
+                }
+            }
+        }
+
+        if(nrPartScenes > 0 || parts.isEmpty())
+            parts.append(part);
+    }
+
+    const bool splitIntoFiles = parts.size() > 1;
+
+    QString styleSheet;
+    QTextStream css(&styleSheet);
 
     const QMetaObject *tmo = TransliterationEngine::instance()->metaObject();
     const QMetaEnum langEnum = tmo->enumerator( tmo->indexOfEnumerator("Language") );
@@ -91,38 +232,49 @@ bool HtmlExporter::doExport(QIODevice *device)
     QMap<TransliterationEngine::Language,bool>::const_iterator end = langBundleMap.constEnd();
     const QString fontsDir = QFileInfo(this->fileName()).absolutePath() + "/fonts";
 
+    // Languages often share font files. Each file is bundled only once, and
+    // all font faces that use it point to the same copy.
+    QHash<QString,QString> bundledFontUrls;
+
     while(it != end)
     {
         if(it.value())
         {
-            QDir().mkpath(fontsDir);
-
             const QStringList fontSources = TransliterationEngine::instance()->languageFontFilePaths(it.key());
             Q_FOREACH(QString fontSource, fontSources)
             {
-                const QString lang = QString::fromLatin1(langEnum.valueToKey(it.key()));
-                const QString fontFile = QFileInfo(fontSource).fileName();
-                const QString fontDest = fontsDir + "/" + lang + "/" + fontFile;
-                QDir().mkpath( QFileInfo(fontDest).absolutePath() );
-                QFile::copy(fontSource, fontDest);
+                QString fontUrl = bundledFontUrls.value(fontSource);
+                if(fontUrl.isEmpty())
+                {
+                    const QString lang = QString::fromLatin1(langEnum.valueToKey(it.key()));
+                    const QString fontFile = QFileInfo(fontSource).fileName();
+                    if(!bundleFont(fontSource, fontsDir + "/" + lang + "/" + fontFile))
+                    {
+                        this->error()->setErrorMessage( QString("Could not copy font '%1' into '%2'.").arg(fontFile).arg(fontsDir) );
+                        return false;
+                    }
+
+                    fontUrl = "fonts/" + lang + "/" + fontFile;
+                    bundledFontUrls.insert(fontSource, fontUrl);
+                }
 
                 QRawFont rawFont(fontSource, 12);
 
-                ts << "    @font-face {\n";
-                ts << "      font-family: lang_" <<  it.key() << "_" << rawFont.weight() << "_" << rawFont.style() << ";\n";
-                ts << "      src: url(fonts/" << lang << "/" << fontFile << ");\n";
-                ts << "      font-weight: " << rawFont.weight() << ";\n";
-                ts << "      ";
+                css << "    @font-face {\n";
+                css << "      font-family: lang_" <<  it.key() << "_" << rawFont.weight() << "_" << rawFont.style() << ";\n";
+                css << "      src: url(" << fontUrl << ");\n";
+                css << "      font-weight: " << rawFont.weight() << ";\n";
+                css << "      ";
                 switch(rawFont.style())
                 {
-                case QFont::StyleNormal: ts << "normal;\n"; break;
-                case QFont::StyleItalic: ts << "italic;\n"; break;
-                case QFont::StyleOblique: ts << "oblique;\n"; break;
+                case QFont::StyleNormal: css << "normal;\n"; break;
+                case QFont::StyleItalic: css << "italic;\n"; break;
+                case QFont::StyleOblique: css << "oblique;\n"; break;
                 }
-                ts << "    }\n";
-                ts << "    span.lang_" << it.key() << "_" << rawFont.weight() << "_" << rawFont.style() << " {\n";
-                ts << "      font-family: lang_" << it.key() << "_" << rawFont.weight() << "_" << rawFont.style() << ";\n";
-                ts << "    }\n";
+                css << "    }\n";
+                css << "    span.lang_" << it.key() << "_" << rawFont.weight() << "_" << rawFont.style() << " {\n";
+                css << "      font-family: lang_" << it.key() << "_" << rawFont.weight() << "_" << rawFont.style() << ";\n";
+                css << "    }\n";
             }
         }
 
@@ -132,143 +284,260 @@ bool HtmlExporter::doExport(QIODevice *device)
     for(int i=SceneElement::Min; i<=SceneElement::Max; i++)
     {
         if(i > SceneElement::Min)
-            ts << "\n";
+            css << "\n";
 
         SceneElement::Type elementType = SceneElement::Type(i);
         SceneElementFormat *format = formatting->elementFormat(elementType);
-        ts << "    p.scrite-" << typeStringMap.value(elementType) << " {\n";
+        css << "    p.scrite-" << typeStringMap.value(elementType) << " {\n";
 #if 0
-        ts << "      font-family: \"" << format->font().family() << "\";\n";
+        css << "      font-family: \"" << format->font().family() << "\";\n";
 #else
-        ts << "      font-family: \"Courier New\", Courier, monospace;\n";
+        css << "      font-family: \"Courier New\", Courier, monospace;\n";
 #endif
-        ts << "      font-size: " << format->font().pointSize() << "pt;\n";
+        css << "      font-size: " << format->font().pointSize() << "pt;\n";
         if(format->font().bold())
-            ts << "      font-weight: bold;\n";
+            css << "      font-weight: bold;\n";
         if(format->font().italic())
-            ts << "      font-style: italic;\n";
-        ts << "      color: " << format->textColor().name() << ";\n";
+            css << "      font-style: italic;\n";
+        css << "      color: " << format->textColor().name() << ";\n";
         if(format->backgroundColor() != Qt::transparent)
-            ts << "      background-color: " << format->backgroundColor().name() << ";\n";
-        ts << "      text-align: ";
+            css << "      background-color: " << format->backgroundColor().name() << ";\n";
+        css << "      text-align: ";
         switch(format->textAlignment())
         {
         case Qt::AlignLeft:
-            ts << "left;\n";
+            css << "left;\n";
             break;
         case Qt::AlignRight:
-            ts << "right;\n";
+            css << "right;\n";
             break;
         case Qt::AlignHCenter:
-            ts << "center;\n";
+            css << "center;\n";
             break;
         case Qt::AlignJustify:
         default:
-            ts << "justify;\n";
+            css << "justify;\n";
             break;
         }
 
         const int pLeftMargin = int(format->leftMargin() * contentWidth + leftMargin);
         const int pRightMargin = int(format->rightMargin() * contentWidth + rightMargin);
 
-        ts << "      padding-left: " << pLeftMargin << "px;\n";
-        ts << "      padding-right: " << pRightMargin << "px;\n";
+        css << "      padding-left: " << pLeftMargin << "px;\n";
+        css << "      padding-right: " << pRightMargin << "px;\n";
         if(qFuzzyIsNull(format->lineSpacingBefore()) || format->elementType() == SceneElement::Heading)
-            ts << "      padding-top: 0px;\n";
+            css << "      padding-top: 0px;\n";
         else
-            ts << "      padding-top: " << format->lineSpacingBefore() << "em;\n";
-        ts << "      padding-bottom: 0px;\n";
-        ts << "      margin: 0px;\n";
-        ts << "      line-height: " << format->lineHeight()*1.1 << "em;\n";
-        ts << "    }\n";
+            css << "      padding-top: " << format->lineSpacingBefore() << "em;\n";
+        css << "      padding-bottom: 0px;\n";
+        css << "      margin: 0px;\n";
+        css << "      line-height: " << format->lineHeight()*1.1 << "em;\n";
+        css << "    }\n";
     }
 
     const SceneElementFormat *headingFormat = formatting->elementFormat(SceneElement::Heading);
 
-    ts << "\n";
-    ts << "    div.scrite-scene {\n";
+    css << "\n";
+    css << "    div.scrite-scene {\n";
     if(qFuzzyIsNull(headingFormat->lineSpacingBefore()))
-        ts << "      padding-top: 0px;\n";
+        css << "      padding-top: 0px;\n";
     else
-        ts << "      padding-top: " << headingFormat->lineSpacingBefore() << "em;\n";
-    ts << "      padding-bottom: 0px;\n";
-    ts << "      padding-left: 0px;\n";
-    ts << "      padding-right: 0px;\n";
-    ts << "    }\n";
-
-    ts << "\n";
-    ts << "    div.scrite-screenplay {\n";
-    ts << "        width: " << int(paperWidth) << "px;\n";
-    ts << "        border: 1px solid gray;\n";
-    ts << "        margin-left: auto;\n";
-    ts << "        margin-right: auto;\n";
-    ts << "        margin-top: " << topMargin << "px;\n";
-    ts << "        margin-bottom: " << bottomMargin << "px;\n";
-    ts << "    }\n";
-
-    ts << "    </style>\n\n";
+        css << "      padding-top: " << headingFormat->lineSpacingBefore() << "em;\n";
+    css << "      padding-bottom: 0px;\n";
+    css << "      padding-left: 0px;\n";
+    css << "      padding-right: 0px;\n";
+    css << "    }\n";
+
+    css << "\n";
+    css << "    div.scrite-screenplay {\n";
+    css << "        width: " << int(paperWidth) << "px;\n";
+    css << "        border: 1px solid gray;\n";
+    css << "        margin-left: auto;\n";
+    css << "        margin-right: auto;\n";
+    css << "        margin-top: " << topMargin << "px;\n";
+    css << "        margin-bottom: " << bottomMargin << "px;\n";
+    css << "    }\n";
+
+    for(int i=0; i<sceneColors.size(); i++)
+    {
+        const QColor sceneColor = sceneColors.at(i);
+        css << "\n";
+        css << "    div.scrite-scene-color-" << i << " {\n";
+        css << "      background-color: rgba(" << sceneColor.red() << "," << sceneColor.green() << "," << sceneColor.blue() << ",0.1);\n";
+        css << "    }\n";
+    }
 
-    ts << "    <div class=\"scrite-screenplay\">\n";
+    if(splitIntoFiles)
+    {
+        css << "\n";
+        css << "    p.scrite-navigation {\n";
+        css << "      font-family: \"Courier New\", Courier, monospace;\n";
+        css << "      text-align: center;\n";
+        css << "      margin: 10px;\n";
+        css << "    }\n";
+    }
+
+    css.flush();
 
-    auto writeParagraph = [&ts,typeStringMap,langBundleMap](SceneElement::Type type, const QString &text) {
+    auto writeParagraph = [typeStringMap,langBundleMap](QTextStream &ts, SceneElement::Type type, const QString &text) {
         const QString styleName = "scrite-" + typeStringMap.value(type);
         ts << "        <p class=\"" << styleName << "\" custom-style=\"" << styleName << "\">";
         QList<TransliterationEngine::Boundary> breakup = TransliterationEngine::instance()->evaluateBoundaries(text);
         Q_FOREACH(TransliterationEngine::Boundary item, breakup) {
             if(!langBundleMap.value(item.language,false))
-                ts << "<span>" << item.string << "</span>";
+                ts << item.string;
             else
                 ts << "<span class=\"lang_" << item.language << "_" << QFont::Normal << "_" << QFont::StyleNormal << "\">" << item.string << "</span>";
         }
         ts << "</p>\n";
     };
 
-    const int nrScenes = screenplay->elementCount();
-    int nrHeadings = 0;
-    for(int i=0; i<nrScenes; i++)
-    {
-        const ScreenplayElement *screenplayElement = screenplay->elementAt(i);
-        if(screenplayElement->elementType() != ScreenplayElement::SceneElementType)
-            continue;
-
-        const Scene *scene = screenplayElement->scene();
+    auto writeScenes = [=](QTextStream &ts, const Part &part) {
+        ts << "    <div class=\"scrite-screenplay\">\n";
 
-        if(m_exportWithSceneColors)
+        for(int i=part.from; i<=part.to; i++)
         {
-            const QColor sceneColor = scene->color();
-            const QString sceneColorText = "rgba(" + QString::number(sceneColor.red()) + "," +
-                    QString::number(sceneColor.green()) + "," +
-                    QString::number(sceneColor.blue()) + ",0.1)";
-            ts << "      <div class=\"scrite-scene\" custom-style=\"scrite-scene\" style=\"background-color: " << sceneColorText << ";\">\n";
-        }
-        else
-            ts << "      <div class=\"scrite-scene\" custom-style=\"scrite-scene\">\n";
+            const ScreenplayElement *screenplayElement = screenplay->elementAt(i);
+            if(screenplayElement->elementType() != ScreenplayElement::SceneElementType)
+                continue;
 
-        const SceneHeading *heading = scene->heading();
-        if(heading->isEnabled())
-        {
-            ++nrHeadings;
-            if(m_includeSceneNumbers)
-                writeParagraph(SceneElement::Heading, "[" + screenplayElement->resolvedSceneNumber() + "] " + heading->text());
+            const Scene *scene = screenplayElement->scene();
+
+            if(m_exportWithSceneColors)
+            {
+                const int colorIndex = sceneColorIndexMap.value(scene->color().rgba());
+                ts << "      <div class=\"scrite-scene scrite-scene-color-" << colorIndex << "\" custom-style=\"scrite-scene\">\n";
+            }
             else
-                writeParagraph(SceneElement::Heading, heading->text());
+                ts << "      <div class=\"scrite-scene\" custom-style=\"scrite-scene\">\n";
+
+            const SceneHeading *heading = scene->heading();
+            if(heading->isEnabled())
+            {
+                if(m_includeSceneNumbers)
+                    writeParagraph(ts, SceneElement::Heading, "[" + screenplayElement->resolvedSceneNumber() + "] " + heading->text());
+                else
+                    writeParagraph(ts, SceneElement::Heading, heading->text());
+            }
+
+            const int nrElements = scene->elementCount();
+            for(int j=0; j<nrElements; j++)
+            {
+                SceneElement *element = scene->elementAt(j);
+                writeParagraph(ts, element->type(), element->formattedText());
+            }
+
+            if(i == part.to)
+                ts << "<p class=\"scrite-action\" custom-style=\"scrite-action\">&nbsp;</p>";
+
+            ts << "      </div>\n";
         }
 
-        const int nrElements = scene->elementCount();
-        for(int j=0; j<nrElements; j++)
+        ts << "    </div>\n\n";
+    };
+
+    if(!splitIntoFiles)
+    {
+        QTextStream ts(device);
+        ts.setCodec("utf-8");
+        ts.setAutoDetectUnicode(true);
+
+        ts << "<!DOCTYPE html>\n";
+        ts << "<html>\n";
+        ts << "  <head>\n";
+        ts << "    <title>" << screenplay->title() << "</title>\n";
+        ts << "    <meta charset=\"UTF-8\">\n";
+        ts << "  </head>\n";
+        ts << "  <body>\n";
+        ts << "    <style>\n";
+        ts << styleSheet;
+        ts << "    </style>\n\n";
+
+        writeScenes(ts, parts.first());
+
+        ts << "  </body>\n";
+        ts << "</html>\n";
+
+        ts.flush();
+
+        return true;
+    }
+
+    // The file that was asked for lists the parts, which are written next
+    // to it. Parts and the style sheet are rewritten only if they changed.
+    const QFileInfo fileInfo(this->fileName());
+    QDir dir = fileInfo.absoluteDir();
+    const QString baseName = fileInfo.completeBaseName();
+    const QString styleSheetFileName = baseName + ".css";
+    auto partFileName = [baseName](int index) {
+        return baseName + "-" + QString::number(index+1).rightJustified(3, '0') + ".html";
+    };
+    auto partTitle = [parts](int index) {
+        const QString title = parts.at(index).title;
+        return title.isEmpty() ? QString("Part %1").arg(index+1) : title;
+    };
+
+    if(!writeFileIfChanged(dir.absoluteFilePath(styleSheetFileName), styleSheet.toUtf8()))
+    {
+        this->error()->setErrorMessage( QString("Could not write '%1'.").arg(styleSheetFileName) );
+        return false;
+    }
+
+    auto writeHead = [=](QTextStream &ts, const QString &title) {
+        ts << "<!DOCTYPE html>\n";
+        ts << "<html>\n";
+        ts << "  <head>\n";
+        ts << "    <title>" << title << "</title>\n";
+        ts << "    <meta charset=\"UTF-8\">\n";
+        ts << "    <link rel=\"stylesheet\" href=\"" << styleSheetFileName << "\">\n";
+        ts << "  </head>\n";
+        ts << "  <body>\n";
+    };
+
+    for(int i=0; i<parts.size(); i++)
+    {
+        QString navigation;
+        navigation += "    <p class=\"scrite-navigation\">";
+        if(i > 0)
+            navigation += "<a href=\"" + partFileName(i-1) + "\">Previous</a> | ";
+        navigation += "<a href=\"" + fileInfo.fileName() + "\">Contents</a>";
+        if(i < parts.size()-1)
+            navigation += " | <a href=\"" + partFileName(i+1) + "\">Next</a>";
+        navigation += "</p>\n";
+
+        QByteArray partContent;
+        QTextStream ts(&partContent);
+        ts.setCodec("utf-8");
+
+        writeHead(ts, screenplay->title() + " - " + partTitle(i).toHtmlEscaped());
+        ts << navigation;
+        writeScenes(ts, parts.at(i));
+        ts << navigation;
+        ts << "  </body>\n";
+        ts << "</html>\n";
+        ts.flush();
+
+        if(!writeFileIfChanged(dir.absoluteFilePath(partFileName(i)), partContent))
         {
-            SceneElement *element = scene->elementAt(j);
-            writeParagraph(element->type(), element->formattedText());
+            this->error()->setErrorMessage( QString("Could not write '%1'.").arg(partFileName(i)) );
+            return false;
         }
+    }
 
-        if(i == nrScenes-1)
-            ts << "<p class=\"scrite-action\" custom-style=\"scrite-action\">&nbsp;</p>";
+    // Parts left over from an earlier export of a longer screenplay.
+    for(int i=parts.size(); dir.exists(partFileName(i)); i++)
+        dir.remove(partFileName(i));
 
-        ts << "      </div>\n";
-    }
+    QTextStream ts(device);
+    ts.setCodec("utf-8");
+    ts.setAutoDetectUnicode(true);
 
+    writeHead(ts, screenplay->title());
+    ts << "    <div class=\"scrite-screenplay\">\n";
+    ts << "      <p class=\"scrite-heading\" custom-style=\"scrite-heading\">" << screenplay->title() << "</p>\n";
+    for(int i=0; i<parts.size(); i++)
+        ts << "      <p class=\"scrite-action\" custom-style=\"scrite-action\"><a href=\"" << partFileName(i) << "\">" << partTitle(i).toHtmlEscaped() << "</a></p>\n";
     ts << "    </div>\n\n";
-
     ts << "  </body>\n";
     ts << "</html>\n";
 
@@ -40,6 +40,23 @@ public:
     bool isExportWithSceneColors() const { return m_exportWithSceneColors; }
     Q_SIGNAL void exportWithSceneColorsChanged();
 
+    Q_CLASSINFO("splitAtActBreaks_FieldLabel", "Write each act into a separate HTML file.")
+    Q_CLASSINFO("splitAtActBreaks_FieldEditor", "CheckBox")
+    Q_PROPERTY(bool splitAtActBreaks READ isSplitAtActBreaks WRITE setSplitAtActBreaks NOTIFY splitAtActBreaksChanged)
+    void setSplitAtActBreaks(bool val);
+    bool isSplitAtActBreaks() const { return m_splitAtActBreaks; }
+    Q_SIGNAL void splitAtActBreaksChanged();
+
+    Q_CLASSINFO("scenesPerFile_FieldLabel", "Number of scenes per HTML file. Zero puts all scenes in one file.")
+    Q_CLASSINFO("scenesPerFile_FieldEditor", "IntegerSpinBox")
+    Q_CLASSINFO("scenesPerFile_FieldMinValue", "0")
+    Q_CLASSINFO("scenesPerFile_FieldMaxValue", "1000")
+    Q_CLASSINFO("scenesPerFile_FieldDefaultValue", "0")
+    Q_PROPERTY(int scenesPerFile READ scenesPerFile WRITE setScenesPerFile NOTIFY scenesPerFileChanged)
+    void setScenesPerFile(int val);
+    int scenesPerFile() const { return m_scenesPerFile; }
+    Q_SIGNAL void scenesPerFileChanged();
+
     bool canBundleFonts() const { return true; }
     bool requiresConfiguration() const { return true; }
 
@@ -50,6 +67,8 @@ protected:
 private:
     bool m_includeSceneNumbers = false;
     bool m_exportWithSceneColors = false;
+    bool m_splitAtActBreaks = false;
+    int m_scenesPerFile = 0;
 };
 
 #endif // HTMLEXPORTER_H
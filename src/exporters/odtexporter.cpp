@@ -12,6 +12,7 @@
 ****************************************************************************/
 
 #include "odtexporter.h"
+#include "qtextdocumentpagedprinter.h"
 
 #include <QFileInfo>
 #include <QPdfWriter>
@@ -43,12 +44,36 @@ bool OdtExporter::doExport(QIODevice *device)
     QTextDocument textDocument;
     this->AbstractTextDocumentExporter::generate(&textDocument, pageWidth);
 
-    QTextDocumentWriter writer;
-    writer.setFormat("ODF");
-    writer.setDevice(device);
-    writer.write(&textDocument);
+    // In the background, the document is rebuilt from a snapshot on the
+    // worker thread. This one goes away when this function returns.
+    QTextDocument *odtDocument = &textDocument;
+    QTextDocumentSnapshot snapshot;
+    if(this->isRunJobsInBackground())
+    {
+        snapshot = QTextDocumentSnapshot(&textDocument);
+        odtDocument = nullptr;
+    }
 
-    return true;
+    DeviceIOJob *job = this->createJob();
+    job->setFunction([=](DeviceIOJob *job) {
+        QScopedPointer<QTextDocument> snapshotDocument(snapshot.create());
+        QTextDocument *document = snapshotDocument.isNull() ? odtDocument : snapshotDocument.data();
+
+        job->reportProgress(0, 1, QStringLiteral("Writing ODT"));
+
+        QTextDocumentWriter writer;
+        writer.setFormat("ODF");
+        writer.setDevice(device);
+        if(!writer.write(document))
+        {
+            job->setErrorMessage("Could not write the ODT file.");
+            return false;
+        }
+
+        return true;
+    });
+
+    return this->runJob(job);
 }
 
 QString OdtExporter::polishFileName(const QString &fileName) const
@@ -92,23 +92,69 @@ bool PdfExporter::doExport(QIODevice *device)
     Screenplay *screenplay = this->document()->screenplay();
     ScreenplayFormat *format = this->document()->printFormat();
 
-    QPdfWriter pdfWriter(device);
-    pdfWriter.setTitle(screenplay->title());
-    pdfWriter.setCreator(qApp->applicationName() + " " + qApp->applicationVersion());
-    format->pageLayout()->configure(&pdfWriter);
-    pdfWriter.setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
-
-    const qreal pageWidth = pdfWriter.width();
-    QTextDocument textDocument;
-    this->AbstractTextDocumentExporter::generate(&textDocument, pageWidth);    
-    textDocument.setProperty("#comment", m_comment);
-    textDocument.setProperty("#watermark", m_watermark);
-
-    QTextDocumentPagedPrinter printer;
-    printer.header()->setVisibleFromPageOne(false);
-    printer.footer()->setVisibleFromPageOne(false);
-    printer.watermark()->setVisibleFromPageOne(false);
-    return printer.print(&textDocument, &pdfWriter);
+    QPdfWriter *pdfWriter = new QPdfWriter(device);
+    pdfWriter->setTitle(screenplay->title());
+    pdfWriter->setCreator(qApp->applicationName() + " " + qApp->applicationVersion());
+    format->pageLayout()->configure(pdfWriter);
+    pdfWriter->setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
+
+    QTextDocumentPagedPrinter *printer = new QTextDocumentPagedPrinter;
+    printer->header()->setVisibleFromPageOne(false);
+    printer->footer()->setVisibleFromPageOne(false);
+    printer->watermark()->setVisibleFromPageOne(false);
+
+    DeviceIOJob *job = this->createJob();
+
+    // The document may be the one shown in print preview, so comment and
+    // watermark are put on it only for as long as it takes to print. When
+    // printing in the background, the document is rebuilt from a snapshot
+    // on the worker thread, and they are put on the snapshot instead.
+    QTextDocument *textDocument = this->AbstractTextDocumentExporter::generatePaginated();
+    QTextDocumentSnapshot snapshot;
+    QVariant previousComment, previousWatermark;
+    if(this->isRunJobsInBackground())
+    {
+        snapshot = QTextDocumentSnapshot(textDocument);
+        snapshot.setProperty("#comment", m_comment);
+        snapshot.setProperty("#watermark", m_watermark);
+        textDocument = nullptr;
+    }
+    else
+    {
+        previousComment = textDocument->property("#comment");
+        previousWatermark = textDocument->property("#watermark");
+        textDocument->setProperty("#comment", m_comment);
+        textDocument->setProperty("#watermark", m_watermark);
+    }
+
+    job->handOver(printer);
+    job->handOver(pdfWriter);
+    job->setFunction([=](DeviceIOJob *job) {
+        QScopedPointer<QTextDocument> snapshotDocument(snapshot.create());
+        QTextDocument *document = snapshotDocument.isNull() ? textDocument : snapshotDocument.data();
+
+        printer->setPageFunction([=](int pageNr, int pageCount) {
+            job->reportProgress(pageNr, pageCount, QString("Printing page %1 of %2").arg(pageNr).arg(pageCount));
+            return !job->isCancelled();
+        });
+
+        if(!printer->print(document, pdfWriter))
+        {
+            if(!job->isCancelled())
+                job->setErrorMessage("Could not print the screenplay.");
+            return false;
+        }
+
+        return true;
+    });
+
+    if(textDocument == nullptr)
+        return this->runJob(job);
+
+    const bool success = this->runJob(job);
+    textDocument->setProperty("#comment", previousComment);
+    textDocument->setProperty("#watermark", previousWatermark);
+    return success;
 }
 
 QString PdfExporter::polishFileName(const QString &fileName) const
@@ -13,6 +13,7 @@
 
 #include "finaldraftimporter.h"
 
+#include <QXmlStreamReader>
 
 FinalDraftImporter::FinalDraftImporter(QObject *parent)
     : AbstractImporter(parent)
@@ -27,99 +28,181 @@ FinalDraftImporter::~FinalDraftImporter()
 
 bool FinalDraftImporter::doImport(QIODevice *device)
 {
-    QString errMsg;
-    int errLine = -1;
-    int errCol = -1;
-
-    QDomDocument doc;
-    if( !doc.setContent(device, &errMsg, &errLine, &errCol) )
-    {
-        const QString msg = QString("Parse Error: %1 at Line %2, Column %3").arg(errMsg).arg(errLine).arg(errCol);
-        this->error()->setErrorMessage(msg);
+    // The file is read as a stream, twice. The first pass checks that all of
+    // it can be read and counts paragraphs, so that nothing is created from
+    // a broken file and the canvas is sized before scenes are placed on it.
+    // The second pass creates scenes and paragraphs as they are read. Either
+    // way, only the paragraph being read is held in memory.
+    const qint64 startPos = device->pos();
+    const int nrParagraphs = this->countParagraphs(device);
+    if(nrParagraphs < 0)
         return false;
-    }
 
-    QDomElement rootE = doc.documentElement();
-    if(rootE.tagName() != "FinalDraft")
+    if(nrParagraphs == 0)
     {
-        this->error()->setErrorMessage("Not a Final-Draft file.");
+        this->error()->setErrorMessage("No paragraphs to import.");
         return false;
     }
 
-    const int fdxVersion = rootE.attribute("Version").toInt();
-    if(rootE.attribute("DocumentType") != "Script" || fdxVersion < 1 || fdxVersion > 4)
+    if(!device->seek(startPos))
     {
-        this->error()->setErrorMessage("Unrecognised Final Draft file version.");
+        this->error()->setErrorMessage("Could not read the file a second time.");
         return false;
     }
 
-    QDomElement contentE = rootE.firstChildElement("Content");
-    QDomNodeList paragraphs = contentE.elementsByTagName("Paragraph");
-    if(paragraphs.isEmpty())
-    {
-        this->error()->setErrorMessage("No paragraphs to import.");
-        return false;
-    }
+    this->configureCanvas(nrParagraphs);
 
-    Scene *scene = nullptr;
-    this->progress()->setProgressStep(1.0 / qreal(paragraphs.size()+1));
-    this->configureCanvas(paragraphs.size());
+    QXmlStreamReader reader(device);
+    reader.readNextStartElement(); // FinalDraft, checked in the first pass
+
+    // Progress is reported by how far into the file we are.
+    this->progress()->setProgressStep(1.0 / 101.0);
 
     static const QStringList types = QStringList()
             << "Scene Heading" << "Action" << "Character"
             << "Dialogue" << "Parenthetical" << "Shot"
             << "Transition";
-    QDomElement paragraphE = contentE.firstChildElement("Paragraph");
-    while(!paragraphE.isNull())
-    {
-        TraverseDomElement tde(paragraphE, this->progress());
 
-        const QString type = paragraphE.attribute("Type");
-        const int typeIndex = types.indexOf(type);
-        if(typeIndex < 0)
+    Scene *scene = nullptr;
+    Screenplay *screenplay = this->document()->screenplay();
+
+    while(reader.readNextStartElement())
+    {
+        if(reader.name() != QStringLiteral("Content"))
+        {
+            reader.skipCurrentElement();
             continue;
+        }
 
-        QString text;
-        QDomElement textE = paragraphE.firstChildElement("Text");
-        while(!textE.isNull())
+        while(reader.readNextStartElement())
         {
-            if(!text.isEmpty())
-                text += QStringLiteral(" ");
-            text += textE.text();
-            textE = textE.nextSiblingElement("Text");
+            if(reader.name() != QStringLiteral("Paragraph"))
+            {
+                reader.skipCurrentElement();
+                continue;
+            }
+
+            const QXmlStreamAttributes attributes = reader.attributes();
+            const int typeIndex = types.indexOf(attributes.value(QStringLiteral("Type")).toString());
+
+            QString text;
+            while(reader.readNextStartElement())
+            {
+                if(reader.name() != QStringLiteral("Text") || typeIndex < 0)
+                {
+                    reader.skipCurrentElement();
+                    continue;
+                }
+
+                if(!text.isEmpty())
+                    text += QStringLiteral(" ");
+                text += reader.readElementText(QXmlStreamReader::IncludeChildElements);
+            }
+
+            this->reportReadProgress(device);
+
+            if(typeIndex < 0 || text.isEmpty())
+                continue;
+
+            switch(typeIndex)
+            {
+            case 0: {
+                scene = this->createScene(text);
+                const QString number = attributes.value(QStringLiteral("Number")).toString();
+                ScreenplayElement *element = screenplay->elementAt(screenplay->elementCount()-1);
+                element->setUserSceneNumber(number);
+                } break;
+            case 1:
+                this->addSceneElement(scene, SceneElement::Action, text);
+                break;
+            case 2:
+                this->addSceneElement(scene, SceneElement::Character, text);
+                break;
+            case 3:
+                this->addSceneElement(scene, SceneElement::Dialogue, text);
+                break;
+            case 4:
+                this->addSceneElement(scene, SceneElement::Parenthetical, text);
+                break;
+            case 5:
+                this->addSceneElement(scene, SceneElement::Shot, text);
+                break;
+            case 6:
+                this->addSceneElement(scene, SceneElement::Transition, text);
+                break;
+            }
         }
+    }
 
-        if(text.isEmpty())
-            continue;
+    // The file may have changed since the first pass. Whatever was imported
+    // is thrown away, rather than leaving a partial screenplay behind.
+    if(reader.hasError())
+    {
+        this->reportParseError(reader);
+        this->document()->reset();
+        return false;
+    }
+
+    this->reportReadProgress(device);
 
-        switch(typeIndex)
+    return true;
+}
+
+int FinalDraftImporter::countParagraphs(QIODevice *device)
+{
+    QXmlStreamReader reader(device);
+
+    if(!reader.readNextStartElement() || reader.name() != QStringLiteral("FinalDraft"))
+    {
+        if(reader.hasError())
+            this->reportParseError(reader);
+        else
+            this->error()->setErrorMessage("Not a Final-Draft file.");
+        return -1;
+    }
+
+    const QXmlStreamAttributes rootAttributes = reader.attributes();
+    const int fdxVersion = rootAttributes.value(QStringLiteral("Version")).toInt();
+    if(rootAttributes.value(QStringLiteral("DocumentType")) != QStringLiteral("Script") || fdxVersion < 1 || fdxVersion > 4)
+    {
+        this->error()->setErrorMessage("Unrecognised Final Draft file version.");
+        return -1;
+    }
+
+    // Read till the end, so that a broken file is reported as such even if
+    // the damage is past the content.
+    int ret = 0;
+    int contentDepth = 0;
+    while(!reader.atEnd())
+    {
+        switch(reader.readNext())
         {
-        case 0: {
-            scene = this->createScene(text);
-            const QString number = paragraphE.attribute("Number");
-            ScreenplayElement *element = this->document()->screenplay()->elementAt(this->document()->screenplay()->elementCount()-1);
-            element->setUserSceneNumber(number);
-            } break;
-        case 1:
-            this->addSceneElement(scene, SceneElement::Action, text);
-            break;
-        case 2:
-            this->addSceneElement(scene, SceneElement::Character, text);
-            break;
-        case 3:
-            this->addSceneElement(scene, SceneElement::Dialogue, text);
+        case QXmlStreamReader::StartElement:
+            if(reader.name() == QStringLiteral("Content"))
+                ++contentDepth;
+            else if(contentDepth > 0 && reader.name() == QStringLiteral("Paragraph"))
+                ++ret;
             break;
-        case 4:
-            this->addSceneElement(scene, SceneElement::Parenthetical, text);
+        case QXmlStreamReader::EndElement:
+            if(reader.name() == QStringLiteral("Content"))
+                --contentDepth;
             break;
-        case 5:
-            this->addSceneElement(scene, SceneElement::Shot, text);
-            break;
-        case 6:
-            this->addSceneElement(scene, SceneElement::Transition, text);
+        default:
             break;
         }
     }
 
-    return true;
+    if(reader.hasError())
+    {
+        this->reportParseError(reader);
+        return -1;
+    }
+
+    return ret;
+}
+
+void FinalDraftImporter::reportParseError(const QXmlStreamReader &reader)
+{
+    const QString msg = QString("Parse Error: %1 at Line %2, Column %3").arg(reader.errorString()).arg(reader.lineNumber()).arg(reader.columnNumber());
+    this->error()->setErrorMessage(msg);
 }
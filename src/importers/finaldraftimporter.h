@@ -14,9 +14,10 @@
 #ifndef FINALDRAFTIMPORTER_H
 #define FINALDRAFTIMPORTER_H
 
-#include <QDomDocument>
 #include "abstractimporter.h"
 
+class QXmlStreamReader;
+
 class FinalDraftImporter : public AbstractImporter
 {
     Q_OBJECT
@@ -29,6 +30,10 @@ public:
 
 protected:
     bool doImport(QIODevice *device); // AbstractImporter interface
+
+private:
+    int countParagraphs(QIODevice *device);
+    void reportParseError(const QXmlStreamReader &reader);
 };
 
 #endif // FINALDRAFTIMPORTER_H
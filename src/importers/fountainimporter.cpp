@@ -14,7 +14,194 @@
 #include "fountainimporter.h"
 #include "application.h"
 
-#include <QRegExp>
+#include <QTextStream>
+#include <QStringView>
+
+/**
+ * Reads a Fountain file one line at a time, straight from the device, and
+ * resolves the inline syntax of each line in a single pass over it.
+ *
+ * - Boneyard, text commented out the way it is in C, is dropped even if it
+ *   runs across many lines. Lines that have nothing but boneyard are skipped
+ *   altogether, so they don't count as blank lines either.
+ * - Emphasis markers (*italic*, **bold**, ***bold italic*** and _underline_)
+ *   are dropped only when they pair up. Scene elements don't carry inline
+ *   formatting, so the text in between is kept as is. Markers that don't
+ *   pair up, like the one in "5 * 3", are kept as text.
+ * - A backslash makes the character after it plain text.
+ * - Runs of whitespace become a single space, and lines are trimmed.
+ */
+class FountainLineReader
+{
+public:
+    FountainLineReader(QIODevice *device) : m_stream(device) {
+        m_stream.setCodec("utf-8");
+        m_stream.setAutoDetectUnicode(true);
+    }
+    ~FountainLineReader() { }
+
+    // Returns false once there are no more lines. Blank lines come back
+    // as empty strings.
+    bool readLine(QString &line) {
+        while(m_stream.readLineInto(&m_rawLine)) {
+            const bool startedInBoneyard = m_inBoneyard;
+            this->scan(QStringView(m_rawLine));
+            this->assemble(line);
+            if(line.isEmpty() && (startedInBoneyard || m_sawBoneyard))
+                continue;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    void scan(QStringView raw) {
+        m_text.clear();
+        m_markers.clear();
+        m_sawBoneyard = false;
+
+        const int length = raw.size();
+        for(int i=0; i<length; i++) {
+            const QChar ch = raw.at(i);
+            const QChar next = i+1 < length ? raw.at(i+1) : QChar();
+
+            if(m_inBoneyard) {
+                if(ch == QLatin1Char('*') && next == QLatin1Char('/')) {
+                    m_inBoneyard = false;
+                    ++i;
+                }
+                continue;
+            }
+
+            switch(ch.unicode()) {
+            case '/':
+                if(next == QLatin1Char('*')) {
+                    m_inBoneyard = true;
+                    m_sawBoneyard = true;
+                    ++i;
+                    continue;
+                }
+                break;
+            case '\\':
+                if(next == QLatin1Char('*') || next == QLatin1Char('_') || next == QLatin1Char('\\') || next == QLatin1Char('/')) {
+                    m_text += next;
+                    ++i;
+                    continue;
+                }
+                break;
+            case '*': {
+                int runLength = 1;
+                while(i+runLength < length && raw.at(i+runLength) == QLatin1Char('*'))
+                    ++runLength;
+                m_markers.append( Marker{m_text.size(), runLength, ch, false} );
+                i += runLength-1;
+                } continue;
+            case '_':
+                m_markers.append( Marker{m_text.size(), 1, ch, false} );
+                continue;
+            default:
+                break;
+            }
+
+            m_text += ch;
+        }
+
+        this->pairMarkers();
+    }
+
+    void pairMarkers() {
+        // A marker can open emphasis if text follows it without a space, and
+        // close it if text precedes it without a space. Markers pair up with
+        // the nearest open marker of the same kind; open markers skipped over
+        // in the process stay as text.
+        m_openMarkers.clear();
+        for(int i=0; i<m_markers.size(); i++) {
+            Marker &marker = m_markers[i];
+            if(marker.length > 3)
+                continue;
+
+            const int pos = marker.position;
+            const bool canOpen = pos < m_text.size() && !m_text.at(pos).isSpace();
+            const bool canClose = pos > 0 && !m_text.at(pos-1).isSpace();
+
+            int opener = m_openMarkers.size()-1;
+            if(canClose) {
+                while(opener >= 0) {
+                    const Marker &open = m_markers.at(m_openMarkers.at(opener));
+                    if(open.character == marker.character && open.length == marker.length)
+                        break;
+                    --opener;
+                }
+            } else
+                opener = -1;
+
+            if(opener >= 0) {
+                m_markers[m_openMarkers.at(opener)].paired = true;
+                marker.paired = true;
+                m_openMarkers.resize(opener);
+            } else if(canOpen)
+                m_openMarkers.append(i);
+        }
+    }
+
+    void assemble(QString &line) const {
+        line.clear();
+        line.reserve(m_text.size() + m_markers.size());
+
+        bool pendingSpace = false;
+        auto append = [&](QChar ch) {
+            if(ch.isSpace()) {
+                pendingSpace = !line.isEmpty();
+                return;
+            }
+            if(pendingSpace) {
+                line += QLatin1Char(' ');
+                pendingSpace = false;
+            }
+            line += ch;
+        };
+
+        int markerIndex = 0;
+        for(int i=0; i<=m_text.size(); i++) {
+            for(; markerIndex < m_markers.size() && m_markers.at(markerIndex).position == i; markerIndex++) {
+                const Marker &marker = m_markers.at(markerIndex);
+                if(!marker.paired) {
+                    for(int j=0; j<marker.length; j++)
+                        append(marker.character);
+                }
+            }
+            if(i < m_text.size())
+                append(m_text.at(i));
+        }
+    }
+
+private:
+    struct Marker
+    {
+        int position;   // in m_text
+        int length;
+        QChar character;
+        bool paired;
+    };
+
+    QTextStream m_stream;
+    QString m_rawLine;
+    QString m_text;
+    bool m_inBoneyard = false;
+    bool m_sawBoneyard = false;
+    QVector<Marker> m_markers;
+    QVector<int> m_openMarkers;
+};
+
+static bool isSceneHeading(QStringView line)
+{
+    if(line.size() >= 2 && line.at(0) == QLatin1Char('.') && line.at(1) != QLatin1Char('.'))
+        return true;
+
+    // INT, EXT, EST, INT./EXT, INT/EXT and I/E
+    return line.startsWith(QLatin1String("INT")) || line.startsWith(QLatin1String("EXT")) ||
+           line.startsWith(QLatin1String("EST")) || line.startsWith(QLatin1String("I/E"));
+}
 
 FountainImporter::FountainImporter(QObject *parent)
     : AbstractImporter(parent)
@@ -39,8 +226,6 @@ bool FountainImporter::doImport(QIODevice *device)
     Scene *previousScene = nullptr;
     Scene *currentScene = nullptr;
     Character *character = nullptr;
-    static const QStringList headerhints = QStringList() <<
-            "INT" << "EXT" << "EST" << "INT./EXT" << "INT/EXT" << "I/E";
     bool inCharacter = false;
     bool hasParaBreak = false;
     bool mergeWithLastPara = false;
@@ -65,19 +250,15 @@ bool FountainImporter::doImport(QIODevice *device)
     };
 
     const QChar space(' ');
-    const QByteArray bytes = device->readAll();
-    const QRegExp multipleSpaces("\\s+");
-    const QString singleSpace(" ");
 
-    QTextStream ts(bytes);
-    ts.setCodec("utf-8");
-    ts.setAutoDetectUnicode(true);
+    // Progress is reported by how far into the file we are.
+    this->progress()->setProgressStep(1.0 / 101.0);
 
-    while(!ts.atEnd())
+    FountainLineReader reader(device);
+    QString line;
+    while(reader.readLine(line))
     {
-        QString line = ts.readLine();
-        line = line.trimmed();
-        line.replace(multipleSpaces, singleSpace);
+        this->reportReadProgress(device);
 
         if(line.isEmpty())
         {
@@ -88,7 +269,7 @@ bool FountainImporter::doImport(QIODevice *device)
             continue;
         }
 
-        if(line.startsWith("#"))
+        if(line.startsWith('#'))
         {
             line = line.remove("#").trimmed();
             line = line.split(" ", QString::SkipEmptyParts).first();
@@ -109,34 +290,8 @@ bool FountainImporter::doImport(QIODevice *device)
             line = line.mid(bcIndex+1).trimmed();
         }
 
-        // We do not support other formatting features from the fountain syntax
-        line = line.remove("_");
-        line = line.remove("*");
-        line = line.remove("^");
-
         // detect if ths line contains a header.
-        bool isHeader = false;
-        if(!inCharacter && !isHeader)
-        {
-            if(line.length() >= 2)
-            {
-                if(line.at(0) == '.' && line.at(1) != ".")
-                    isHeader = true;
-            }
-
-            if(isHeader == false)
-            {
-                Q_FOREACH(QString hint, headerhints)
-                {
-                    if(line.startsWith(hint))
-                    {
-                        isHeader = true;
-                        break;
-                    }
-                }
-            }
-        }
-
+        const bool isHeader = !inCharacter && isSceneHeading(QStringView(line));
         if(isHeader)
         {
             ++sceneCounter;
@@ -304,6 +459,14 @@ bool FountainImporter::doImport(QIODevice *device)
 
         if(!inCharacter && maybeCharacter(line))
         {
+            // A trailing caret marks the second character of dual dialogue,
+            // which we don't support.
+            if(line.endsWith('^'))
+            {
+                line.chop(1);
+                line = line.trimmed();
+            }
+
             para->setText(line);
             para->setType(SceneElement::Character);
             currentScene->addElement(para);
@@ -13,6 +13,7 @@
 
 #include "abstractdeviceio.h"
 #include "application.h"
+#include "garbagecollector.h"
 
 #include <QFile>
 
@@ -53,3 +54,80 @@ void AbstractDeviceIO::resetDocument()
 {
     this->setDocument(nullptr);
 }
+
+DeviceIOJob *AbstractDeviceIO::createJob()
+{
+    return new DeviceIOJob(m_progressReport, this);
+}
+
+bool AbstractDeviceIO::runJob(DeviceIOJob *job)
+{
+    if(job == nullptr)
+        return false;
+
+    if(m_runJobsInBackground)
+    {
+        delete m_pendingJob;
+        m_pendingJob = job;
+        return true;
+    }
+
+    const bool ret = job->run();
+    if(!ret && !job->errorMessage().isEmpty())
+        m_errorReport->setErrorMessage(job->errorMessage());
+    delete job;
+
+    return ret;
+}
+
+bool AbstractDeviceIO::startPendingJob(QIODevice *device)
+{
+    DeviceIOJob *job = m_pendingJob;
+    m_pendingJob = nullptr;
+    if(job == nullptr)
+        return false;
+
+    if(device == nullptr || m_job != nullptr)
+    {
+        delete job;
+        return false;
+    }
+
+    // The job now owns the device. It is handed over last, so that it
+    // outlives everything that writes into it.
+    job->handOver(device);
+
+    m_job = job;
+    connect(m_job, &DeviceIOJob::finished, this, &AbstractDeviceIO::onJobFinished);
+    m_job->start();
+
+    emit busyChanged();
+    return true;
+}
+
+void AbstractDeviceIO::onJobFinished(bool success)
+{
+    DeviceIOJob *job = m_job;
+    m_job = nullptr;
+    if(job == nullptr)
+        return;
+
+    const bool cancelled = job->isCancelled();
+    if(!success)
+    {
+        if(cancelled)
+            QFile::remove(m_fileName);
+        else if(!job->errorMessage().isEmpty())
+            m_errorReport->setErrorMessage(job->errorMessage());
+    }
+
+    job->deleteLater();
+
+    m_runJobsInBackground = false;
+    m_progressReport->finish();
+
+    emit busyChanged();
+    emit finished(success);
+
+    GarbageCollector::instance()->add(this);
+}
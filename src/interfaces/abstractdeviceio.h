@@ -16,6 +16,7 @@
 
 #include <QObject>
 
+#include "deviceiojob.h"
 #include "errorreport.h"
 #include "scritedocument.h"
 #include "progressreport.h"
@@ -40,6 +41,17 @@ public:
     ScriteDocument* document() const { return m_document; }
     Q_SIGNAL void documentChanged();
 
+    // True while work started in the background is being done.
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    bool isBusy() const { return m_job != nullptr; }
+    Q_SIGNAL void busyChanged();
+
+    Q_INVOKABLE void cancel() { m_progressReport->cancel(); }
+
+    // Emitted once work started in the background is done. Cancelled work
+    // does not succeed, and leaves no file behind.
+    Q_SIGNAL void finished(bool success);
+
 protected:
     AbstractDeviceIO(QObject *parent=nullptr);
     virtual QString polishFileName(const QString &fileName) const { return fileName; }
@@ -48,8 +60,24 @@ protected:
     ProgressReport *progress() const { return m_progressReport; }
     ErrorReport *error() const { return m_errorReport; }
 
+    // Subclasses hand over what is left to do, once they are done reading
+    // the document, as a job. Jobs run right away, unless the work was
+    // started in the background. Then they are kept until the file is no
+    // longer needed by anyone else, and startPendingJob() is called.
+    void setRunJobsInBackground(bool val) { m_runJobsInBackground = val; }
+    bool isRunJobsInBackground() const { return m_runJobsInBackground; }
+    DeviceIOJob *createJob();
+    bool runJob(DeviceIOJob *job);
+    bool startPendingJob(QIODevice *device);
+
+private:
+    void onJobFinished(bool success);
+
 private:
     QString m_fileName;
+    DeviceIOJob *m_job = nullptr;
+    DeviceIOJob *m_pendingJob = nullptr;
+    bool m_runJobsInBackground = false;
     ErrorReport *m_errorReport = new ErrorReport(this);
     QObjectProperty<ScriteDocument> m_document;
     ProgressReport *m_progressReport = new ProgressReport(this);
@@ -49,10 +49,23 @@ QJsonObject AbstractExporter::configurationFormInfo() const
 }
 
 bool AbstractExporter::write()
+{
+    return this->write(false);
+}
+
+bool AbstractExporter::writeInBackground()
+{
+    return this->write(true);
+}
+
+bool AbstractExporter::write(bool inBackground)
 {
     QString fileName = this->fileName();
     ScriteDocument *document = this->document();
 
+    if(this->isBusy())
+        return false;
+
     this->error()->clear();
 
     if(fileName.isEmpty())
@@ -67,8 +80,8 @@ bool AbstractExporter::write()
         return false;
     }
 
-    QFile file(fileName);
-    if( !file.open(QFile::WriteOnly) )
+    QScopedPointer<QFile> file(new QFile(fileName));
+    if( !file->open(QFile::WriteOnly) )
     {
         this->error()->setErrorMessage( QString("Could not open file '%1' for writing.").arg(fileName) );
         return false;
@@ -79,10 +92,22 @@ bool AbstractExporter::write()
     this->progress()->setProgressText( QString("Generating \"%1\"").arg(classInfo.value()));
 
     this->progress()->start();
-    const bool ret = this->doExport(&file);
+    this->setRunJobsInBackground(inBackground);
+    const bool ret = this->doExport(file.data());
+    this->setRunJobsInBackground(false);
+
+    if(this->startPendingJob(ret ? file.data() : nullptr))
+    {
+        file.take();
+        return true;
+    }
+
     this->progress()->finish();
 
     GarbageCollector::instance()->add(this);
 
+    if(inBackground)
+        emit finished(ret);
+
     return ret;
 }
@@ -59,6 +59,11 @@ public:
 
     Q_INVOKABLE bool write();
 
+    // Returns as soon as the document has been read, and leaves the rest
+    // to a worker thread. Progress is reported all along, and finished() is
+    // emitted at the end. Returns false if the export could not be started.
+    Q_INVOKABLE bool writeInBackground();
+
     Q_INVOKABLE void discard() { GarbageCollector::instance()->add(this); }
 
 protected:
@@ -69,6 +74,9 @@ protected:
         return m_languageBundleMap;
     }
 
+private:
+    bool write(bool inBackground);
+
 private:
     QMap<TransliterationEngine::Language,bool> m_languageBundleMap;
 };
@@ -66,8 +66,11 @@ bool AbstractImporter::read()
     Screenplay *screenplay = doc->screenplay();
 
     this->progress()->start();
+    m_readProgressTicks = 0;
     UndoStack::ignoreUndoCommands = true;
+    Application::instance()->beginBulkLoad();
     const bool ret = this->doImport(&file);
+    Application::instance()->endBulkLoad();
     screenplay->setCurrentElementIndex(0);
     UndoStack::ignoreUndoCommands = false;
     UndoStack::clearAllStacks();
@@ -142,3 +145,14 @@ SceneElement *AbstractImporter::addSceneElement(Scene *scene, SceneElement::Type
     scene->addElement(element);
     return element;
 }
+
+void AbstractImporter::reportReadProgress(QIODevice *device)
+{
+    const qint64 size = device->size();
+    if(size <= 0)
+        return;
+
+    const int ticks = int(qMin(device->pos(), size) * 100 / size);
+    for(; m_readProgressTicks < ticks; m_readProgressTicks++)
+        this->progress()->tick();
+}
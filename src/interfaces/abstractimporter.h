@@ -34,6 +34,14 @@ protected:
     void configureCanvas(int nrBlocks);
     Scene *createScene(const QString &heading);
     SceneElement *addSceneElement(Scene *scene, SceneElement::Type type, const QString &text);
+
+    // For importers that read the device as a stream. Progress goes up by one
+    // tick for every percent of the device read so far, so the progress step
+    // must be set to 1/101 before the first call.
+    void reportReadProgress(QIODevice *device);
+
+private:
+    int m_readProgressTicks = 0;
 };
 
 #ifdef QDOM_H
@@ -80,11 +80,22 @@ QString AbstractReportGenerator::name() const
 }
 
 bool AbstractReportGenerator::generate()
+{
+    return this->generate(false);
+}
+
+bool AbstractReportGenerator::generateInBackground()
+{
+    return this->generate(true);
+}
+
+bool AbstractReportGenerator::generate(bool inBackground)
 {
     QString fileName = this->fileName();
     ScriteDocument *document = this->document();
-    Screenplay *screenplay = document->screenplay();
-    ScreenplayFormat *format = document->printFormat();
+
+    if(this->isBusy())
+        return false;
 
     this->error()->clear();
 
@@ -100,8 +111,11 @@ bool AbstractReportGenerator::generate()
         return false;
     }
 
-    QFile file(fileName);
-    if( !file.open(QFile::WriteOnly) )
+    Screenplay *screenplay = document->screenplay();
+    ScreenplayFormat *format = document->printFormat();
+
+    QScopedPointer<QFile> file(new QFile(fileName));
+    if( !file->open(QFile::WriteOnly) )
     {
         this->error()->setErrorMessage( QString("Could not open file '%1' for writing.").arg(fileName) );
         return false;
@@ -113,7 +127,7 @@ bool AbstractReportGenerator::generate()
         {
             this->progress()->start();
 
-            QPdfWriter pdfWriter(&file);
+            QPdfWriter pdfWriter(file.data());
             pdfWriter.setTitle("Scrite Character Report");
             pdfWriter.setCreator(qApp->applicationName() + " " + qApp->applicationVersion());
             pdfWriter.setPageSize(QPageSize(QPageSize::Letter));
@@ -125,6 +139,9 @@ bool AbstractReportGenerator::generate()
 
             GarbageCollector::instance()->add(this);
 
+            if(inBackground)
+                emit finished(success);
+
             return success;
         }
     }
@@ -148,43 +165,106 @@ bool AbstractReportGenerator::generate()
     this->progress()->setProgressText( QString("Generating \"%1\"").arg(classInfo.value()));
 
     this->progress()->start();
-    const bool ret = this->doGenerate(&textDocument);
+    bool ret = this->doGenerate(&textDocument);
 
-    if(!ret)
+    if(ret)
     {
-        this->progress()->finish();
-        return ret;
-    }
+        // Laying out and writing the report does not need the document, so
+        // it can be done on a worker thread. Such a thread rebuilds the report
+        // from a snapshot, the text document here goes away with this function.
+        this->setRunJobsInBackground(inBackground);
+
+        QTextDocumentSnapshot snapshot;
+        QTextDocument *reportDocument = &textDocument;
+        if(inBackground)
+        {
+            snapshot = QTextDocumentSnapshot(&textDocument);
+            reportDocument = nullptr;
+        }
 
-    if(m_format == OpenDocumentFormat)
-    {
-        QTextDocumentWriter writer;
-        writer.setFormat("ODF");
-        writer.setDevice(&file);
-        this->configureWriter(&writer, &textDocument);
-        writer.write(&textDocument);
-    }
-    else
-    {
-        QPdfWriter pdfWriter(&file);
-        pdfWriter.setTitle("Scrite Character Report");
-        pdfWriter.setCreator(qApp->applicationName() + " " + qApp->applicationVersion());
-        pdfWriter.setPageSize(QPageSize(QPageSize::Letter));
-        pdfWriter.setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
-        this->configureWriter(&pdfWriter, &textDocument);
-
-        QTextDocumentPagedPrinter printer;
-        printer.header()->setVisibleFromPageOne(true);
-        printer.footer()->setVisibleFromPageOne(true);
-        printer.watermark()->setVisibleFromPageOne(true);
-        this->configureTextDocumentPrinter(&printer, &textDocument);
-        printer.print(&textDocument, &pdfWriter);
+        const QString reportTitle = QString::fromLatin1(classInfo.value());
+
+        QFile *device = file.data();
+
+        DeviceIOJob *job = this->createJob();
+
+        if(m_format == OpenDocumentFormat)
+        {
+            job->setFunction([=](DeviceIOJob *job) {
+                QScopedPointer<QTextDocument> snapshotDocument(snapshot.create());
+                QTextDocument *document = snapshotDocument.isNull() ? reportDocument : snapshotDocument.data();
+
+                QTextDocumentWriter writer;
+                writer.setFormat("ODF");
+                writer.setDevice(device);
+                this->configureWriter(&writer, document);
+
+                job->reportProgress(0, 1, QString("Writing \"%1\"").arg(reportTitle));
+                if(!writer.write(document))
+                {
+                    job->setErrorMessage("Could not write the report.");
+                    return false;
+                }
+
+                return true;
+            });
+        }
+        else
+        {
+            QPdfWriter *pdfWriter = new QPdfWriter(device);
+            pdfWriter->setTitle("Scrite Character Report");
+            pdfWriter->setCreator(qApp->applicationName() + " " + qApp->applicationVersion());
+            pdfWriter->setPageSize(QPageSize(QPageSize::Letter));
+            pdfWriter->setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
+
+            QTextDocumentPagedPrinter *printer = new QTextDocumentPagedPrinter;
+            printer->header()->setVisibleFromPageOne(true);
+            printer->footer()->setVisibleFromPageOne(true);
+            printer->watermark()->setVisibleFromPageOne(true);
+            this->configureTextDocumentPrinter(printer, &textDocument);
+
+            job->handOver(printer);
+            job->handOver(pdfWriter);
+            job->setFunction([=](DeviceIOJob *job) {
+                QScopedPointer<QTextDocument> snapshotDocument(snapshot.create());
+                QTextDocument *document = snapshotDocument.isNull() ? reportDocument : snapshotDocument.data();
+
+                // Page size depends on how wide the report turns out to be.
+                this->configureWriter(pdfWriter, document);
+
+                printer->setPageFunction([=](int pageNr, int pageCount) {
+                    job->reportProgress(pageNr, pageCount, QString("Printing page %1 of %2").arg(pageNr).arg(pageCount));
+                    return !job->isCancelled();
+                });
+
+                if(!printer->print(document, pdfWriter))
+                {
+                    if(!job->isCancelled())
+                        job->setErrorMessage("Could not print the report.");
+                    return false;
+                }
+
+                return true;
+            });
+        }
+
+        ret = this->runJob(job);
+        this->setRunJobsInBackground(false);
+
+        if(ret && this->startPendingJob(file.data()))
+        {
+            file.take();
+            return true;
+        }
     }
 
     this->progress()->finish();
 
     GarbageCollector::instance()->add(this);
 
+    if(inBackground)
+        emit finished(ret);
+
     return ret;
 }
 
@@ -72,6 +72,10 @@ public:
     Q_INVOKABLE QJsonObject configurationFormInfo() const;
 
     Q_INVOKABLE bool generate();
+
+    // Lays out and writes the report on a worker thread, once it has been
+    // put together from the document. See AbstractExporter::writeInBackground().
+    Q_INVOKABLE bool generateInBackground();
     Q_INVOKABLE void discard() { GarbageCollector::instance()->add(this); }
 
 protected:
@@ -81,6 +85,10 @@ protected:
 protected:
     AbstractReportGenerator(QObject *parent=nullptr);
     virtual bool doGenerate(QTextDocument *) { return false; }
+
+    // configureWriter() is called from the thread that writes the report,
+    // which may not be the one this object lives on. Implementations should
+    // look at nothing but their arguments.
     virtual void configureWriter(QTextDocumentWriter *, const QTextDocument *) const { }
     virtual void configureWriter(QPdfWriter *, const QTextDocument *) const { }
     virtual void configureTextDocumentPrinter(QTextDocumentPagedPrinter *, const QTextDocument *) { }
@@ -88,6 +96,9 @@ protected:
     virtual bool canDirectPrintToPdf() const { return false; }
     virtual bool directPrintToPdf(QPdfWriter *) { return false; }
 
+private:
+    bool generate(bool inBackground);
+
 private:
     Format m_format = AdobePDF;
     QString m_comment;
@@ -57,6 +57,35 @@ void AbstractTextDocumentExporter::generate(QTextDocument *textDoc, const qreal
     Q_UNUSED(pageWidth)
 
     ScreenplayTextDocument stDoc;
+    this->prepare(stDoc);
+    stDoc.setTextDocument(textDoc);
+    stDoc.syncNow();
+}
+
+QTextDocument *AbstractTextDocumentExporter::generatePaginated()
+{
+    ScreenplayTextDocument stDoc;
+    this->prepare(stDoc);
+
+    PaginationCache *cache = PaginationCache::instance();
+    QTextDocument *textDoc = cache->find(stDoc.paginationKey());
+    if(textDoc != nullptr)
+        return textDoc;
+
+    textDoc = new QTextDocument;
+    stDoc.setTextDocument(textDoc);
+    stDoc.syncNow();
+    cache->adopt(stDoc.paginationKey(), textDoc);
+    return textDoc;
+}
+
+bool AbstractTextDocumentExporter::filterSceneElement() const
+{
+    return !m_includeSceneContents;
+}
+
+void AbstractTextDocumentExporter::prepare(ScreenplayTextDocument &stDoc)
+{
     stDoc.setTitlePage(this->generateTitlePage());
     stDoc.setSceneNumbers(this->isIncludeSceneNumbers());
     stDoc.setSceneIcons(this->isIncludeSceneIcons());
@@ -71,13 +100,5 @@ void AbstractTextDocumentExporter::generate(QTextDocument *textDoc, const qreal
     stDoc.setScreenplay(this->document()->screenplay());
     stDoc.setFormatting(this->document()->printFormat());
     stDoc.setTitlePageIsCentered(this->document()->screenplay()->isTitlePageIsCentered());
-    stDoc.setTextDocument(textDoc);
     stDoc.setInjection(this);
-    stDoc.syncNow();
 }
-
-bool AbstractTextDocumentExporter::filterSceneElement() const
-{
-    return !m_includeSceneContents;
-}
-
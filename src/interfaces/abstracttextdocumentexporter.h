@@ -59,8 +59,18 @@ protected:
     AbstractTextDocumentExporter(QObject *parent=nullptr);
     void generate(QTextDocument *textDocument, const qreal pageWidth);
 
+    // Returns a document laid out for the current options. It comes from
+    // PaginationCache if the print preview, or an earlier export, has laid
+    // out the same screenplay with the same options already. The document
+    // belongs to the cache, it must be used right away and not modified.
+    QTextDocument *generatePaginated();
+
     // AbstractScreenplayTextDocumentInjectionInterface interface
     bool filterSceneElement() const;
+    bool isFilterOnly() const { return true; }
+
+private:
+    void prepare(ScreenplayTextDocument &stDoc);
 
 private:
     bool m_listSceneCharacters = false;
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "deviceiojob.h"
+#include "progressreport.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+DeviceIOJob::DeviceIOJob(ProgressReport *progress, QObject *parent)
+    : QObject(parent),
+      m_progress(progress)
+{
+    if(progress != nullptr)
+    {
+        connect(progress, &ProgressReport::cancelledChanged, this, [=]() {
+            if(!m_progress.isNull() && m_progress->isCancelled())
+                this->cancel();
+        });
+    }
+
+    connect(&m_watcher, &QFutureWatcher<bool>::finished, this, &DeviceIOJob::onFutureFinished);
+}
+
+DeviceIOJob::~DeviceIOJob()
+{
+    // The function may still be using objects handed over to it.
+    if(m_watcher.isRunning())
+    {
+        this->cancel();
+        m_watcher.waitForFinished();
+    }
+
+    this->deleteHandedOverObjects();
+}
+
+void DeviceIOJob::handOver(QObject *object)
+{
+    if(object != nullptr && !m_objects.contains(object))
+        m_objects.append(object);
+}
+
+bool DeviceIOJob::run()
+{
+    const bool ret = m_function ? m_function(this) : false;
+    this->deleteHandedOverObjects();
+    return ret;
+}
+
+void DeviceIOJob::start()
+{
+    if(m_watcher.isRunning())
+        return;
+
+    if(!m_function)
+    {
+        emit finished(false);
+        return;
+    }
+
+    const Function function = m_function;
+    m_watcher.setFuture( QtConcurrent::run([=]() { return function(this); }) );
+}
+
+void DeviceIOJob::reportProgress(int done, int total, const QString &text)
+{
+    const qreal value = total > 0 ? qreal(done)/qreal(total) : 0;
+    auto update = [=]() {
+        if(m_progress.isNull())
+            return;
+        m_progress->setProgressText(text);
+        m_progress->setProgress(value);
+    };
+
+    if(QThread::currentThread() == this->thread())
+        update();
+    else
+        QMetaObject::invokeMethod(this, update, Qt::QueuedConnection);
+}
+
+void DeviceIOJob::onFutureFinished()
+{
+    const bool ret = m_watcher.future().resultCount() > 0 ? m_watcher.result() : false;
+    this->deleteHandedOverObjects();
+    emit finished(ret);
+}
+
+void DeviceIOJob::deleteHandedOverObjects()
+{
+    const QList<QObject*> objects = m_objects;
+    m_objects.clear();
+    for(QObject *object : objects)
+        delete object;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef DEVICEIOJOB_H
+#define DEVICEIOJOB_H
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+
+#include <functional>
+
+class ProgressReport;
+
+/**
+ * What is left of an export or a report once everything it needs has been
+ * read from the document. Mostly that is laying out a QTextDocument and
+ * writing it into a file, which is where large screenplays and reports
+ * spend most of their time.
+ *
+ * The function runs right away when the job is run, or on a worker thread
+ * when the job is started. It must not touch the document, or any other
+ * object that is in use elsewhere. Objects it needs are created on the
+ * thread that creates the job and handed over to it. They are deleted on
+ * that thread, in the order they were handed over, once the function has
+ * returned.
+ *
+ * Text documents are the exception. They start laying themselves out on the
+ * thread they are created on, so the function builds its own copy from a
+ * QTextDocumentSnapshot, and deletes it before returning.
+ *
+ * Progress reported by the function is delivered to the ProgressReport on
+ * the thread that created the job.
+ */
+class DeviceIOJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<bool(DeviceIOJob *job)> Function;
+
+    DeviceIOJob(ProgressReport *progress, QObject *parent=nullptr);
+    ~DeviceIOJob();
+
+    void setFunction(const Function &function) { m_function = function; }
+    void handOver(QObject *object);
+
+    bool run();
+    void start();
+    bool isRunning() const { return m_watcher.isRunning(); }
+
+    // These can be called from the function, on whichever thread it runs.
+    void reportProgress(int done, int total, const QString &text);
+    void setErrorMessage(const QString &val) { m_errorMessage = val; }
+    bool isCancelled() const { return m_cancelled.loadAcquire() != 0; }
+
+    void cancel() { m_cancelled.storeRelease(1); }
+    QString errorMessage() const { return m_errorMessage; }
+
+    Q_SIGNAL void finished(bool success);
+
+private:
+    void onFutureFinished();
+    void deleteHandedOverObjects();
+
+private:
+    Function m_function;
+    QString m_errorMessage;
+    QAtomicInt m_cancelled;
+    QList<QObject*> m_objects;
+    QFutureWatcher<bool> m_watcher;
+    QPointer<ProgressReport> m_progress;
+};
+
+#endif // DEVICEIOJOB_H
@@ -15,12 +15,14 @@
 
 #include <QDir>
 #include <QtDebug>
+#include <QPainter>
 #include <QDateTime>
 #include <QQmlEngine>
+#include <QTimerEvent>
 #include <QPainterPath>
 #include <QPaintEngine>
 
-class ImagePrinterImageProvider : public QObject, public QQuickImageProvider
+class ImagePrinterImageProvider : public QObject, public QQuickAsyncImageProvider
 {
 public:
     ImagePrinterImageProvider();
@@ -32,13 +34,32 @@ public:
     void remove(ImagePrinter *printer);
     ImagePrinter *find(const QString &name);
 
-    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize);
 
 private:
     QReadWriteLock m_printersLock;
     QSet<ImagePrinter*> m_printers;
 };
 
+class ImagePrinterImageResponse : public QQuickImageResponse
+{
+public:
+    ImagePrinterImageResponse(ImagePrinter *printer, int index, const QSize &requestedSize);
+    ~ImagePrinterImageResponse();
+
+    QQuickTextureFactory *textureFactory() const;
+
+private:
+    void finish(const QImage &image);
+
+private:
+    int m_index = -1;
+    bool m_finished = false;
+    char m_padding[3];
+    QImage m_image;
+    QSize m_requestedSize;
+};
+
 class ImagePrinterEngine : public QPaintEngine
 {
 public:
@@ -114,7 +135,8 @@ private:
 // call the non-depricated constructor. So, we will have to suck
 // up this compiler warning for now.
 ImagePrinter::ImagePrinter(QObject *parent)
-    : QAbstractListModel(parent)
+    : QAbstractListModel(parent),
+      m_repaginateTimer("ImagePrinter.m_repaginateTimer")
 {    
     this->setPageSize(Letter);
     this->setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
@@ -127,7 +149,8 @@ ImagePrinter::~ImagePrinter()
 {
     emit aboutToDelete(this);
 
-    m_pageImages.clear();
+    this->discardPagePrinter();
+    m_pageCache.clear();
     emit pagesChanged();
 
     if(m_engine)
@@ -164,11 +187,13 @@ void ImagePrinter::setScale(qreal val)
 
 QImage ImagePrinter::pageImageAt(int index)
 {
-    if(index < 0 || index >= m_pageImages.size())
-        return QImage();
+    const QImage ret = m_pageCache.at(index);
+
+    // This is called from image provider threads, QML must hear about it
+    // from the UI thread.
+    QMetaObject::invokeMethod(this, "cacheStatisticsChanged", Qt::QueuedConnection);
 
-    QReadLocker lock(&m_pageImagesLock);
-    return m_pageImages.at(index);
+    return ret;
 }
 
 QString ImagePrinter::pageUrl(int index) const
@@ -184,9 +209,73 @@ void ImagePrinter::clear()
     if(m_printing)
         return;
 
+    this->discardPagePrinter();
+
     this->beginResetModel();
-    m_pageImages.clear();
+    m_pageCache.clear();
     this->endResetModel();
+
+    emit cacheStatisticsChanged();
+}
+
+void ImagePrinter::setRenderOnDemand(bool val)
+{
+    if(m_renderOnDemand == val)
+        return;
+
+    m_renderOnDemand = val;
+    emit renderOnDemandChanged();
+}
+
+bool ImagePrinter::paginate(QTextDocument *document, QTextDocumentPagedPrinter *printer)
+{
+    if(printer == nullptr)
+        return false;
+
+    if(document == nullptr || m_printing)
+    {
+        delete printer;
+        return false;
+    }
+
+    this->discardPagePrinter();
+
+    printer->setParent(this);
+    m_pagePrinter = printer;
+    m_pagedDocument = document;
+
+    if(m_renderOnDemand)
+        connect(document, &QTextDocument::contentsChanged, this, &ImagePrinter::onPagedDocumentChanged);
+
+    this->repaginate();
+
+    // All pages have been painted already, nothing more is needed from the
+    // document.
+    if(!m_renderOnDemand)
+        this->discardPagePrinter();
+
+    return m_pageCache.count() > 0;
+}
+
+void ImagePrinter::requestPageImage(int index)
+{
+    QImage image = m_pageCache.at(index);
+    if(image.isNull())
+        image = this->renderPage(index);
+
+    emit pageImageReady(index, image);
+    emit cacheStatisticsChanged();
+}
+
+void ImagePrinter::setCacheMemoryLimit(int val)
+{
+    val = qMax(val, 1);
+    if(this->cacheMemoryLimit() == val)
+        return;
+
+    m_pageCache.setMemoryLimit(qint64(val)*1024*1024);
+    emit cacheMemoryLimitChanged();
+    emit cacheStatisticsChanged();
 }
 
 void ImagePrinter::setPrinting(bool val)
@@ -203,12 +292,12 @@ void ImagePrinter::setPrinting(bool val)
 
 int ImagePrinter::rowCount(const QModelIndex &parent) const
 {
-    return parent.isValid() ? 0 : m_pageImages.size();
+    return parent.isValid() ? 0 : m_pageCache.count();
 }
 
 QVariant ImagePrinter::data(const QModelIndex &index, int role) const
 {
-    if(index.row() < 0 || index.row() >= m_pageImages.size())
+    if(index.row() < 0 || index.row() >= m_pageCache.count())
         return QVariant();
 
     switch(role)
@@ -336,17 +425,25 @@ void ImagePrinter::componentComplete()
         this->setObjectName( QStringLiteral("imagePrinter") );
 }
 
+void ImagePrinter::timerEvent(QTimerEvent *event)
+{
+    if(event->timerId() == m_repaginateTimer.timerId())
+        this->repaginate();
+    else
+        QAbstractListModel::timerEvent(event);
+}
+
 void ImagePrinter::begin()
 {
+    this->discardPagePrinter();
+
     this->setPrinting(true);
     this->beginResetModel();
 
-    m_templatePageImage = QImage(10, 10, QImage::Format_ARGB32);
-    const int resolution = qMax( this->metric(PdmDpiX), this->metric(PdmDpiY) );
-    m_pageSize = this->pageLayout().pageSize().sizePixels(resolution);
-
-    m_templatePageImage = QImage(m_pageSize.width(), m_pageSize.height(), QImage::Format_ARGB32);
-    m_pageImages.clear();
+    this->evaluatePageSize();
+    m_pageCache.clear();
+    m_pageCache.resetStatistics();
+    m_renderedPageCount = 0;
 }
 
 void ImagePrinter::end()
@@ -357,6 +454,7 @@ void ImagePrinter::end()
     this->endResetModel();
 
     emit pagesChanged();
+    emit cacheStatisticsChanged();
 
     this->setPrinting(false);
 }
@@ -366,14 +464,137 @@ void ImagePrinter::capturePrintedPageImage()
     if(m_engine == nullptr)
         return;
 
-    QWriteLocker lock(&m_pageImagesLock);
-    m_pageImages << m_engine->printedPageImage();
+    m_pageCache.append(m_engine->printedPageImage());
+    ++m_renderedPageCount;
+}
+
+void ImagePrinter::evaluatePageSize()
+{
+    m_templatePageImage = QImage(10, 10, QImage::Format_ARGB32);
+    const int resolution = qMax( this->metric(PdmDpiX), this->metric(PdmDpiY) );
+    m_pageSize = this->pageLayout().pageSize().sizePixels(resolution);
+
+    m_templatePageImage = QImage(m_pageSize.width(), m_pageSize.height(), QImage::Format_ARGB32);
+}
+
+QImage ImagePrinter::renderPage(int index)
+{
+    if(m_pagePrinter == nullptr || m_pagedDocument.isNull() || m_printing)
+        return QImage();
+
+    if(index < 0 || index >= m_pagePrinter->pageCount())
+        return QImage();
+
+    // Same page image that ImagePrinterEngine would have produced for this
+    // page, had the whole document been printed.
+    const QSize pageImageSize = m_pageSize*m_scale;
+    QImage image(pageImageSize, QImage::Format_ARGB32);
+    image.setDevicePixelRatio(m_scale);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    m_pagePrinter->printPage(index+1, &painter);
+    painter.end();
+
+    m_pageCache.set(index, image);
+    ++m_renderedPageCount;
+
+    return image;
+}
+
+void ImagePrinter::renderAllPages()
+{
+    const QString directory = this->createPageImageDirectory();
+    const QString baseFileName = this->objectName();
+    const QByteArray fileFormat = m_imageFormat == PNG ? QByteArrayLiteral("PNG") : QByteArrayLiteral("JPG");
+
+    // Pages are painted and saved on many threads at once.
+    QAtomicInt renderedPageCount;
+    m_pagePrinter->printPageImages(m_scale, [&](int pageNr, const QImage &image) {
+        m_pageCache.set(pageNr-1, image);
+        if(!directory.isEmpty())
+            image.save(QDir(directory).absoluteFilePath(baseFileName + QString::number(pageNr) + "." + fileFormat), fileFormat);
+        renderedPageCount.ref();
+    });
+
+    m_renderedPageCount = renderedPageCount.load();
+}
+
+QString ImagePrinter::createPageImageDirectory() const
+{
+    if(m_directory.isEmpty())
+        return QString();
+
+    QDir().mkpath(m_directory);
+
+    // Pages from a previous print are not overwritten.
+    QDir dir(m_directory);
+    QFileInfoList entryInfoList = dir.entryInfoList(QDir::Files, QDir::Name);
+    if(!entryInfoList.isEmpty())
+    {
+        const QString subDirectory = QString::number( QDateTime::currentSecsSinceEpoch() );
+        dir.mkdir(subDirectory);
+        dir.cd(subDirectory);
+    }
+
+    return dir.absolutePath();
+}
+
+void ImagePrinter::repaginate()
+{
+    m_repaginateTimer.stop();
+
+    this->setPrinting(true);
+    this->beginResetModel();
+
+    this->evaluatePageSize();
+    m_pageCache.clear();
+    m_pageCache.resetStatistics();
+    m_renderedPageCount = 0;
+
+    if(m_pagePrinter != nullptr && !m_pagedDocument.isNull() && m_pagePrinter->begin(m_pagedDocument, this))
+    {
+        m_pageCache.resize(m_pagePrinter->pageCount());
+        if(!m_renderOnDemand)
+            this->renderAllPages();
+    }
+
+    this->endResetModel();
+
+    emit pagesChanged();
+    emit cacheStatisticsChanged();
+
+    // Page URLs change when printing is done, so that pages from a previous
+    // pagination are not picked up from QML's image cache.
+    this->setPrinting(false);
+}
+
+void ImagePrinter::discardPagePrinter()
+{
+    m_repaginateTimer.stop();
+
+    if(!m_pagedDocument.isNull())
+        disconnect(m_pagedDocument, nullptr, this, nullptr);
+    m_pagedDocument = nullptr;
+
+    if(m_pagePrinter != nullptr)
+    {
+        m_pagePrinter->end();
+        delete m_pagePrinter;
+        m_pagePrinter = nullptr;
+    }
+}
+
+void ImagePrinter::onPagedDocumentChanged()
+{
+    // Pages painted from here on must agree with each other, so the whole
+    // document is paginated again once changes settle down.
+    m_repaginateTimer.start(500, this);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 ImagePrinterImageProvider::ImagePrinterImageProvider()
-    : QQuickImageProvider(Image, ForceAsynchronousImageLoading)
 {
 
 }
@@ -420,37 +641,75 @@ ImagePrinter *ImagePrinterImageProvider::find(const QString &name)
     return nullptr;
 }
 
-QImage ImagePrinterImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+QQuickImageResponse *ImagePrinterImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
 {
-    QImage ret;
-    if(size)
-        *size = ret.size();
+    ImagePrinter *printer = nullptr;
+    int index = -1;
 
-    QStringList comps = id.split("/");
-    if(comps.size() < 2)
-        return ret;
+    const QStringList comps = id.split("/");
+    if(comps.size() >= 2)
+    {
+        printer = this->find(comps.first());
 
-    ImagePrinter *printer = this->find(comps.first());
-    if(printer == nullptr)
-        return ret;
+        bool ok = false;
+        index = comps.last().toInt(&ok);
+        if(!ok)
+            index = -1;
+    }
 
-    bool ok = false;
-    const int index = comps.last().toInt(&ok);
-    if(!ok)
-        return ret;
+    return new ImagePrinterImageResponse(printer, index, requestedSize);
+}
 
-    ret = printer->pageImageAt(index);
+///////////////////////////////////////////////////////////////////////////////
 
-    if(!ret.isNull())
-    {
-        if(size)
-            *size = ret.size();
+ImagePrinterImageResponse::ImagePrinterImageResponse(ImagePrinter *printer, int index, const QSize &requestedSize)
+    : m_index(index), m_requestedSize(requestedSize)
+{
+    m_padding[0] = 0;
 
-        if(requestedSize.isValid())
-            ret = ret.scaled(requestedSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    // QQuickImageResponse::finished() must not be emitted before this
+    // response is handed over to QML, so even readily available images are
+    // delivered from the event loop.
+    QImage image = printer == nullptr || index < 0 ? QImage() : printer->pageImageAt(index);
+    if(printer == nullptr || index < 0 || !image.isNull())
+    {
+        QMetaObject::invokeMethod(this, [=]() { this->finish(image); }, Qt::QueuedConnection);
+        return;
     }
 
-    return ret;
+    // Pages that are yet to be painted can only be painted on the printer's
+    // thread, because that is where the document lives.
+    connect(printer, &ImagePrinter::pageImageReady, this, [=](int pageIndex, const QImage &pageImage) {
+        if(pageIndex == m_index)
+            this->finish(pageImage);
+    });
+    connect(printer, &ImagePrinter::aboutToDelete, this, [=]() {
+        this->finish(QImage());
+    });
+    QMetaObject::invokeMethod(printer, "requestPageImage", Qt::QueuedConnection, Q_ARG(int,index));
+}
+
+ImagePrinterImageResponse::~ImagePrinterImageResponse()
+{
+
+}
+
+QQuickTextureFactory *ImagePrinterImageResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+void ImagePrinterImageResponse::finish(const QImage &image)
+{
+    if(m_finished)
+        return;
+
+    m_finished = true;
+    m_image = image;
+    if(!m_image.isNull() && m_requestedSize.isValid())
+        m_image = m_image.scaled(m_requestedSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    emit finished();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -503,7 +762,7 @@ bool ImagePrinterEngine::begin(QPaintDevice *pdev)
 
     const QPageLayout pageLayout = m_currentDevice->pageLayout();
 
-    m_directory = printToImage->directory();
+    m_directory = printToImage->createPageImageDirectory();
     m_pageSize = QSize(printToImage->width(), printToImage->height());
     m_pageScale = printToImage->scale();
     m_pageColor = Qt::white;
@@ -512,20 +771,8 @@ bool ImagePrinterEngine::begin(QPaintDevice *pdev)
 
     if(!m_directory.isEmpty())
     {
-        QDir().mkpath(m_directory);
-
         m_baseFileName = printToImage->objectName();
         m_fileFormat = printToImage->imageFormat() == ImagePrinter::PNG ? QByteArrayLiteral("PNG") : QByteArrayLiteral("JPG");
-
-        QDir dir(m_directory);
-        QFileInfoList entryInfoList = dir.entryInfoList(QDir::Files, QDir::Name);
-        if(!entryInfoList.isEmpty())
-        {
-            const QString subDirectory = QString::number( QDateTime::currentSecsSinceEpoch() );
-            dir.mkdir(subDirectory);
-            dir.cd(subDirectory);
-            m_directory = dir.absolutePath();
-        }
     }
 
     const QSize pageImageSize = m_pageSize*m_pageScale;
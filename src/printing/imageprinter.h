@@ -15,12 +15,15 @@
 #define PRINTTOIMAGE_H
 
 #include <QObject>
+#include <QPointer>
 #include <QReadWriteLock>
 #include <QQmlParserStatus>
 #include <QPagedPaintDevice>
 #include <QQuickImageProvider>
 
 #include "modifiable.h"
+#include "execlatertimer.h"
+#include "pageimagecache.h"
 #include "qtextdocumentpagedprinter.h"
 
 class ImagePrinterEngine;
@@ -55,7 +58,7 @@ public:
     Q_SIGNAL void scaleChanged();
 
     Q_PROPERTY(int pageCount READ pageCount NOTIFY pagesChanged)
-    int pageCount() const { return m_pageImages.size(); }
+    int pageCount() const { return m_pageCache.count(); }
     Q_SIGNAL void pagesChanged();
 
     Q_PROPERTY(qreal pageWidth READ pageWidth NOTIFY pagesChanged)
@@ -69,6 +72,49 @@ public:
 
     Q_INVOKABLE void clear();
 
+    // When set, documents printed by ScreenplayTextDocument are only paginated
+    // up front. Each page is painted the first time the image provider asks
+    // for it, so the preview can show up before all pages are painted.
+    Q_PROPERTY(bool renderOnDemand READ isRenderOnDemand WRITE setRenderOnDemand NOTIFY renderOnDemandChanged)
+    void setRenderOnDemand(bool val);
+    bool isRenderOnDemand() const { return m_renderOnDemand; }
+    Q_SIGNAL void renderOnDemandChanged();
+
+    // Paginates document using printer and takes ownership of printer. With
+    // renderOnDemand, no page is painted yet and pages are painted again,
+    // from a fresh pagination, if the document changes afterwards. Otherwise
+    // all pages are painted right away, on as many threads as there are
+    // cores, and saved into directory if one is set.
+    bool paginate(QTextDocument *document, QTextDocumentPagedPrinter *printer);
+
+    // Looks up, or paints, the page image on the thread this printer belongs
+    // to and hands it over through pageImageReady().
+    Q_INVOKABLE void requestPageImage(int index);
+    Q_SIGNAL void pageImageReady(int index, const QImage &image);
+
+    // Pages beyond this many megabytes are kept on disk until they are asked for.
+    Q_PROPERTY(int cacheMemoryLimit READ cacheMemoryLimit WRITE setCacheMemoryLimit NOTIFY cacheMemoryLimitChanged)
+    void setCacheMemoryLimit(int val);
+    int cacheMemoryLimit() const { return int(m_pageCache.memoryLimit()/(1024*1024)); }
+    Q_SIGNAL void cacheMemoryLimitChanged();
+
+    Q_PROPERTY(int cacheMemoryUsage READ cacheMemoryUsage NOTIFY cacheStatisticsChanged)
+    int cacheMemoryUsage() const { return int(m_pageCache.memoryUsage()/(1024*1024)); }
+
+    Q_PROPERTY(int cacheHits READ cacheHits NOTIFY cacheStatisticsChanged)
+    int cacheHits() const { return m_pageCache.hitCount(); }
+
+    Q_PROPERTY(int cacheMisses READ cacheMisses NOTIFY cacheStatisticsChanged)
+    int cacheMisses() const { return m_pageCache.missCount(); }
+
+    Q_PROPERTY(int cacheSpills READ cacheSpills NOTIFY cacheStatisticsChanged)
+    int cacheSpills() const { return m_pageCache.spillCount(); }
+
+    Q_PROPERTY(int renderedPageCount READ renderedPageCount NOTIFY cacheStatisticsChanged)
+    int renderedPageCount() const { return m_renderedPageCount; }
+
+    Q_SIGNAL void cacheStatisticsChanged();
+
     Q_PROPERTY(bool printing READ isPrinting WRITE setPrinting NOTIFY printingChanged)
     void setPrinting(bool val);
     bool isPrinting() const { return m_printing; }
@@ -103,10 +149,20 @@ protected:
     void classBegin();
     void componentComplete();
 
+    // QObject interface
+    void timerEvent(QTimerEvent *event);
+
 private:
     void begin();
     void end();
     void capturePrintedPageImage();
+    void evaluatePageSize();
+    QImage renderPage(int index);
+    void renderAllPages();
+    QString createPageImageDirectory() const;
+    void repaginate();
+    void discardPagePrinter();
+    void onPagedDocumentChanged();
 
 private:
     friend class ImagePrinterEngine;
@@ -115,8 +171,12 @@ private:
     QSize m_pageSize;
     QString m_directory;
     ImageFormat m_imageFormat = PNG;
-    QList<QImage> m_pageImages;
-    QReadWriteLock m_pageImagesLock;
+    PageImageCache m_pageCache;
+    bool m_renderOnDemand = false;
+    int m_renderedPageCount = 0;
+    QPointer<QTextDocument> m_pagedDocument;
+    QTextDocumentPagedPrinter *m_pagePrinter = nullptr;
+    ExecLaterTimer m_repaginateTimer;
     mutable QImage m_templatePageImage;
     mutable ImagePrinterEngine *m_engine = nullptr;
 };
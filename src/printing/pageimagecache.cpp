@@ -0,0 +1,300 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "pageimagecache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QVector>
+#include <QImageReader>
+#include <QImageWriter>
+
+PageImageCache::PageImageCache()
+{
+
+}
+
+PageImageCache::~PageImageCache()
+{
+
+}
+
+void PageImageCache::setMemoryLimit(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_memoryLimit = qMax(bytes, qint64(0));
+    this->evict(locker);
+}
+
+qint64 PageImageCache::memoryLimit() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryLimit;
+}
+
+qint64 PageImageCache::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryUsage;
+}
+
+int PageImageCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_count;
+}
+
+void PageImageCache::append(const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    const int index = m_count++;
+    this->insert(index, image);
+    this->evict(locker);
+}
+
+QImage PageImageCache::at(int index)
+{
+    QMutexLocker locker(&m_mutex);
+    if(index < 0 || index >= m_count)
+        return QImage();
+
+    auto it = m_images.find(index);
+    if(it != m_images.end())
+    {
+        ++m_hitCount;
+        m_recentlyUsed.removeOne(index);
+        m_recentlyUsed.append(index);
+        return it.value();
+    }
+
+    // Still in memory, while on its way to the disk.
+    auto it2 = m_spilling.find(index);
+    if(it2 != m_spilling.end())
+    {
+        ++m_hitCount;
+        return it2.value();
+    }
+
+    const QString filePath = m_spillFiles.value(index);
+    if(filePath.isEmpty())
+        return QImage();
+
+    ++m_missCount;
+    locker.unlock();
+
+    QImageReader reader(filePath);
+    QImage image = reader.read();
+    if(image.isNull())
+        return image;
+
+    // Device pixel ratio is not saved in image files by itself.
+    const qreal dpr = reader.text(QStringLiteral("devicePixelRatio")).toDouble();
+    if(dpr > 0)
+        image.setDevicePixelRatio(dpr);
+
+    locker.relock();
+
+    // The page may have been replaced, or thrown out, while we were reading it.
+    if(m_spillFiles.value(index) == filePath && !m_images.contains(index))
+    {
+        this->insert(index, image);
+        this->evict(locker);
+    }
+
+    return image;
+}
+
+void PageImageCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_count = 0;
+    m_memoryUsage = 0;
+    m_images.clear();
+    m_recentlyUsed.clear();
+    m_spilling.clear();
+    m_spillFiles.clear();
+    m_spillDirectory.reset();
+}
+
+void PageImageCache::resize(int count)
+{
+    QMutexLocker locker(&m_mutex);
+    count = qMax(count, 0);
+    while(m_count > count)
+        this->forget(--m_count);
+
+    m_count = count;
+}
+
+void PageImageCache::set(int index, const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    if(index < 0 || index >= m_count)
+        return;
+
+    this->forget(index);
+    this->insert(index, image);
+    this->evict(locker);
+}
+
+int PageImageCache::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hitCount;
+}
+
+int PageImageCache::missCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_missCount;
+}
+
+int PageImageCache::spillCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_spillCount;
+}
+
+void PageImageCache::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hitCount = 0;
+    m_missCount = 0;
+    m_spillCount = 0;
+}
+
+void PageImageCache::insert(int index, const QImage &image)
+{
+    // Must be called with m_mutex locked.
+    m_images.insert(index, image);
+    m_recentlyUsed.append(index);
+    m_memoryUsage += image.sizeInBytes();
+}
+
+void PageImageCache::evict(QMutexLocker &locker)
+{
+    // Must be called with m_mutex locked. The most recently used page is
+    // always kept, even if it alone is over the limit.
+    struct Victim
+    {
+        int index;
+        QImage image;
+        QString filePath;
+    };
+    QList<Victim> victims;
+
+    while(m_memoryUsage > m_memoryLimit && m_recentlyUsed.size() > 1)
+    {
+        const int index = m_recentlyUsed.first();
+        const QImage image = m_images.value(index);
+
+        if(!m_spillFiles.contains(index))
+        {
+            // If the page cannot be written to disk, it has to stay in memory.
+            const QString filePath = this->newSpillFilePath(index);
+            if(filePath.isEmpty())
+                break;
+
+            victims.append( Victim{index, image, filePath} );
+            m_spilling.insert(index, image);
+        }
+
+        m_recentlyUsed.removeFirst();
+        m_images.remove(index);
+        m_memoryUsage -= image.sizeInBytes();
+    }
+
+    if(victims.isEmpty())
+        return;
+
+    locker.unlock();
+
+    // Page images are mostly white, so even the fastest PNG compression
+    // brings them down to a small fraction of their size in memory. Qt maps
+    // quality to zlib level as (100-quality)*9/91, so 80 gives level 1. Any
+    // quality above 89 would give level 0, which is no compression at all.
+    QVector<bool> written(victims.size(), false);
+    for(int i=0; i<victims.size(); i++)
+    {
+        const Victim &victim = victims.at(i);
+        QImageWriter writer(victim.filePath, QByteArrayLiteral("PNG"));
+        writer.setQuality(80);
+        writer.setText(QStringLiteral("devicePixelRatio"), QString::number(victim.image.devicePixelRatio()));
+        written[i] = writer.write(victim.image);
+    }
+
+    locker.relock();
+
+    for(int i=0; i<victims.size(); i++)
+    {
+        const Victim &victim = victims.at(i);
+
+        // Pages replaced or thrown out in the meantime don't need their file.
+        auto it = m_spilling.find(victim.index);
+        if(it == m_spilling.end() || it.value().cacheKey() != victim.image.cacheKey())
+        {
+            QFile::remove(victim.filePath);
+            continue;
+        }
+
+        m_spilling.erase(it);
+        if(written.at(i))
+        {
+            m_spillFiles.insert(victim.index, victim.filePath);
+            ++m_spillCount;
+        }
+        else
+        {
+            // Not having the page on disk is no reason to lose it.
+            QFile::remove(victim.filePath);
+            m_images.insert(victim.index, victim.image);
+            m_recentlyUsed.prepend(victim.index);
+            m_memoryUsage += victim.image.sizeInBytes();
+        }
+    }
+}
+
+void PageImageCache::forget(int index)
+{
+    // Must be called with m_mutex locked.
+    auto it = m_images.find(index);
+    if(it != m_images.end())
+    {
+        m_memoryUsage -= it.value().sizeInBytes();
+        m_images.erase(it);
+        m_recentlyUsed.removeOne(index);
+    }
+
+    m_spilling.remove(index);
+
+    const QString filePath = m_spillFiles.take(index);
+    if(!filePath.isEmpty())
+        QFile::remove(filePath);
+}
+
+QString PageImageCache::newSpillFilePath(int index)
+{
+    // Must be called with m_mutex locked. Every spill gets a file of its
+    // own, so that a page written again never races with its older copy.
+    if(m_spillDirectory.isNull())
+    {
+        m_spillDirectory.reset(new QTemporaryDir(QDir::tempPath() + QStringLiteral("/scrite-pages-XXXXXX")));
+        if(!m_spillDirectory->isValid())
+        {
+            m_spillDirectory.reset();
+            return QString();
+        }
+    }
+
+    return m_spillDirectory->filePath(QStringLiteral("page") + QString::number(index) + QStringLiteral("-") + QString::number(++m_spillSerial) + QStringLiteral(".png"));
+}
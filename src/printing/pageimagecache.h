@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef PAGEIMAGECACHE_H
+#define PAGEIMAGECACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QImage>
+#include <QMutex>
+#include <QTemporaryDir>
+#include <QScopedPointer>
+
+/**
+ * Holds page images for ImagePrinter. Only the most recently used pages are
+ * kept in memory, up to memoryLimit bytes. Pages pushed out of memory are
+ * written to compressed files in a temporary directory, and read back from
+ * there the next time they are asked for.
+ *
+ * All functions can be called from any thread. Pages are compressed and
+ * decompressed without holding the lock, so threads adding or fetching
+ * pages at the same time only wait for each other's bookkeeping.
+ */
+class PageImageCache
+{
+public:
+    PageImageCache();
+    ~PageImageCache();
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+    qint64 memoryUsage() const;
+
+    int count() const;
+    void append(const QImage &image);
+    QImage at(int index);
+    void clear();
+
+    // Makes room for pages that are not available yet. at() returns a null
+    // image for such pages, until they are handed over using set().
+    void resize(int count);
+    void set(int index, const QImage &image);
+
+    // Lookups served from memory, lookups that had to read a page back from
+    // disk and the number of pages written to disk so far.
+    int hitCount() const;
+    int missCount() const;
+    int spillCount() const;
+    void resetStatistics();
+
+private:
+    void insert(int index, const QImage &image);
+    void evict(QMutexLocker &locker);
+    void forget(int index);
+    QString newSpillFilePath(int index);
+
+private:
+    mutable QMutex m_mutex;
+    int m_count = 0;
+    int m_spillSerial = 0;
+    qint64 m_memoryLimit = 128*1024*1024;
+    qint64 m_memoryUsage = 0;
+    QHash<int,QImage> m_images;
+    QList<int> m_recentlyUsed;    // least recently used page first
+    QHash<int,QImage> m_spilling; // pages being written to disk
+    QHash<int,QString> m_spillFiles;
+    QScopedPointer<QTemporaryDir> m_spillDirectory;
+
+    int m_hitCount = 0;
+    int m_missCount = 0;
+    int m_spillCount = 0;
+};
+
+#endif // PAGEIMAGECACHE_H
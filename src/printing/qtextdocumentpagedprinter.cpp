@@ -13,16 +13,22 @@
 
 #include "ruleritem.h"
 #include "application.h"
+#include "timeprofiler.h"
 #include "qtextdocumentpagedprinter.h"
 
 #include <QDate>
 #include <QTime>
+#include <QMutex>
+#include <QtMath>
+#include <QThread>
 #include <QtDebug>
 #include <QPainter>
 #include <QDateTime>
 #include <QSettings>
 #include <QTextBlock>
+#include <QTextCursor>
 #include <QPaintEngine>
+#include <QtConcurrentRun>
 #include <QAbstractTextDocumentLayout>
 
 HeaderFooter::HeaderFooter(Type type, QObject *parent)
@@ -161,19 +167,25 @@ void HeaderFooter::paint(QPainter *paint, const QRectF &, int pageNr, int pageCo
         }
     };
 
-    updateContent(m_columns[0], m_left);
-    updateContent(m_columns[1], m_center);
-    updateContent(m_columns[2], m_right);
+    // Page numbers go into a copy, so that pages can be painted from many
+    // threads at once.
+    QVector<ColumnContent> columns = m_columns;
+    if(columns.size() < 3)
+        return;
+
+    updateContent(columns[0], m_left);
+    updateContent(columns[1], m_center);
+    updateContent(columns[2], m_right);
 
     for(int i=0; i<3; i++)
     {
-        if(m_columns.at(i).content.isEmpty())
+        if(columns.at(i).content.isEmpty())
             continue;
 
         paint->save();
         paint->setOpacity(m_opacity);
         paint->setFont(m_font);
-        paint->drawText(m_columns.at(i).columnRect, m_columns.at(i).flags, m_columns.at(i).content);
+        paint->drawText(columns.at(i).columnRect, columns.at(i).flags, columns.at(i).content);
         paint->restore();
     }
 }
@@ -341,6 +353,115 @@ void Watermark::paint(QPainter *painter, const QRectF &pageRect, int pageNr, int
 
 ///////////////////////////////////////////////////////////////////////////////
 
+QTextDocumentSnapshot::QTextDocumentSnapshot()
+{
+
+}
+
+QTextDocumentSnapshot::QTextDocumentSnapshot(const QTextDocument *document)
+{
+    if(document == nullptr)
+        return;
+
+    // These are what QTextDocument::clone() copies, besides the fragment.
+    m_fragment = QTextDocumentFragment(document);
+    m_rootFrameFormat = document->rootFrame()->frameFormat();
+    m_pageSize = document->pageSize();
+    m_indentWidth = document->indentWidth();
+    m_defaultTextOption = document->defaultTextOption();
+    m_defaultFont = document->defaultFont();
+    m_useDesignMetrics = document->useDesignMetrics();
+    m_title = document->metaInformation(QTextDocument::DocumentTitle);
+
+    // Header and footer fields are looked up from dynamic properties.
+    const QList<QByteArray> propertyNames = document->dynamicPropertyNames();
+    for(const QByteArray &propertyName : propertyNames)
+        m_properties.append( qMakePair(propertyName, document->property(propertyName)) );
+
+    // Handlers are looked up the same way as in cloneForPrinting(), but
+    // only their types are kept. create() makes new ones.
+    QAbstractTextDocumentLayout *layout = document->documentLayout();
+    for(int type=QTextFormat::UserObject; type<QTextFormat::UserObject+16; type++)
+    {
+        QObject *handler = dynamic_cast<QObject*>(layout->handlerForObject(type));
+        if(handler == nullptr)
+            continue;
+
+        m_handlers.append( qMakePair(type, handler->metaObject()) );
+
+        const QMetaObject *mo = handler->metaObject();
+        if(mo->indexOfMethod("snapshotProperties(const QTextDocument*)") < 0)
+            continue;
+
+        QVariantMap properties;
+        QMetaObject::invokeMethod(handler, "snapshotProperties", Qt::DirectConnection,
+                                  Q_RETURN_ARG(QVariantMap, properties),
+                                  Q_ARG(const QTextDocument*, document));
+
+        QVariantMap::const_iterator it = properties.constBegin();
+        QVariantMap::const_iterator end = properties.constEnd();
+        while(it != end)
+        {
+            this->setProperty(it.key().toLatin1(), it.value());
+            ++it;
+        }
+    }
+
+    m_valid = true;
+}
+
+QTextDocumentSnapshot::~QTextDocumentSnapshot()
+{
+
+}
+
+void QTextDocumentSnapshot::setProperty(const QByteArray &name, const QVariant &value)
+{
+    for(QPair<QByteArray,QVariant> &property : m_properties)
+    {
+        if(property.first == name)
+        {
+            property.second = value;
+            return;
+        }
+    }
+
+    m_properties.append( qMakePair(name, value) );
+}
+
+QTextDocument *QTextDocumentSnapshot::create() const
+{
+    if(!m_valid)
+        return nullptr;
+
+    // Created here, the document and its layout belong to the calling thread.
+    QTextDocument *ret = new QTextDocument;
+    ret->setUseDesignMetrics(m_useDesignMetrics);
+    ret->setDefaultFont(m_defaultFont);
+    ret->setDefaultTextOption(m_defaultTextOption);
+    ret->setIndentWidth(m_indentWidth);
+    ret->setMetaInformation(QTextDocument::DocumentTitle, m_title);
+    for(const QPair<QByteArray,QVariant> &property : m_properties)
+        ret->setProperty(property.first, property.second);
+
+    QAbstractTextDocumentLayout *layout = ret->documentLayout();
+    for(const QPair<int,const QMetaObject*> &handler : m_handlers)
+    {
+        QObject *handlerCopy = handler.second->newInstance(Q_ARG(QObject*,ret));
+        if(handlerCopy != nullptr)
+            layout->registerHandler(handler.first, handlerCopy);
+    }
+
+    if(!m_fragment.isEmpty())
+        QTextCursor(ret).insertFragment(m_fragment);
+    ret->rootFrame()->setFrameFormat(m_rootFrameFormat);
+    ret->setPageSize(m_pageSize);
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 QTextDocumentPagedPrinter::QTextDocumentPagedPrinter(QObject *parent)
     : QObject(parent)
 {
@@ -357,42 +478,25 @@ QTextDocumentPagedPrinter::~QTextDocumentPagedPrinter()
 // my own print() implementation and it always sucked in stellar proportions.
 Q_DECL_IMPORT int qt_defaultDpi();
 
-template <class T>
-struct Pointer
-{
-    Pointer(T **ptr) : m_ptr(ptr) { }
-    ~Pointer() { *m_ptr = nullptr; }
-
-private:
-    T **m_ptr;
-};
-
 bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice *printer)
 {
-    Pointer<QTextDocument> td(&m_textDocument);
-    Pointer<QPagedPaintDevice> pr(&m_printer);
-    m_textDocument = document;
-    m_printer = printer;
-
     m_errorReport->clear();
 
-    if(m_textDocument == nullptr)
+    if(document == nullptr)
     {
         m_errorReport->setErrorMessage("No document to print.");
         return false;
     }
 
-    if(m_printer == nullptr)
+    if(printer == nullptr)
     {
         m_errorReport->setErrorMessage("No printer to print.");
         return false;
     }
 
-    if(!printer)
-        return false;
-
+    // Margins have to be in place before the painter is opened.
     const QSizeF pageSize = document->pageSize();
-    bool documentPaginated = pageSize.isValid() && !pageSize.isNull() && int(pageSize.height()) != INT_MAX;
+    const bool documentPaginated = pageSize.isValid() && !pageSize.isNull() && int(pageSize.height()) != INT_MAX;
 
     QPagedPaintDevice::Margins m = printer->margins();
     if (!documentPaginated && m.left == 0. && m.right == 0. && m.top == 0. && m.bottom == 0.)
@@ -405,12 +509,65 @@ bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice
     if (!painter.isActive())
         return false;
 
+    if( !this->begin(document, printer) )
+        return false;
+
+    // We are now ready to print.
+    const int fromPageNr = 1;
+    const int toPageNr = this->pageCount();
+
+    m_progressReport->start();
+    m_progressReport->setProgressStep(1/qreal(toPageNr+1));
+    int pageNr = fromPageNr;
+
+    // Print away!
+    while (pageNr <= toPageNr)
+    {
+        this->printPage(pageNr, &painter);
+
+        m_progressReport->tick();
+
+        if(m_pageFunction && !m_pageFunction(pageNr, toPageNr))
+        {
+            this->end();
+            m_progressReport->finish();
+            return false;
+        }
+
+        if(pageNr < toPageNr)
+        {
+            if(!m_printer->newPage())
+                break;
+        }
+
+        ++pageNr;
+    }
+
+    // All done!
+    this->end();
+    m_progressReport->finish();
+
+    return true;
+}
+
+bool QTextDocumentPagedPrinter::begin(QTextDocument *document, QPagedPaintDevice *printer)
+{
+    this->end();
+
+    if(document == nullptr || printer == nullptr)
+        return false;
+
+    m_textDocument = document;
+    m_printer = printer;
+
+    const QSizeF pageSize = document->pageSize();
+    bool documentPaginated = pageSize.isValid() && !pageSize.isNull() && int(pageSize.height()) != INT_MAX;
+
     const QTextDocument *doc = document;
-    QScopedPointer<QTextDocument> clonedDoc;
     (void)doc->documentLayout(); // make sure that there is a layout
 
-    QRectF body = QRectF(QPointF(0, 0), pageSize);
-    QPair<qreal,qreal> contentScale = qMakePair(1.0, 1.0);
+    m_pageBody = QRectF(QPointF(0, 0), pageSize);
+    m_contentScale = qMakePair(1.0, 1.0);
 
     if (documentPaginated)
     {
@@ -438,17 +595,17 @@ bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice
         const qreal pageScaleX = printerPageSize.width() / scaledPageSize.width();
         const qreal pageScaleY = printerPageSize.height() / scaledPageSize.height();
 
-        contentScale.first = dpiScaleX * pageScaleX;
-        contentScale.second = dpiScaleY * pageScaleY;
+        m_contentScale.first = dpiScaleX * pageScaleX;
+        m_contentScale.second = dpiScaleY * pageScaleY;
     }
     else
     {
         // Reports generated using AbstractReportGenerator are not paginated.
 
-        doc = document->clone(this);
-        clonedDoc.reset(const_cast<QTextDocument *>(doc));
+        m_clonedDocument.reset(document->clone());
+        doc = m_clonedDocument.data();
 
-        for (QTextBlock srcBlock = document->firstBlock(), dstBlock = clonedDoc->firstBlock();
+        for (QTextBlock srcBlock = document->firstBlock(), dstBlock = m_clonedDocument->firstBlock();
              srcBlock.isValid() && dstBlock.isValid();
              srcBlock = srcBlock.next(), dstBlock = dstBlock.next())
         {
@@ -456,18 +613,18 @@ bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice
         }
 
         QAbstractTextDocumentLayout *layout = doc->documentLayout();
-        layout->setPaintDevice(painter.device());
+        layout->setPaintDevice(printer);
 
         // We dont have to do this because we do not use any custom handlers in Scrite.
         // layout->d_func()->handlers = documentLayout()->d_func()->handlers;
 
-        int dpiy = painter.device()->logicalDpiY();
+        int dpiy = printer->logicalDpiY();
         int margin = int(((2/2.54)*dpiy)); // 2 cm margins
         QTextFrameFormat fmt = doc->rootFrame()->frameFormat();
         fmt.setMargin(margin);
-        doc->rootFrame()->setFrameFormat(fmt);
+        m_clonedDocument->rootFrame()->setFrameFormat(fmt);
 
-        body = QRectF(0, 0, printer->width(), printer->height());
+        m_pageBody = QRectF(0, 0, printer->width(), printer->height());
 
         // We dont compute pageNumberPos because we have a separate mechanism for drawing
         // headers, footers and watermark
@@ -476,9 +633,11 @@ bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice
         //                         + QFontMetrics(doc->defaultFont(), p.device()).ascent()
         //                         + 5 * dpiy / 72.0);
 
-        clonedDoc->setPageSize(body.size());
+        m_clonedDocument->setPageSize(m_pageBody.size());
     }
 
+    m_pagedDocument = doc;
+
     // At this point we are ready to print as far as QTextDocument is concerned.
 
     // Lets configure the headers and footers before we actually go ahead and print.
@@ -503,10 +662,10 @@ bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice
 
     // Here is where we got to figure out the header, footer and watermark rectangles
     const QTextFrameFormat fmt = doc->rootFrame()->frameFormat();
-    const qreal topMargin = fmt.topMargin() * contentScale.second;
-    const qreal leftMargin = fmt.leftMargin() * contentScale.first;
-    const qreal rightMargin = fmt.rightMargin() * contentScale.first;
-    const qreal bottomMargin = fmt.bottomMargin() * contentScale.second;
+    const qreal topMargin = fmt.topMargin() * m_contentScale.second;
+    const qreal leftMargin = fmt.leftMargin() * m_contentScale.first;
+    const qreal rightMargin = fmt.rightMargin() * m_contentScale.first;
+    const qreal bottomMargin = fmt.bottomMargin() * m_contentScale.second;
     const qreal padding = 0;
 
     m_headerRect = QRectF(0, 0, printer->width(), printer->height());
@@ -529,46 +688,156 @@ bool QTextDocumentPagedPrinter::print(QTextDocument *document, QPagedPaintDevice
     if(!watermarkText.isEmpty())
         m_watermark->setText(watermarkText);
 
-    // We are now ready to print.
-    const int fromPageNr = 1;
-    const int toPageNr = doc->pageCount();
+    m_pageCount = doc->pageCount();
+    m_isPdfDevice = printer->paintEngine()->type() == QPaintEngine::Pdf;
 
-    m_progressReport->start();
-    m_progressReport->setProgressStep(1/qreal(doc->pageCount()+1));
-    int pageNr = fromPageNr;
+    return true;
+}
 
-    const bool isPdfDevice = printer->paintEngine()->type() == QPaintEngine::Pdf;
+void QTextDocumentPagedPrinter::printPage(int pageNr, QPainter *painter)
+{
+    this->printPage(pageNr, painter, m_pagedDocument);
+}
 
-    // Print away!
-    while (pageNr <= toPageNr)
+void QTextDocumentPagedPrinter::printPage(int pageNr, QPainter *painter, const QTextDocument *doc)
+{
+    if(doc == nullptr || painter == nullptr || pageNr < 1 || pageNr > m_pageCount)
+        return;
+
+    if(m_isPdfDevice)
+        this->printHeaderFooterWatermark(pageNr, m_pageCount, painter, doc, m_pageBody);
+
+    painter->save();
+    painter->scale(m_contentScale.first, m_contentScale.second);
+    if(!m_isPdfDevice)
+        this->printHeaderFooterWatermark(pageNr, m_pageCount, painter, doc, m_pageBody);
+    this->printPageContents(pageNr, m_pageCount, painter, doc, m_pageBody);
+    painter->restore();
+}
+
+static QTextDocument *cloneForPrinting(const QTextDocument *document)
+{
+    QTextDocument *ret = document->clone();
+    ret->setUseDesignMetrics(document->useDesignMetrics());
+
+    // Scene numbers, title pages and the like are drawn by handlers registered
+    // with the layout. There is no API to list them, but Scrite only uses the
+    // first few user object types.
+    QAbstractTextDocumentLayout *sourceLayout = document->documentLayout();
+    QAbstractTextDocumentLayout *cloneLayout = ret->documentLayout();
+    for(int type=QTextFormat::UserObject; type<QTextFormat::UserObject+16; type++)
     {
-        if(isPdfDevice)
-            this->printHeaderFooterWatermark(pageNr, toPageNr, &painter, doc, body);
+        QObject *handler = dynamic_cast<QObject*>(sourceLayout->handlerForObject(type));
+        if(handler != nullptr)
+            cloneLayout->registerHandler(type, handler);
+    }
 
-        painter.save();
-        painter.scale(contentScale.first, contentScale.second);
-        if(!isPdfDevice)
-            this->printHeaderFooterWatermark(pageNr, toPageNr, &painter, doc, body);
-        this->printPageContents(pageNr, toPageNr, &painter, doc, body);
-        painter.restore();
+    return ret;
+}
 
-        m_progressReport->tick();
+bool QTextDocumentPagedPrinter::printPageImages(qreal scale, const PageImageFunction &function)
+{
+    if(m_pagedDocument == nullptr || m_printer == nullptr || !function)
+        return false;
 
-        if(pageNr < toPageNr)
-        {
-            if(!m_printer->newPage())
-                break;
-        }
+    PROFILE_THIS_FUNCTION;
 
-        ++pageNr;
+    const QSize pageImageSize = QSize(m_printer->width(), m_printer->height()) * scale;
+    auto printPageImage = [=](int pageNr, const QTextDocument *doc) {
+        QImage image(pageImageSize, QImage::Format_ARGB32);
+        image.setDevicePixelRatio(scale);
+        image.fill(Qt::white);
+
+        QPainter painter(&image);
+        this->printPage(pageNr, &painter, doc);
+        painter.end();
+
+        function(pageNr, image);
+    };
+
+    // Documents that are not paginated are laid out for the printer in
+    // begin(), those layouts cannot be reproduced elsewhere.
+    const int nrThreads = m_clonedDocument.isNull() ? qMin(QThread::idealThreadCount(), m_pageCount) : 1;
+    if(nrThreads <= 1)
+    {
+        for(int pageNr=1; pageNr<=m_pageCount; pageNr++)
+            printPageImage(pageNr, m_pagedDocument);
+        return true;
     }
 
-    // All done!
+    // QTextDocument cannot be painted from more than one thread. So each
+    // thread lays out a clone of its own and paints a contiguous range of
+    // pages from it. Clones are made one at a time, because copying the
+    // document creates cursors on it.
+    struct PageRange
+    {
+        int from;
+        int to;
+        QFuture<bool> future;
+    };
+
+    QMutex cloneMutex;
+    const QTextDocument *source = m_pagedDocument;
+    const int pageCount = m_pageCount;
+    const int pagesPerThread = qCeil( qreal(pageCount)/qreal(nrThreads) );
+
+    QList<PageRange> ranges;
+    for(int from=1; from<=pageCount; from += pagesPerThread)
+    {
+        const int to = qMin(from+pagesPerThread-1, pageCount);
+
+        PageRange range;
+        range.from = from;
+        range.to = to;
+        range.future = QtConcurrent::run([=,&cloneMutex]() {
+            QScopedPointer<QTextDocument> clone;
+            {
+                QMutexLocker locker(&cloneMutex);
+                clone.reset( cloneForPrinting(source) );
+            }
+
+            if(clone->pageCount() != pageCount)
+                return false;
+
+            for(int pageNr=from; pageNr<=to; pageNr++)
+                printPageImage(pageNr, clone.data());
+            return true;
+        });
+        ranges.append(range);
+    }
+
+    // A clone that paginates differently from the document it was copied
+    // from would paint the wrong pages. Such ranges are painted here instead,
+    // from the document itself, once all threads are done with it.
+    QList<PageRange> failedRanges;
+    for(PageRange &range : ranges)
+    {
+        if(!range.future.result())
+            failedRanges.append(range);
+    }
+
+    for(const PageRange &range : qAsConst(failedRanges))
+    {
+        for(int pageNr=range.from; pageNr<=range.to; pageNr++)
+            printPageImage(pageNr, m_pagedDocument);
+    }
+
+    return true;
+}
+
+void QTextDocumentPagedPrinter::end()
+{
+    if(m_textDocument == nullptr)
+        return;
+
     m_header->finish();
     m_footer->finish();
-    m_progressReport->finish();
 
-    return true;
+    m_pagedDocument = nullptr;
+    m_clonedDocument.reset();
+    m_textDocument = nullptr;
+    m_printer = nullptr;
+    m_pageCount = 0;
 }
 
 void QTextDocumentPagedPrinter::loadSettings(HeaderFooter *header, HeaderFooter *footer, Watermark *watermark)
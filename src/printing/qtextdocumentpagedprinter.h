@@ -15,14 +15,19 @@
 #define QTEXTDOCUMENTPAGEDPRINTER_H
 
 #include <QColor>
+#include <QImage>
 #include <QEvent>
 #include <QObject>
+#include <QScopedPointer>
 #include <QTextDocument>
 #include <QPagedPaintDevice>
+#include <QTextDocumentFragment>
 
 #include "errorreport.h"
 #include "progressreport.h"
 
+#include <functional>
+
 class QTextDocumentPagedPrinter;
 
 class HeaderFooter : public QObject
@@ -196,6 +201,47 @@ private:
     QRectF m_rect;
 };
 
+/**
+ * Everything needed to rebuild a document on another thread. It is taken on
+ * the thread that owns the document, and create() is called on the thread
+ * that lays out and prints the copy. The copy is never shared between the
+ * two, so neither lays it out while the other is using it.
+ *
+ * Handlers of user objects are created afresh by create(), so they need a
+ * Q_INVOKABLE constructor that takes a parent QObject. Handlers that read
+ * anything other than the document and the formats passed to them, can
+ * offer a Q_INVOKABLE QVariantMap snapshotProperties(const QTextDocument*).
+ * It is called when the snapshot is taken, and whatever it returns is set as
+ * dynamic properties on the copy.
+ */
+class QTextDocumentSnapshot
+{
+public:
+    QTextDocumentSnapshot();
+    QTextDocumentSnapshot(const QTextDocument *document);
+    ~QTextDocumentSnapshot();
+
+    bool isValid() const { return m_valid; }
+
+    void setProperty(const QByteArray &name, const QVariant &value);
+
+    // Caller owns the returned document, and must delete it on the same thread.
+    QTextDocument *create() const;
+
+private:
+    bool m_valid = false;
+    bool m_useDesignMetrics = false;
+    qreal m_indentWidth = 40;
+    QSizeF m_pageSize;
+    QFont m_defaultFont;
+    QString m_title;
+    QTextOption m_defaultTextOption;
+    QTextFrameFormat m_rootFrameFormat;
+    QTextDocumentFragment m_fragment;
+    QList< QPair<QByteArray,QVariant> > m_properties;
+    QList< QPair<int,const QMetaObject*> > m_handlers;
+};
+
 class QTextDocumentPagedPrinter : public QObject
 {
     Q_OBJECT
@@ -215,9 +261,32 @@ public:
 
     Q_INVOKABLE bool print(QTextDocument *document, QPagedPaintDevice *device);
 
+    // print() is begin(), printPage() for every page and end(). Calling them
+    // separately allows pages to be painted in any order, long after the
+    // document has been paginated, as long as the document does not change
+    // in between.
+    bool begin(QTextDocument *document, QPagedPaintDevice *device);
+    int pageCount() const { return m_pageCount; }
+    void printPage(int pageNr, QPainter *painter);
+    void end();
+    QTextDocument *document() const { return m_textDocument; }
+
+    // Paints every page into an image of the device size times scale, after
+    // begin(). Pages are painted on several threads, and function is called
+    // from those threads, in no particular order. The document must not
+    // change until this function returns.
+    typedef std::function<void(int pageNr, const QImage &image)> PageImageFunction;
+    bool printPageImages(qreal scale, const PageImageFunction &function);
+
+    // Called by print() after each page, from the thread it prints on.
+    // Printing stops if the function returns false.
+    typedef std::function<bool(int pageNr, int pageCount)> PageFunction;
+    void setPageFunction(const PageFunction &function) { m_pageFunction = function; }
+
     static void loadSettings(HeaderFooter *header, HeaderFooter *footer, Watermark *watermark);
 
 private:
+    void printPage(int pageNr, QPainter *painter, const QTextDocument *doc);
     void printPageContents(int pageNr, int pageCount, QPainter *painter, const QTextDocument *doc, const QRectF &body);
     void printHeaderFooterWatermark(int pageNr, int pageCount, QPainter *painter, const QTextDocument *doc, const QRectF &body);
 
@@ -229,8 +298,15 @@ private:
     ProgressReport *m_progressReport = new ProgressReport(this);
     QPagedPaintDevice* m_printer = nullptr;
     QTextDocument* m_textDocument = nullptr;
+    const QTextDocument* m_pagedDocument = nullptr;
+    QScopedPointer<QTextDocument> m_clonedDocument;
+    QRectF m_pageBody;
+    QPair<qreal,qreal> m_contentScale = qMakePair(1.0, 1.0);
+    int m_pageCount = 0;
+    bool m_isPdfDevice = false;
     QRectF m_headerRect;
     QRectF m_footerRect;
+    PageFunction m_pageFunction;
 };
 
 #endif // QTEXTDOCUMENTPAGEDPRINTER_H
@@ -11,14 +11,16 @@
 **
 ****************************************************************************/
 
-#include "boundingboxevaluator.h"
 #include "boundingboxevaluator.h"
 
+#include <QSet>
+#include <QtMath>
 #include <QPainter>
 #include <QQuickItemGrabResult>
 
 BoundingBoxEvaluator::BoundingBoxEvaluator(QObject *parent)
-    : QObject(parent)
+    : QObject(parent),
+      m_grabTimer("BoundingBoxEvaluator.grabTimer")
 {
 
 }
@@ -46,54 +48,118 @@ void BoundingBoxEvaluator::setPreviewScale(qreal val)
 
     m_previewScale = val;
     emit previewScaleChanged();
+
+    this->markPreviewDirty();
 }
 
 void BoundingBoxEvaluator::updatePreview()
 {
-    if(!m_preview.isNull())
+    const qreal tileScale = this->evaluateTileScale();
+    if(tileScale <= 0)
+    {
+        m_previewTiles.clear();
+        m_dirtyRects.clear();
         return;
+    }
 
-    QSizeF boxSize = m_boundingBox.size();
-    boxSize *= m_previewScale;
-    if(boxSize.isEmpty())
-        return;
+    if( !qFuzzyCompare(m_tileScale, tileScale) )
+    {
+        m_tileScale = tileScale;
+        m_previewFullyDirty = true;
+    }
+
+    if(m_previewFullyDirty)
+    {
+        m_previewTiles.clear();
+        m_dirtyRects.clear();
+        m_dirtyRects.append(m_boundingBox);
+        m_previewFullyDirty = false;
+    }
 
-    auto lessThan = [](BoundingBoxItem *e1, BoundingBoxItem *e2) -> bool {
-        return e1->stackOrder() < e2->stackOrder();
-    };
-    std::sort(m_items.begin(), m_items.end(), lessThan);
+    if(m_dirtyRects.isEmpty())
+        return;
 
-    m_preview = QImage(boxSize.toSize(), QImage::Format_ARGB32);
-    m_preview.fill(Qt::transparent);
+    if(!m_itemsSorted)
+    {
+        auto lessThan = [](BoundingBoxItem *e1, BoundingBoxItem *e2) -> bool {
+            return e1->stackOrder() < e2->stackOrder();
+        };
+        std::stable_sort(m_items.begin(), m_items.end(), lessThan);
+        m_itemsSorted = true;
+    }
 
-    QTransform tx;
-    tx.translate(-m_boundingBox.left(), -m_boundingBox.top());
-    tx.scale(m_previewScale, m_previewScale);
+    // Tiles that have moved out of the bounding box are no longer needed.
+    auto it = m_previewTiles.begin();
+    while(it != m_previewTiles.end())
+    {
+        if( this->tileRect(it.key().first, it.key().second).intersects(m_boundingBox) )
+            ++it;
+        else
+            it = m_previewTiles.erase(it);
+    }
 
-    QPainter paint(&m_preview);
-    paint.setRenderHint(QPainter::Antialiasing);
-    paint.setRenderHint(QPainter::SmoothPixmapTransform);
-    paint.setTransform(tx);
+    // Borders are painted with a cosmetic pen, which can bleed into a neighbouring
+    // tile by a pixel. So we inflate dirty rects by a pixel in preview space.
+    const qreal margin = 1.0 / m_tileScale;
+    const qreal tileExtent = qreal(PreviewTileSize) / m_tileScale;
 
-    Q_FOREACH(BoundingBoxItem *item, m_items)
+    QSet< QPair<int,int> > dirtyTiles;
+    for(const QRectF &dirtyRect : qAsConst(m_dirtyRects))
     {
-        if(item->item() == nullptr)
+        const QRectF rect = dirtyRect.adjusted(-margin, -margin, margin, margin) & m_boundingBox;
+        if(rect.isEmpty())
             continue;
 
-        const QRectF itemRect = item->boundingRect();
-        const QImage itemPreview = item->preview();
-
-        if(item->isLivePreview() && !itemPreview.isNull())
-            paint.drawImage(itemRect, itemPreview);
-        else if(item->previewBorderColor().alpha() > 0 && item->previewFillColor().alpha() > 0)
+        const int firstRow = qFloor(rect.top() / tileExtent);
+        const int lastRow = qFloor(rect.bottom() / tileExtent);
+        const int firstColumn = qFloor(rect.left() / tileExtent);
+        const int lastColumn = qFloor(rect.right() / tileExtent);
+        for(int row=firstRow; row<=lastRow; row++)
         {
-            paint.setPen( QPen(item->previewBorderColor()) );
-            paint.setBrush( QBrush(item->previewFillColor()) );
-            paint.drawRect(itemRect);
+            for(int column=firstColumn; column<=lastColumn; column++)
+                dirtyTiles.insert( qMakePair(row,column) );
         }
     }
 
-    paint.end();
+    m_dirtyRects.clear();
+
+    for(const QPair<int,int> &tile : qAsConst(dirtyTiles))
+        this->renderTile(tile.first, tile.second);
+}
+
+void BoundingBoxEvaluator::paintPreview(QPainter *painter, const QRectF &targetRect)
+{
+    this->updatePreview();
+
+    if(m_previewTiles.isEmpty() || m_boundingBox.isEmpty())
+        return;
+
+    QSizeF size = this->previewSize();
+    if(size.isEmpty())
+        return;
+
+    size.scale(targetRect.size(), Qt::KeepAspectRatio);
+
+    const QRectF previewRect(targetRect.topLeft(), size);
+    const qreal scale = size.width() / m_boundingBox.width();
+
+    painter->save();
+    painter->setClipRect(previewRect);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    auto it = m_previewTiles.constBegin();
+    auto end = m_previewTiles.constEnd();
+    while(it != end)
+    {
+        const QRectF rect = this->tileRect(it.key().first, it.key().second);
+        const QRectF tileTargetRect( previewRect.left() + (rect.left()-m_boundingBox.left())*scale,
+                                     previewRect.top() + (rect.top()-m_boundingBox.top())*scale,
+                                     rect.width()*scale, rect.height()*scale );
+        painter->drawImage(tileTargetRect, it.value());
+        ++it;
+    }
+
+    painter->restore();
 }
 
 void BoundingBoxEvaluator::timerEvent(QTimerEvent *event)
@@ -103,6 +169,11 @@ void BoundingBoxEvaluator::timerEvent(QTimerEvent *event)
         m_evaluationTimer.stop();
         this->evaluateNow();
     }
+    else if(event->timerId() == m_grabTimer.timerId())
+    {
+        m_grabTimer.stop();
+        this->grabNextBatch();
+    }
 }
 
 void BoundingBoxEvaluator::setBoundingBox(const QRectF &val)
@@ -112,21 +183,43 @@ void BoundingBoxEvaluator::setBoundingBox(const QRectF &val)
 
     m_boundingBox = val;
     emit boundingBoxChanged();
+
+    // Tiles are anchored at the canvas origin, so they remain valid across
+    // bounding box changes. Only the region where tiles are placed changes.
+    emit previewNeedsUpdate();
 }
 
 void BoundingBoxEvaluator::addItem(BoundingBoxItem *item)
 {
     connect(item, &BoundingBoxItem::aboutToDestroy, this, &BoundingBoxEvaluator::removeItem);
-    connect(item, &BoundingBoxItem::previewUpdated, this, &BoundingBoxEvaluator::markPreviewDirty);
+    connect(item, &BoundingBoxItem::previewUpdated, this, &BoundingBoxEvaluator::onItemPreviewUpdated);
+    connect(item, &BoundingBoxItem::stackOrderChanged, this, &BoundingBoxEvaluator::onItemStackOrderChanged);
     m_items.append(item);
+    m_itemsSorted = false;
+    item->m_lastRect = item->boundingRect();
+    this->markPreviewDirty(item->m_lastRect);
     this->evaluateLater();
 }
 
 void BoundingBoxEvaluator::removeItem(BoundingBoxItem *item)
 {
     disconnect(item, &BoundingBoxItem::aboutToDestroy, this, &BoundingBoxEvaluator::removeItem);
-    disconnect(item, &BoundingBoxItem::previewUpdated, this, &BoundingBoxEvaluator::markPreviewDirty);
+    disconnect(item, &BoundingBoxItem::previewUpdated, this, &BoundingBoxEvaluator::onItemPreviewUpdated);
+    disconnect(item, &BoundingBoxItem::stackOrderChanged, this, &BoundingBoxEvaluator::onItemStackOrderChanged);
     m_items.removeOne(item);
+    if(item->m_grabQueued)
+    {
+        m_grabQueue.removeOne(item);
+        item->m_grabQueued = false;
+    }
+    this->markPreviewDirty(item->m_lastRect);
+    this->evaluateLater();
+}
+
+void BoundingBoxEvaluator::markDirty(BoundingBoxItem *item, const QRectF &oldRect)
+{
+    this->markPreviewDirty(oldRect);
+    this->markPreviewDirty(item->boundingRect());
     this->evaluateLater();
 }
 
@@ -145,10 +238,143 @@ void BoundingBoxEvaluator::evaluateNow()
 
 void BoundingBoxEvaluator::markPreviewDirty()
 {
-    m_preview = QImage();
+    m_previewFullyDirty = true;
+    m_dirtyRects.clear();
     emit previewNeedsUpdate();
 }
 
+void BoundingBoxEvaluator::markPreviewDirty(const QRectF &rect)
+{
+    if(rect.isNull() || m_previewFullyDirty)
+        return;
+
+    // If too many regions pile up before the preview gets painted, it's cheaper
+    // to simply repaint everything.
+    if(m_dirtyRects.size() >= 256)
+    {
+        this->markPreviewDirty();
+        return;
+    }
+
+    m_dirtyRects.append(rect);
+    emit previewNeedsUpdate();
+}
+
+void BoundingBoxEvaluator::onItemPreviewUpdated()
+{
+    BoundingBoxItem *item = qobject_cast<BoundingBoxItem*>(this->sender());
+    if(item != nullptr)
+        this->markPreviewDirty(item->boundingRect());
+}
+
+void BoundingBoxEvaluator::onItemStackOrderChanged()
+{
+    m_itemsSorted = false;
+    this->onItemPreviewUpdated();
+}
+
+void BoundingBoxEvaluator::requestGrab(BoundingBoxItem *item)
+{
+    if(item->m_grabQueued)
+        return;
+
+    item->m_grabQueued = true;
+    m_grabQueue.append(item);
+
+    if(!m_grabTimer.isActive())
+        m_grabTimer.start(50, this);
+}
+
+void BoundingBoxEvaluator::grabNextBatch()
+{
+    int nrGrabs = 0;
+    while(!m_grabQueue.isEmpty() && nrGrabs < MaxGrabsPerBatch)
+    {
+        BoundingBoxItem *item = m_grabQueue.takeFirst();
+        item->m_grabQueued = false;
+        item->grabPreview();
+        ++nrGrabs;
+    }
+
+    if(!m_grabQueue.isEmpty())
+        m_grabTimer.start(100, this);
+}
+
+qreal BoundingBoxEvaluator::evaluateTileScale() const
+{
+    if(m_previewScale <= 0 || m_boundingBox.isEmpty())
+        return 0;
+
+    // Keep halving the scale until the whole preview fits within the pixel budget.
+    // Using powers of 2 ensures that small changes to the bounding box don't
+    // cause all tiles to be thrown away.
+    const qreal area = m_boundingBox.width() * m_boundingBox.height();
+    qreal scale = m_previewScale;
+    while(area*scale*scale > qreal(MaxPreviewPixels))
+        scale /= 2.0;
+
+    return scale;
+}
+
+QRectF BoundingBoxEvaluator::tileRect(int row, int column) const
+{
+    const qreal tileExtent = qreal(PreviewTileSize) / m_tileScale;
+    return QRectF(column*tileExtent, row*tileExtent, tileExtent, tileExtent);
+}
+
+void BoundingBoxEvaluator::renderTile(int row, int column)
+{
+    const QPair<int,int> key = qMakePair(row, column);
+    const QRectF rect = this->tileRect(row, column);
+    const qreal margin = 1.0 / m_tileScale;
+
+    QImage tile(PreviewTileSize, PreviewTileSize, QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+
+    QTransform tx;
+    tx.translate(-column*PreviewTileSize, -row*PreviewTileSize);
+    tx.scale(m_tileScale, m_tileScale);
+
+    QPainter paint(&tile);
+    paint.setRenderHint(QPainter::Antialiasing);
+    paint.setRenderHint(QPainter::SmoothPixmapTransform);
+    paint.setTransform(tx);
+
+    bool tileIsEmpty = true;
+    for(BoundingBoxItem *item : qAsConst(m_items))
+    {
+        if(item->item() == nullptr)
+            continue;
+
+        const QRectF itemRect = item->boundingRect();
+        if( !itemRect.adjusted(-margin, -margin, margin, margin).intersects(rect) )
+            continue;
+
+        const QImage itemPreview = item->preview();
+
+        if(item->isLivePreview() && !itemPreview.isNull())
+        {
+            paint.drawImage(itemRect, itemPreview);
+            tileIsEmpty = false;
+        }
+        else if(item->previewBorderColor().alpha() > 0 && item->previewFillColor().alpha() > 0)
+        {
+            paint.setPen( QPen(item->previewBorderColor()) );
+            paint.setBrush( QBrush(item->previewFillColor()) );
+            paint.drawRect(itemRect);
+            tileIsEmpty = false;
+        }
+    }
+
+    paint.end();
+
+    // Empty tiles are not stored, so that sparse canvases consume little memory.
+    if(tileIsEmpty)
+        m_previewTiles.remove(key);
+    else
+        m_previewTiles.insert(key, tile);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 BoundingBoxItem::BoundingBoxItem(QObject *parent)
@@ -300,8 +526,11 @@ void BoundingBoxItem::timerEvent(QTimerEvent *event)
 
 void BoundingBoxItem::requestReevaluation()
 {
+    const QRectF oldRect = m_lastRect;
+    m_lastRect = this->boundingRect();
+
     if(m_evaluator)
-        m_evaluator->markDirty(this);
+        m_evaluator->markDirty(this, oldRect);
 
     this->updatePreviewLater();
 }
@@ -330,21 +559,12 @@ void BoundingBoxItem::updatePreview()
 
     if(m_livePreview)
     {
-        QSizeF previewSize( m_item->width(), m_item->height() );
+        // Grabs are expensive, so when there is an evaluator we let it batch
+        // and throttle grab requests from all of its items.
         if(m_evaluator != nullptr)
-            previewSize *= m_evaluator->previewScale();
-
-        if(previewSize.isNull())
-        {
-            this->setPreview(QImage());
-            return;
-        }
-
-        m_itemGrabResult = m_item->grabToImage(previewSize.toSize());
-        connect(m_itemGrabResult.get(), &QQuickItemGrabResult::ready, [=]() {
-            this->setPreview(m_itemGrabResult->image());
-             m_itemGrabResult.clear();
-        });
+            m_evaluator->requestGrab(this);
+        else
+            this->grabPreview();
     }
     else
     {
@@ -359,6 +579,36 @@ void BoundingBoxItem::updatePreviewLater()
         m_updatePreviewTimer.start(500, this);
 }
 
+void BoundingBoxItem::grabPreview()
+{
+    if(m_item == nullptr || !m_livePreview)
+        return;
+
+    QSizeF previewSize( m_item->width(), m_item->height() );
+    if(m_evaluator != nullptr)
+        previewSize *= m_evaluator->previewScale();
+
+    if(previewSize.isNull())
+    {
+        this->setPreview(QImage());
+        return;
+    }
+
+    m_itemGrabResult = m_item->grabToImage(previewSize.toSize());
+    if(m_itemGrabResult.isNull())
+        return;
+
+    // Only the most recent grab matters. Results of earlier grabs that complete
+    // later are simply ignored.
+    QQuickItemGrabResult *grabResult = m_itemGrabResult.data();
+    connect(grabResult, &QQuickItemGrabResult::ready, this, [=]() {
+        if(m_itemGrabResult.data() != grabResult)
+            return;
+        this->setPreview(grabResult->image());
+        m_itemGrabResult.clear();
+    });
+}
+
 void BoundingBoxItem::setPreview(const QImage &image)
 {
     if(image.isNull() && m_preview.isNull())
@@ -477,22 +727,7 @@ void BoundingBoxPreview::paint(QPainter *painter)
     painter->setOpacity(1.0);
 
     if(m_evaluator != nullptr)
-    {
-        m_evaluator->updatePreview();
-
-        const QImage preview = m_evaluator->preview();
-        if(preview.isNull())
-            return;
-
-        QSizeF previewSize = preview.size();
-        previewSize.scale(itemRect.size(), Qt::KeepAspectRatio);
-
-        QRectF previewRect( QPointF(0,0), previewSize );
-        // previewRect.moveCenter(itemRect.center());
-
-        painter->setRenderHint(QPainter::SmoothPixmapTransform);
-        painter->drawImage(previewRect, preview );
-    }
+        m_evaluator->paintPreview(painter, itemRect);
 }
 
 void BoundingBoxPreview::resetEvaluator()
@@ -16,6 +16,7 @@
 
 #include "execlatertimer.h"
 
+#include <QHash>
 #include <QRectF>
 #include <QImage>
 #include <QObject>
@@ -82,8 +83,18 @@ public:
     qreal previewScale() const { return m_previewScale; }
     Q_SIGNAL void previewScaleChanged();
 
+    /**
+     * Preview is maintained as a grid of fixed size tiles, anchored at the canvas
+     * origin. Only tiles that intersect with rects of items that changed are
+     * repainted. Tiles that end up empty are not stored at all, and the effective
+     * scale at which tiles are rendered is reduced (in powers of 2) whenever the
+     * bounding box gets so large that the preview would exceed MaxPreviewPixels.
+     */
+    enum { PreviewTileSize = 256, MaxPreviewPixels = 2048*2048, MaxGrabsPerBatch = 4 };
+
     void updatePreview();
-    QImage preview() const { return m_preview; }
+    QSizeF previewSize() const { return m_boundingBox.size() * m_previewScale; }
+    void paintPreview(QPainter *painter, const QRectF &targetRect);
     Q_INVOKABLE void markPreviewDirty();
     Q_SIGNAL void previewNeedsUpdate();
 
@@ -96,16 +107,30 @@ protected:
 private:
     void addItem(BoundingBoxItem *item);
     void removeItem(BoundingBoxItem* item);
-    void markDirty(BoundingBoxItem *) { this->evaluateLater(); }
+    void markDirty(BoundingBoxItem *item, const QRectF &oldRect);
+    void markPreviewDirty(const QRectF &rect);
+    void onItemPreviewUpdated();
+    void onItemStackOrderChanged();
+    void requestGrab(BoundingBoxItem *item);
+    void grabNextBatch();
+    qreal evaluateTileScale() const;
+    QRectF tileRect(int row, int column) const;
+    void renderTile(int row, int column);
 
 private:
     friend class BoundingBoxItem;
-    QImage m_preview;
     QRectF m_initialRect;
     QRectF m_boundingBox;
     qreal m_previewScale = 1.0;
+    qreal m_tileScale = 0;
+    bool m_itemsSorted = false;
+    bool m_previewFullyDirty = true;
+    QList<QRectF> m_dirtyRects;
+    QHash< QPair<int,int>, QImage > m_previewTiles;
     ExecLaterTimer m_evaluationTimer;
+    ExecLaterTimer m_grabTimer;
     QList<BoundingBoxItem*> m_items;
+    QList<BoundingBoxItem*> m_grabQueue;
 };
 
 class BoundingBoxItem : public QObject
@@ -185,11 +210,15 @@ private:
     void resetViewportItem();
     void updatePreview();
     void updatePreviewLater();
+    void grabPreview();
     void setPreview(const QImage &image);
     void determineVisibility();
 
 private:
+    friend class BoundingBoxEvaluator;
     QImage m_preview;
+    QRectF m_lastRect;
+    bool m_grabQueued = false;
     qreal m_stackOrder = 0;
     bool m_livePreview = true;
     QRectF m_viewportRect;
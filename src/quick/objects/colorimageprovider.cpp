@@ -13,10 +13,49 @@
 
 #include "colorimageprovider.h"
 
-ColorImageProvider::ColorImageProvider()
-    : QQuickImageProvider(QQuickImageProvider::Image)
+#include <QQuickWindow>
+#include <QQuickTextureFactory>
+
+static const QSize ColorImageDefaultSize(64, 64);
+
+// Reports the size asked for, but uploads a single pixel. Solid colors look
+// the same stretched, and a texture per item costs 4 bytes of GPU memory.
+class ColorTextureFactory : public QQuickTextureFactory
 {
+public:
+    ColorTextureFactory(QRgb color, const QSize &size)
+        : m_color(color), m_size(size) { }
+    ~ColorTextureFactory() { }
+
+    QSGTexture *createTexture(QQuickWindow *window) const {
+        QImage pixel(1, 1, QImage::Format_ARGB32_Premultiplied);
+        pixel.fill( qPremultiply(m_color) );
+
+        QQuickWindow::CreateTextureOptions options;
+        if(qAlpha(m_color) < 255)
+            options |= QQuickWindow::TextureHasAlphaChannel;
+        return window->createTextureFromImage(pixel, options);
+    }
+
+    QSize textureSize() const { return m_size; }
+    int textureByteCount() const { return 4; }
+
+    QImage image() const {
+        QImage ret(m_size, QImage::Format_ARGB32);
+        ret.fill(m_color);
+        return ret;
+    }
 
+private:
+    QRgb m_color;
+    QSize m_size;
+};
+
+ColorImageProvider::ColorImageProvider(QQuickImageProvider::ImageType type)
+    : QQuickImageProvider(type)
+{
+    // Cost is in bytes, that's 4MB worth of images.
+    m_images.setMaxCost(4*1024*1024);
 }
 
 ColorImageProvider::~ColorImageProvider()
@@ -26,10 +65,54 @@ ColorImageProvider::~ColorImageProvider()
 
 QImage ColorImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
-    const QSize defaultSize(64, 64);
-    QImage image(requestedSize.isEmpty() ? defaultSize : requestedSize, QImage::Format_ARGB32);
+    const QSize imageSize = requestedSize.isEmpty() ? ColorImageDefaultSize : requestedSize;
     if(size)
-        *size = defaultSize;
-    image.fill( QColor(id).rgba() );
+        *size = ColorImageDefaultSize;
+
+    const bool cacheable = imageSize.width() <= 0xFFFF && imageSize.height() <= 0xFFFF;
+    const QPair<QString,quint32> key(id, quint32(imageSize.width()) << 16 | quint32(imageSize.height()));
+
+    QMutexLocker locker(&m_mutex);
+
+    if(cacheable)
+    {
+        const QImage *cached = m_images.object(key);
+        if(cached != nullptr)
+            return *cached;
+    }
+
+    QImage image(imageSize, QImage::Format_ARGB32);
+    image.fill( this->colorFor(id) );
+
+    const int cost = int(image.sizeInBytes());
+    if(cacheable && cost <= m_images.maxCost())
+        m_images.insert(key, new QImage(image), cost);
+
     return image;
 }
+
+QQuickTextureFactory *ColorImageProvider::requestTexture(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    const QSize textureSize = requestedSize.isEmpty() ? ColorImageDefaultSize : requestedSize;
+    if(size)
+        *size = ColorImageDefaultSize;
+
+    QMutexLocker locker(&m_mutex);
+    return new ColorTextureFactory(this->colorFor(id), textureSize);
+}
+
+QRgb ColorImageProvider::colorFor(const QString &id)
+{
+    // Parsing color names isn't free either. There are only so many colors
+    // in use, so they are remembered.
+    QHash<QString,QRgb>::const_iterator it = m_colors.constFind(id);
+    if(it != m_colors.constEnd())
+        return it.value();
+
+    if(m_colors.size() > 4096)
+        m_colors.clear();
+
+    const QRgb ret = QColor(id).rgba();
+    m_colors.insert(id, ret);
+    return ret;
+}
@@ -14,16 +14,37 @@
 #ifndef COLORIMAGEPROVIDER_H
 #define COLORIMAGEPROVIDER_H
 
+#include <QPair>
+#include <QCache>
+#include <QMutex>
 #include <QQuickImageProvider>
 
+/**
+ * Provides solid color images for image://color/<color> URLs.
+ *
+ * In Texture mode (the default) each request gets a texture factory that
+ * reports the requested size, but uploads a 1x1 texture which the scene graph
+ * stretches. In Image mode, filled images are kept in a bounded LRU cache
+ * keyed by color and size, since the same few colors are asked for repeatedly.
+ */
 class ColorImageProvider : public QQuickImageProvider
 {
 public:
-    ColorImageProvider();
+    ColorImageProvider(QQuickImageProvider::ImageType type=QQuickImageProvider::Texture);
     ~ColorImageProvider();
 
     // QQuickImageProvider interface
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+    QQuickTextureFactory *requestTexture(const QString &id, QSize *size, const QSize &requestedSize);
+
+private:
+    QRgb colorFor(const QString &id);
+
+private:
+    // Requests can come from QML's image loader threads
+    QMutex m_mutex;
+    QHash<QString,QRgb> m_colors;
+    QCache<QPair<QString,quint32>,QImage> m_images;
 };
 
 #endif // COLORIMAGEPROVIDER_H
@@ -12,7 +12,10 @@
 ****************************************************************************/
 
 #include "completer.h"
+#include "structure.h"
+#include "scritedocument.h"
 
+#include <QSet>
 #include <QtDebug>
 #include <QStringListModel>
 #include <QEvent>
@@ -28,11 +31,9 @@ Completer::Completer(QObject *parent)
     m_stringsModel = new QStringListModel(this);
     this->setModel(m_stringsModel);
 
-    QAbstractItemModel *cmodel = this->completionModel();
-    connect(cmodel, &QAbstractItemModel::rowsInserted, this, &Completer::updateSuggestionsLater);
-    connect(cmodel, &QAbstractItemModel::rowsRemoved, this, &Completer::updateSuggestionsLater);
-    connect(cmodel, &QAbstractItemModel::modelReset, this, &Completer::updateSuggestionsLater);
-    connect(cmodel, &QAbstractItemModel::dataChanged, this, &Completer::updateSuggestionsLater);
+    // Suggestions are looked up in tries. The model is filled only if
+    // completionModel is asked for.
+    m_updateSuggestionTimer.setPriority(ExecLaterTimer::HighPriority);
 }
 
 Completer::~Completer()
@@ -46,10 +47,30 @@ void Completer::setStrings(const QStringList &val)
         return;
 
     m_strings = val;
-    m_stringsModel->setStringList(m_strings);
-
     emit stringsChanged();
 
+    if(m_source == StringsSource)
+    {
+        this->updateStringsModel();
+        this->updateSuggestionsLater();
+    }
+}
+
+void Completer::setSource(Completer::Source val)
+{
+    if(m_source == val)
+        return;
+
+    m_source = val;
+    emit sourceChanged();
+
+    this->setStructure(m_source == StringsSource ? nullptr : ScriteDocument::instance()->structure());
+    if(m_source == StringsSource)
+        disconnect(ScriteDocument::instance(), &ScriteDocument::structureChanged, this, &Completer::onStructureChanged);
+    else
+        connect(ScriteDocument::instance(), &ScriteDocument::structureChanged, this, &Completer::onStructureChanged, Qt::UniqueConnection);
+
+    this->updateStringsModel();
     this->updateSuggestionsLater();
 }
 
@@ -64,6 +85,34 @@ void Completer::setMinimumPrefixLength(int val)
     this->updateSuggestionsLater();
 }
 
+void Completer::setCompletionPrefix(const QString &val)
+{
+    if(m_completionPrefix == val)
+        return;
+
+    m_completionPrefix = val;
+    if(m_completionModelInUse)
+        QCompleter::setCompletionPrefix(val);
+
+    emit completionPrefixChanged();
+
+    this->updateSuggestionsLater();
+}
+
+QAbstractItemModel *Completer::completionModel() const
+{
+    if(!m_completionModelInUse)
+    {
+        Completer *that = const_cast<Completer*>(this);
+        m_completionModelInUse = true;
+
+        that->updateStringsModel();
+        that->QCompleter::setCompletionPrefix(m_completionPrefix);
+    }
+
+    return QCompleter::completionModel();
+}
+
 void Completer::setSuggestionMode(Completer::SuggestionMode val)
 {
     if(m_suggestionMode == val)
@@ -97,28 +146,33 @@ void Completer::setSuggestions(const QStringList &val)
 
 void Completer::updateSuggestions()
 {
+    if(m_stringsModelStale)
+        this->updateStringsModel();
+
     QStringList vals;
 
-    const QString prefix = this->completionPrefix();
+    const QString prefix = m_completionPrefix;
     if(m_minimumPrefixLength > 0 && prefix.length() < m_minimumPrefixLength)
     {
         this->setSuggestions(vals);
         return;
     }
 
-    if(!m_strings.isEmpty())
+    const CompletionTrie *trie = this->sourceTrie();
+    if(trie != nullptr)
     {
-        const QAbstractItemModel *cmodel = this->completionModel();
-        const int rows = qMin(cmodel->rowCount(), this->maxVisibleItems());
-
-        for(int i=0; i<rows; i++)
+        vals = trie->complete(prefix, this->maxVisibleItems());
+        if(m_suggestionMode == AutoCompleteSuggestion)
         {
-            const QModelIndex index = cmodel->index(i, 0);
-            QString val = index.data(Qt::DisplayRole).toString();
-            if(m_suggestionMode == AutoCompleteSuggestion)
-                val = val.remove(0, prefix.length());
-            if(!val.isEmpty())
-                vals << val;
+            QStringList::iterator it = vals.begin();
+            while(it != vals.end())
+            {
+                it->remove(0, prefix.length());
+                if(it->isEmpty())
+                    it = vals.erase(it);
+                else
+                    ++it;
+            }
         }
     }
 
@@ -129,3 +183,100 @@ void Completer::updateSuggestionsLater()
 {
     m_updateSuggestionTimer.start(0, this);
 }
+
+void Completer::updateStringsModel()
+{
+    m_stringsModelStale = false;
+    if(!m_completionModelInUse)
+        return;
+
+    QStringList words = m_strings;
+    if(m_source != StringsSource)
+    {
+        const CompletionTrie *trie = this->sourceTrie();
+        words = trie ? trie->words() : QStringList();
+    }
+
+    // Resetting the model also resets the completion popup, so it is
+    // done only if the list of words actually changed.
+    if(m_stringsModel->stringList() != words)
+        m_stringsModel->setStringList(words);
+}
+
+void Completer::syncStringsTrie()
+{
+    // Strings are mostly replaced by a list shared with whoever set it, or one
+    // that differs from the previous list in a few places. Only the difference
+    // is applied to the trie.
+    if(m_trieStrings.isSharedWith(m_strings))
+        return;
+
+    QSet<QString> oldStrings, newStrings;
+    oldStrings.reserve(m_trieStrings.size());
+    newStrings.reserve(m_strings.size());
+    for(const QString &str : qAsConst(m_trieStrings))
+        oldStrings.insert(str);
+    for(const QString &str : qAsConst(m_strings))
+        newStrings.insert(str);
+
+    for(const QString &str : oldStrings)
+    {
+        if(!newStrings.contains(str))
+            m_stringsTrie.removeAll(str);
+    }
+
+    for(const QString &str : newStrings)
+    {
+        if(!oldStrings.contains(str))
+            m_stringsTrie.setWeight(str, 1);
+    }
+
+    m_trieStrings = m_strings;
+}
+
+void Completer::setStructure(Structure *val)
+{
+    if(m_structure == val)
+        return;
+
+    if(m_structure != nullptr)
+        disconnect(m_structure, nullptr, this, nullptr);
+
+    m_structure = val;
+
+    if(m_structure != nullptr)
+    {
+        connect(m_structure, &Structure::characterNamesChanged, this, &Completer::onSourceTrieChanged);
+        connect(m_structure, &Structure::locationHeadingsMapChanged, this, &Completer::onSourceTrieChanged);
+    }
+}
+
+void Completer::onStructureChanged()
+{
+    this->setStructure(ScriteDocument::instance()->structure());
+    this->onSourceTrieChanged();
+}
+
+void Completer::onSourceTrieChanged()
+{
+    // Names and locations change as the user types, so the model is
+    // brought up to date along with the suggestions, not on every change.
+    m_stringsModelStale = true;
+    this->updateSuggestionsLater();
+}
+
+const CompletionTrie *Completer::sourceTrie()
+{
+    switch(m_source)
+    {
+    case StringsSource:
+        this->syncStringsTrie();
+        return &m_stringsTrie;
+    case CharacterNamesSource:
+        return m_structure ? &m_structure->characterNameTrie() : nullptr;
+    case LocationsSource:
+        return m_structure ? &m_structure->locationTrie() : nullptr;
+    }
+
+    return nullptr;
+}
@@ -14,10 +14,13 @@
 #ifndef COMPLETER_H
 #define COMPLETER_H
 
+#include <QPointer>
 #include <QCompleter>
 
 #include "execlatertimer.h"
+#include "completiontrie.h"
 
+class Structure;
 class QStringListModel;
 class Completer : public QCompleter
 {
@@ -32,13 +35,32 @@ public:
     QStringList strings() const { return m_strings; }
     Q_SIGNAL void stringsChanged();
 
+    // Suggestions can also come from the current document, in which case they
+    // are ranked by how often they are used in the screenplay.
+    enum Source { StringsSource, CharacterNamesSource, LocationsSource };
+    Q_ENUM(Source)
+    Q_PROPERTY(Source source READ source WRITE setSource NOTIFY sourceChanged)
+    void setSource(Source val);
+    Source source() const { return m_source; }
+    Q_SIGNAL void sourceChanged();
+
     Q_PROPERTY(int minimumPrefixLength READ minimumPrefixLength WRITE setMinimumPrefixLength NOTIFY minimumPrefixLengthChanged)
     void setMinimumPrefixLength(int val);
     int minimumPrefixLength() const { return m_minimumPrefixLength; }
     Q_SIGNAL void minimumPrefixLengthChanged();
 
-    // model() method is available in parent class.
+    // QCompleter::setCompletionPrefix() filters its model right away. We only
+    // need that if someone actually looks at completionModel.
+    Q_PROPERTY(QString completionPrefix READ completionPrefix WRITE setCompletionPrefix NOTIFY completionPrefixChanged)
+    void setCompletionPrefix(const QString &val);
+    QString completionPrefix() const { return m_completionPrefix; }
+    Q_SIGNAL void completionPrefixChanged();
+
+    // model() method is available in parent class. The model is filled
+    // only when completionModel is first asked for, and is kept up to date
+    // from then on.
     Q_PROPERTY(QAbstractItemModel* completionModel READ completionModel CONSTANT)
+    QAbstractItemModel *completionModel() const;
 
     enum SuggestionMode { CompleteSuggestion, AutoCompleteSuggestion };
     Q_ENUM(SuggestionMode)
@@ -64,13 +86,26 @@ private:
     void setSuggestions(const QStringList &val);
     void updateSuggestions();
     void updateSuggestionsLater();
+    void updateStringsModel();
+    void syncStringsTrie();
+    void setStructure(Structure *val);
+    void onStructureChanged();
+    void onSourceTrieChanged();
+    const CompletionTrie *sourceTrie();
 
 private:
     QStringList m_strings;
+    QStringList m_trieStrings;
+    CompletionTrie m_stringsTrie;
+    Source m_source = StringsSource;
+    QPointer<Structure> m_structure;
+    QString m_completionPrefix;
     int m_minimumPrefixLength = 1;
     QStringList m_suggestions;
     SuggestionMode m_suggestionMode = AutoCompleteSuggestion;
     QStringListModel *m_stringsModel = nullptr;
+    mutable bool m_completionModelInUse = false;
+    bool m_stringsModelStale = false;
     ExecLaterTimer m_updateSuggestionTimer;
 };
 
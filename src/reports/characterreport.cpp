@@ -226,20 +226,17 @@ bool CharacterReport::doGenerate(QTextDocument *textDocument)
         cursor.insertBlock(blockFormat, charFormat);
         cursor.insertText("DETAIL:");
 
-        const int nrScenes = screenplay->elementCount();
+        const ScreenplaySnapshot snapshot = this->document()->screenplaySnapshot();
+        const int nrScenes = snapshot.sceneCount();
         for(int i=0; i<nrScenes; i++)
         {
             QTextTable *dialogueTable = nullptr;
             bool sceneInfoWritten = false;
-            ScreenplayElement *element = screenplay->elementAt(i);
-            Scene *scene = element->scene();
-            if(scene == nullptr)
-                continue;
 
             bool sceneHasSaidCharacters = false;
             Q_FOREACH(QString characterName, m_characterNames)
             {
-                if( scene->characterNames().contains(characterName) )
+                if( snapshot.sceneHasCharacter(i, snapshot.stringId(characterName)) )
                 {
                     sceneCount[characterName] = sceneCount.value(characterName,0)+1;
 
@@ -258,7 +255,7 @@ bool CharacterReport::doGenerate(QTextDocument *textDocument)
 
                         cursor.insertBlock(blockFormat, charFormat);
                         // cursor.insertText("Scene [" + QString::number(i+1) + "]: " + scene->heading()->text());
-                        TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, "Scene [" + element->resolvedSceneNumber() + "]: " + scene->heading()->text());
+                        TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, "Scene [" + snapshot.string(snapshot.sceneNumber(i)) + "]: " + snapshot.string(snapshot.sceneHeading(i)));
                         sceneInfoWritten = true;
                     }
 
@@ -271,13 +268,13 @@ bool CharacterReport::doGenerate(QTextDocument *textDocument)
 
             QMap<QString,bool> characterHasDialogue;
 
-            const int nrElements = scene->elementCount();
-            for(int j=0; j<nrElements; j++)
+            const int firstParagraph = snapshot.sceneFirstParagraph(i);
+            const int endParagraph = firstParagraph + snapshot.sceneParagraphCount(i);
+            for(int j=firstParagraph; j<endParagraph; j++)
             {
-                SceneElement *element = scene->elementAt(j);
-                if(element->type() == SceneElement::Character)
+                if(snapshot.paragraphType(j) == SceneElement::Character)
                 {
-                    QString characterName = element->formattedText();
+                    QString characterName = snapshot.paragraphText(j);
                     characterName = characterName.section('(', 0, 0).trimmed();
                     if(m_characterNames.contains(characterName))
                     {
@@ -318,18 +315,18 @@ bool CharacterReport::doGenerate(QTextDocument *textDocument)
                             while(1)
                             {
                                 ++j;
-                                element = scene->elementAt(j);
-                                if(element == nullptr)
+                                if(j >= endParagraph)
                                     break;
 
-                                if(element->type() != SceneElement::Parenthetical && element->type() != SceneElement::Dialogue)
+                                const SceneElement::Type type = snapshot.paragraphType(j);
+                                if(type != SceneElement::Parenthetical && type != SceneElement::Dialogue)
                                 {
                                     --j;
                                     break;
                                 }
 
-                                charFormat.setFontItalic(element->type() == SceneElement::Parenthetical);
-                                blockFormat.setBottomMargin(element->type() == SceneElement::Dialogue ? 10 : 0);
+                                charFormat.setFontItalic(type == SceneElement::Parenthetical);
+                                blockFormat.setBottomMargin(type == SceneElement::Dialogue ? 10 : 0);
 
                                 if(nr == 0)
                                 {
@@ -339,7 +336,7 @@ bool CharacterReport::doGenerate(QTextDocument *textDocument)
                                 else
                                     cursor.insertBlock(blockFormat, charFormat);
                                 // cursor.insertText(element->formattedText());
-                                TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, element->formattedText());
+                                TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, snapshot.paragraphText(j));
                                 ++nr;
                             }
                         }
@@ -54,16 +54,16 @@ void CharacterScreenplayReport::setCharacterNames(const QStringList &val)
 
 bool CharacterScreenplayReport::includeScreenplayElement(const ScreenplayElement *element) const
 {
-    const Scene *scene = element->scene();
-    if(scene == nullptr)
+    const ScreenplaySnapshot snapshot = this->document()->screenplaySnapshot();
+    const int sceneIndex = snapshot.sceneIndexOf(element);
+    if(sceneIndex < 0)
         return false;
 
     if(m_characterNames.isEmpty())
         return true;
 
-    const QStringList sceneCharacters = scene->characterNames();
     Q_FOREACH(QString characterName, m_characterNames)
-        if(sceneCharacters.contains(characterName))
+        if(snapshot.sceneHasCharacter(sceneIndex, snapshot.stringId(characterName)))
             return true;
 
     return false;
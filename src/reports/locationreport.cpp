@@ -28,7 +28,6 @@ LocationReport::~LocationReport()
 bool LocationReport::doGenerate(QTextDocument *textDocument)
 {
     static const int snippetLength = 40;
-    const Structure *structure = this->document()->structure();
     const Screenplay *screenplay = this->document()->screenplay();
 
     QTextDocument &document = *textDocument;
@@ -81,31 +80,32 @@ bool LocationReport::doGenerate(QTextDocument *textDocument)
     }
     this->progress()->tick();
 
-    const QMap< QString, QList<SceneHeading*> > locationHeadingsMap = structure->locationHeadingsMap();
-    this->progress()->setProgressStepFromCount(locationHeadingsMap.size()+2);
+    // Scenes grouped by location, then location type and then moment, each
+    // of which are sorted by name.
+    typedef QMap< QString, QList<int> > MomentScenesMap;
+    typedef QMap< QString, MomentScenesMap > LocationTypeMap;
 
-    QMap< QString, QList<SceneHeading*> >::const_iterator it = locationHeadingsMap.constBegin();
-    QMap< QString, QList<SceneHeading*> >::const_iterator end = locationHeadingsMap.constEnd();
+    const ScreenplaySnapshot snapshot = this->document()->screenplaySnapshot();
+    QMap<QString, LocationTypeMap> locationMap;
+    QMap<QString, int> locationSceneCount;
+    for(int i=0; i<snapshot.sceneCount(); i++)
+    {
+        const int location = snapshot.sceneLocation(i);
+        if(location < 0)
+            continue;
+
+        const QString locationName = snapshot.string(location);
+        locationMap[locationName][snapshot.string(snapshot.sceneLocationType(i))][snapshot.string(snapshot.sceneMoment(i))] << i;
+        ++locationSceneCount[locationName];
+    }
+
+    this->progress()->setProgressStepFromCount(locationMap.size()+2);
+
+    QMap<QString, LocationTypeMap>::const_iterator it = locationMap.constBegin();
+    QMap<QString, LocationTypeMap>::const_iterator end = locationMap.constEnd();
     while(it != end)
     {
         this->progress()->tick();
-        QMap< QString, QMap< QString,QList<SceneHeading*> > > map;
-        QList<SceneHeading*> headings = it.value();
-        for(int i=headings.size()-1; i>=0; i--)
-        {
-            SceneHeading *heading = headings.at(i);
-            Scene *scene = heading->scene();
-            if(screenplay->firstIndexOfScene(scene) < 0)
-                headings.removeAt(i);
-            else
-                map[heading->locationType()][heading->moment()].prepend(heading);
-        }
-
-        if(headings.isEmpty())
-        {
-            ++it;
-            continue;
-        }
 
         QTextBlockFormat blockFormat = defaultBlockFormat;
         blockFormat.setTopMargin(20);
@@ -116,14 +116,15 @@ bool LocationReport::doGenerate(QTextDocument *textDocument)
 
         cursor.insertBlock(blockFormat, charFormat);
         cursor.insertText(it.key());
-        cursor.insertText(" (" + QString::number(headings.size()) + " occurances)");
+        cursor.insertText(" (" + QString::number(locationSceneCount.value(it.key())) + " occurances)");
 
-        const QStringList locTypes = map.keys();
-        Q_FOREACH(QString locType, locTypes)
+        LocationTypeMap::const_iterator it1 = it.value().constBegin();
+        LocationTypeMap::const_iterator end1 = it.value().constEnd();
+        while(it1 != end1)
         {
-            const QMap< QString,QList<SceneHeading*> > momentMap = map.value(locType);
-            QMap< QString,QList<SceneHeading*> >::const_iterator it2 = momentMap.constBegin();
-            QMap< QString,QList<SceneHeading*> >::const_iterator end2 = momentMap.constEnd();
+            const MomentScenesMap &momentMap = it1.value();
+            MomentScenesMap::const_iterator it2 = momentMap.constBegin();
+            MomentScenesMap::const_iterator end2 = momentMap.constEnd();
             int counter = 0;
             while(it2 != end2)
             {
@@ -138,7 +139,7 @@ bool LocationReport::doGenerate(QTextDocument *textDocument)
             charFormat.setFontWeight(QFont::Bold);
 
             cursor.insertBlock(blockFormat, charFormat);
-            cursor.insertText(locType + " (" + QString::number(counter) + ")");
+            cursor.insertText(it1.key() + " (" + QString::number(counter) + ")");
 
             it2 = momentMap.constBegin();
             while(it2 != end2)
@@ -147,16 +148,15 @@ bool LocationReport::doGenerate(QTextDocument *textDocument)
                 blockFormat.setIndent(2);
                 charFormat = defaultCharFormat;
 
+                const QList<int> &scenes = it2.value();
+
                 cursor.insertBlock(blockFormat, charFormat);
-                TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, it2.value().first()->text());
-                cursor.insertText(" (" + QString::number(it.value().size()) + ")");
+                TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, snapshot.string(snapshot.sceneHeading(scenes.first())));
+                cursor.insertText(" (" + QString::number(scenes.size()) + ")");
 
-                Q_FOREACH(SceneHeading *heading, it2.value())
+                for(int scene : scenes)
                 {
-                    Scene *scene = heading->scene();
-                    int sceneNr = screenplay->firstIndexOfScene(scene)+1;
-                    ScreenplayElement *screenplayElement = screenplay->elementAt(sceneNr-1);
-                    QString snippet = scene->title();
+                    QString snippet = snapshot.sceneTitle(scene);
                     if(snippet.length() > snippetLength)
                         snippet = snippet.left(snippetLength-3) + "...";
 
@@ -165,15 +165,14 @@ bool LocationReport::doGenerate(QTextDocument *textDocument)
                     charFormat = defaultCharFormat;
 
                     cursor.insertBlock(blockFormat, charFormat);
-                    if(screenplayElement)
-                        cursor.insertText( "Scene #" + screenplayElement->resolvedSceneNumber() + + ": ");
-                    else
-                        cursor.insertText( "Scene #" + QString::number(sceneNr) + + ": ");
+                    cursor.insertText( "Scene #" + snapshot.string(snapshot.sceneNumber(scene)) + ": ");
                     TransliterationEngine::instance()->evaluateBoundariesAndInsertText(cursor, snippet);
                 }
 
                 ++it2;
             }
+
+            ++it1;
         }
 
         ++it;
@@ -45,22 +45,23 @@ void LocationScreenplayReport::setGenerateSummary(bool val)
 
 bool LocationScreenplayReport::includeScreenplayElement(const ScreenplayElement *element) const
 {
-    const Scene *scene = element->scene();
-    if(scene == nullptr)
+    const ScreenplaySnapshot snapshot = this->document()->screenplaySnapshot();
+    const int sceneIndex = snapshot.sceneIndexOf(element);
+    if(sceneIndex < 0)
         return false;
 
     if(m_locations.isEmpty())
         return true;
 
-    if(!scene->heading()->isEnabled())
+    const int location = snapshot.sceneLocation(sceneIndex);
+    if(location < 0)
         return false;
 
-    const bool ret = m_locations.contains(scene->heading()->location(), Qt::CaseInsensitive);
+    // Locations in the snapshot are in upper case.
+    const QString loc = snapshot.string(location);
+    const bool ret = m_locations.contains(loc, Qt::CaseInsensitive);
     if(ret)
-    {
-        const QString loc = scene->heading()->location().toUpper();
         m_locationSceneNumberList[loc] << element;
-    }
 
     return ret;
 }
@@ -36,6 +36,7 @@ void ProgressReport::setProxyFor(ProgressReport *val)
         disconnect(m_proxyFor, &ProgressReport::progressTextChanged, this, &ProgressReport::updateProgressTextFromProxy);
         disconnect(m_proxyFor, &ProgressReport::progressChanged, this, &ProgressReport::updateProgressFromProxy);
         disconnect(m_proxyFor, &ProgressReport::statusChanged, this, &ProgressReport::updateStatusFromProxy);
+        disconnect(m_proxyFor, &ProgressReport::cancelledChanged, this, &ProgressReport::updateCancelledFromProxy);
     }
 
     m_proxyFor = val;
@@ -46,16 +47,19 @@ void ProgressReport::setProxyFor(ProgressReport *val)
         connect(m_proxyFor, &ProgressReport::progressTextChanged, this, &ProgressReport::updateProgressTextFromProxy);
         connect(m_proxyFor, &ProgressReport::progressChanged, this, &ProgressReport::updateProgressFromProxy);
         connect(m_proxyFor, &ProgressReport::statusChanged, this, &ProgressReport::updateStatusFromProxy);
+        connect(m_proxyFor, &ProgressReport::cancelledChanged, this, &ProgressReport::updateCancelledFromProxy);
 
         this->setProgressText(m_proxyFor->progressText());
         this->setProgress(m_proxyFor->progress());
         this->setStatus(m_proxyFor->status());
+        this->setCancelled(m_proxyFor->isCancelled());
     }
     else
     {
         this->setProgressText(QString());
         this->setProgress(1.0);
         this->setStatus(NotStarted);
+        this->setCancelled(false);
     }
 
     emit proxyForChanged();
@@ -103,12 +107,31 @@ void ProgressReport::setProgress(qreal val)
     this->setStatus(InProgress);
 }
 
+void ProgressReport::cancel()
+{
+    // Only the report being proxied knows who to stop.
+    if(m_proxyFor != nullptr)
+        m_proxyFor->cancel();
+    else
+        this->setCancelled(true);
+}
+
+void ProgressReport::setCancelled(bool val)
+{
+    if(m_cancelled == val)
+        return;
+
+    m_cancelled = val;
+    emit cancelledChanged();
+}
+
 void ProgressReport::resetProxyFor()
 {
     m_proxyFor = nullptr;
     this->setProgressText(QString());
     this->setProgress(1.0);
     this->setStatus(NotStarted);
+    this->setCancelled(false);
     emit proxyForChanged();
 }
 
@@ -130,6 +153,12 @@ void ProgressReport::updateStatusFromProxy()
         this->setStatus(m_proxyFor->status());
 }
 
+void ProgressReport::updateCancelledFromProxy()
+{
+    if(m_proxyFor != nullptr)
+        this->setCancelled(m_proxyFor->isCancelled());
+}
+
 qreal ProgressReport::progressStep() const
 {
     return m_progressStep;
@@ -158,6 +187,7 @@ void ProgressReport::start()
 {
     if(m_progressText.isEmpty())
         this->setProgressText("Started");
+    this->setCancelled(false);
     this->setStatus(Started);
     this->setProgress(0);
 }
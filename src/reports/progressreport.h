@@ -38,9 +38,17 @@ public:
     Q_SIGNAL void progressTextChanged();
 
     Q_PROPERTY(qreal progress READ progress NOTIFY progressChanged)
+    void setProgress(qreal val);
     qreal progress() const { return m_progress; }
     Q_SIGNAL void progressChanged();
 
+    // Asks whoever is reporting progress to stop, at the next point where
+    // stopping is possible. Cancellation is reset by start().
+    Q_INVOKABLE void cancel();
+    Q_PROPERTY(bool cancelled READ isCancelled NOTIFY cancelledChanged)
+    bool isCancelled() const { return m_cancelled; }
+    Q_SIGNAL void cancelledChanged();
+
     enum Status
     {
         NotStarted = -1,
@@ -66,14 +74,16 @@ public:
 
 private:
     void setStatus(Status val);
-    void setProgress(qreal val);
+    void setCancelled(bool val);
     void resetProxyFor();
     void updateProgressTextFromProxy();
     void updateProgressFromProxy();
     void updateStatusFromProxy();
+    void updateCancelledFromProxy();
 
 private:
     Status m_status = NotStarted;
+    bool m_cancelled = false;
     qreal m_progress = 1.0;
     qreal m_progressStep = 0.0;
     QString m_progressText;
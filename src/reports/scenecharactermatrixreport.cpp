@@ -115,19 +115,18 @@ bool SceneCharacterMatrixReport::doGenerate(QTextDocument *document)
             m_characterNames = availableCharacters;
     }
 
+    const ScreenplaySnapshot snapshot = this->document()->screenplaySnapshot();
+
     // Lets compile a list of scene names.
-    auto compileSceneTitles = [screenplay]() {
+    auto compileSceneTitles = [snapshot]() {
         QStringList ret;
-        for(int i=0; i<screenplay->elementCount(); i++) {
-            const ScreenplayElement *element = screenplay->elementAt(i);
-            const Scene *scene = element->scene();
-            if(scene) {
-                QString title = QStringLiteral("[") + element->resolvedSceneNumber() + QStringLiteral("]: ")
-                        + (scene->heading()->isEnabled() ? scene->heading()->text() : QStringLiteral("NO SCENE HEADING"));
-                if(title.length() > 25)
-                    title = title.left(23) + "...";
-                ret << title;
-            }
+        for(int i=0; i<snapshot.sceneCount(); i++) {
+            const int heading = snapshot.sceneHeading(i);
+            QString title = QStringLiteral("[") + snapshot.string(snapshot.sceneNumber(i)) + QStringLiteral("]: ")
+                    + (heading >= 0 ? snapshot.string(heading) : QStringLiteral("NO SCENE HEADING"));
+            if(title.length() > 25)
+                title = title.left(23) + "...";
+            ret << title;
         }
         return ret;
     };
@@ -235,28 +234,26 @@ bool SceneCharacterMatrixReport::doGenerate(QTextDocument *document)
     }
 
     // Mark cells
-    int sceneNumber = 0;
-    for(int i=0; i<screenplay->elementCount(); i++)
+    QHash<int,int> characterIndex;
+    for(int i=0; i<m_characterNames.size(); i++)
+        characterIndex.insert(snapshot.stringId(m_characterNames.at(i)), i);
+
+    for(int sceneNumber=0; sceneNumber<snapshot.sceneCount(); sceneNumber++)
     {
-        const ScreenplayElement *element = screenplay->elementAt(i);
-        const Scene *scene = element->scene();
-        if(scene)
+        const QVector<int> characters = snapshot.sceneCharacters(sceneNumber);
+        for(int character : characters)
         {
-            const QStringList characters = scene->characterNames();
-            Q_FOREACH(QString character, characters)
-            {
-                const int row = m_type == SceneVsCharacter ? sceneNumber : rowHeadings.indexOf(character);
-                const int column = m_type == SceneVsCharacter ? columnHeadings.indexOf(character) : sceneNumber;
-                if(row < 0 || column < 0)
-                    continue;
-
-                QTextTableCell cell = table->cellAt(row+1, column+1);
-                QTextBlockFormat cellFormat;
-                cellFormat.setBackground(Qt::black);
-                cell.firstCursorPosition().setBlockFormat(cellFormat);
-            }
-
-            ++sceneNumber;
+            const int index = characterIndex.value(character, -1);
+            if(index < 0)
+                continue;
+
+            const int row = m_type == SceneVsCharacter ? sceneNumber : index;
+            const int column = m_type == SceneVsCharacter ? index : sceneNumber;
+
+            QTextTableCell cell = table->cellAt(row+1, column+1);
+            QTextBlockFormat cellFormat;
+            cellFormat.setBackground(Qt::black);
+            cell.firstCursorPosition().setBlockFormat(cellFormat);
         }
     }
 
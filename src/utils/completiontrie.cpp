@@ -0,0 +1,232 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "completiontrie.h"
+
+#include <queue>
+#include <algorithm>
+
+CompletionTrie::CompletionTrie()
+{
+    this->clear();
+}
+
+CompletionTrie::~CompletionTrie()
+{
+
+}
+
+bool CompletionTrie::add(const QString &word, int delta)
+{
+    if(word.isEmpty() || delta == 0)
+        return false;
+
+    int node = 0;
+    if(delta > 0)
+    {
+        for(const QChar &ch : word)
+            node = this->findOrAddChild(node, keyOf(ch));
+    }
+    else
+    {
+        node = this->findNode(word);
+        if(node < 0 || m_nodes.at(node).weight == 0)
+            return false;
+    }
+
+    Node &n = m_nodes[node];
+    const bool wasWord = n.weight > 0;
+    n.weight = qMax(0, n.weight + delta);
+    if(n.weight > 0 && !wasWord)
+        n.word = word;
+    else if(n.weight == 0)
+        n.word.clear();
+
+    this->updateMaxWeights(node);
+
+    if(wasWord == (n.weight > 0))
+        return false;
+
+    m_wordCount += wasWord ? -1 : 1;
+    if(wasWord)
+        this->releaseNode(node);
+    return true;
+}
+
+bool CompletionTrie::removeAll(const QString &word)
+{
+    const int w = this->weight(word);
+    return w > 0 ? this->add(word, -w) : false;
+}
+
+bool CompletionTrie::setWeight(const QString &word, int weight)
+{
+    return this->add(word, qMax(weight,0) - this->weight(word));
+}
+
+void CompletionTrie::clear()
+{
+    m_nodes.clear();
+    m_nodes.append(Node());
+    m_freeNodes.clear();
+    m_wordCount = 0;
+}
+
+int CompletionTrie::weight(const QString &word) const
+{
+    const int node = word.isEmpty() ? -1 : this->findNode(word);
+    return node < 0 ? 0 : m_nodes.at(node).weight;
+}
+
+QStringList CompletionTrie::complete(const QString &prefix, int maxResults) const
+{
+    QStringList ret;
+
+    const int start = this->findNode(prefix);
+    if(start < 0 || maxResults <= 0 || m_nodes.at(start).maxWeight == 0)
+        return ret;
+
+    // Best-first walk. A node is queued with the heaviest weight found in its
+    // subtree, so by the time a word is popped, nothing left in the queue can
+    // outweigh it. Ties go to whatever was queued first, which is shorter words
+    // first and then key order.
+    struct Entry
+    {
+        int weight;
+        int sequence;
+        int node;
+        bool word;
+        bool operator < (const Entry &other) const {
+            if(weight != other.weight)
+                return weight < other.weight;
+            return sequence > other.sequence;
+        }
+    };
+
+    int sequence = 0;
+    std::priority_queue<Entry> queue;
+    queue.push( Entry{m_nodes.at(start).maxWeight, sequence++, start, false} );
+
+    while(!queue.empty() && ret.size() < maxResults)
+    {
+        const Entry e = queue.top();
+        queue.pop();
+
+        const Node &n = m_nodes.at(e.node);
+        if(e.word)
+        {
+            ret << n.word;
+            continue;
+        }
+
+        if(n.weight > 0)
+            queue.push( Entry{n.weight, sequence++, e.node, true} );
+
+        for(int child : n.children)
+        {
+            const int childMax = m_nodes.at(child).maxWeight;
+            if(childMax > 0)
+                queue.push( Entry{childMax, sequence++, child, false} );
+        }
+    }
+
+    return ret;
+}
+
+int CompletionTrie::findChild(int node, ushort key) const
+{
+    const QVector<int> &children = m_nodes.at(node).children;
+    auto it = std::lower_bound(children.begin(), children.end(), key, [=](int child, ushort k) {
+        return m_nodes.at(child).key < k;
+    });
+    if(it != children.end() && m_nodes.at(*it).key == key)
+        return *it;
+    return -1;
+}
+
+int CompletionTrie::findOrAddChild(int node, ushort key)
+{
+    const int existing = this->findChild(node, key);
+    if(existing >= 0)
+        return existing;
+
+    int child = -1;
+    if(m_freeNodes.isEmpty())
+    {
+        child = m_nodes.size();
+        m_nodes.append(Node());
+    }
+    else
+    {
+        child = m_freeNodes.takeLast();
+        m_nodes[child] = Node();
+    }
+
+    m_nodes[child].key = key;
+    m_nodes[child].parent = node;
+
+    QVector<int> &children = m_nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), key, [=](int c, ushort k) {
+        return m_nodes.at(c).key < k;
+    });
+    children.insert(it, child);
+    return child;
+}
+
+int CompletionTrie::findNode(const QString &word) const
+{
+    int node = 0;
+    for(const QChar &ch : word)
+    {
+        node = this->findChild(node, keyOf(ch));
+        if(node < 0)
+            return -1;
+    }
+
+    return node;
+}
+
+void CompletionTrie::updateMaxWeights(int node)
+{
+    while(node >= 0)
+    {
+        Node &n = m_nodes[node];
+
+        int maxWeight = n.weight;
+        for(int child : qAsConst(n.children))
+            maxWeight = qMax(maxWeight, m_nodes.at(child).maxWeight);
+
+        if(n.maxWeight == maxWeight)
+            break;
+
+        n.maxWeight = maxWeight;
+        node = n.parent;
+    }
+}
+
+void CompletionTrie::releaseNode(int node)
+{
+    // Drops nodes on the path to the root that no longer lead to any word.
+    while(node > 0)
+    {
+        const Node &n = m_nodes.at(node);
+        if(n.weight > 0 || !n.children.isEmpty())
+            break;
+
+        const int parent = n.parent;
+        m_nodes[parent].children.removeOne(node);
+        m_nodes[node] = Node();
+        m_freeNodes.append(node);
+        node = parent;
+    }
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef COMPLETIONTRIE_H
+#define COMPLETIONTRIE_H
+
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Case-insensitive prefix tree of words, each with a weight (typically the
+ * number of times the word is used). complete() returns the heaviest words
+ * that begin with a prefix, without looking at the rest of the tree.
+ *
+ * Words are added and removed one at a time, so owners can keep a trie in sync
+ * with their own maps as they change.
+ */
+class CompletionTrie
+{
+public:
+    CompletionTrie();
+    ~CompletionTrie();
+
+    // Adds delta to the weight of word; the word is dropped once its weight
+    // falls to zero. Returns true if the set of words changed.
+    bool add(const QString &word, int delta=1);
+    bool remove(const QString &word, int delta=1) { return this->add(word, -delta); }
+    bool removeAll(const QString &word);
+    bool setWeight(const QString &word, int weight);
+    void clear();
+
+    int weight(const QString &word) const;
+    bool contains(const QString &word) const { return this->weight(word) > 0; }
+    int wordCount() const { return m_wordCount; }
+    bool isEmpty() const { return m_wordCount == 0; }
+
+    // Heaviest words beginning with prefix, at most maxResults of them. Words of
+    // equal weight are returned shorter ones first, then alphabetically.
+    QStringList complete(const QString &prefix, int maxResults) const;
+
+    QStringList words() const { return this->complete(QString(), m_wordCount); }
+
+private:
+    struct Node
+    {
+        ushort key = 0;
+        int parent = -1;
+        int weight = 0;             // weight of the word ending here, 0 if none
+        int maxWeight = 0;          // max weight of any word in this subtree
+        QString word;               // word ending here, as it was first added
+        QVector<int> children;      // sorted by key
+    };
+
+    int findChild(int node, ushort key) const;
+    int findOrAddChild(int node, ushort key);
+    int findNode(const QString &word) const;
+    void updateMaxWeights(int node);
+    void releaseNode(int node);
+    static ushort keyOf(const QChar &ch) { return ch.toUpper().unicode(); }
+
+private:
+    QVector<Node> m_nodes;
+    QVector<int> m_freeNodes;
+    int m_wordCount = 0;
+};
+
+#endif // COMPLETIONTRIE_H
@@ -13,39 +13,38 @@
 
 #include "execlatertimer.h"
 #include "application.h"
+#include "timeprofiler.h"
+#include "stallwatchdog.h"
 
-#include <QList>
+#include <climits>
+#include <QHash>
+#include <QMutex>
 #include <QThread>
+#include <QPointer>
+#include <QThreadStorage>
 
-#ifndef QT_NO_DEBUG
-Q_GLOBAL_STATIC(QList<ExecLaterTimer*>, ExecLaterTimerList)
-#endif
+// ExecLaterTimer IDs are handed out from a range that Qt's own timer IDs,
+// which are allocated from 1 upwards, are not going to reach. That way a
+// receiver never mistakes one for a QBasicTimer or QObject::startTimer() ID.
+static QAtomicInt ExecLaterTimerNextId(0x40000000);
+
+typedef QHash<int,ExecLaterTimer*> ExecLaterTimerMapType;
+Q_GLOBAL_STATIC(ExecLaterTimerMapType, ExecLaterTimerMap)
+Q_GLOBAL_STATIC(QMutex, ExecLaterTimerMapMutex)
 
 ExecLaterTimer *ExecLaterTimer::get(int timerId)
 {
-#ifndef QT_NO_DEBUG
-    Q_FOREACH(ExecLaterTimer *timer, *ExecLaterTimerList)
-    {
-        if(timer->timerId() == timerId)
-            return timer;
-    }
-#else
-    Q_UNUSED(timerId)
-#endif
-
-    return nullptr;
+    QMutexLocker locker(::ExecLaterTimerMapMutex());
+    return ::ExecLaterTimerMap()->value(timerId);
 }
 
 ExecLaterTimer::ExecLaterTimer(const QString &name, QObject *parent)
     : QObject(parent), m_name(name)
 {
-#ifndef QT_NO_DEBUG
-    ExecLaterTimerList->append(this);
-#endif
+    m_id = ::ExecLaterTimerNextId.fetchAndAddRelaxed(1);
 
-    m_timer.setObjectName("ExecLaterTimer");
-    m_timer.setSingleShot(!m_repeat);
-    connect(&m_timer, &QTimer::timeout, this, &ExecLaterTimer::onTimeout);
+    QMutexLocker locker(::ExecLaterTimerMapMutex());
+    ::ExecLaterTimerMap()->insert(m_id, this);
 }
 
 ExecLaterTimer::~ExecLaterTimer()
@@ -53,9 +52,8 @@ ExecLaterTimer::~ExecLaterTimer()
     m_destroyed = true;
     this->stop();
 
-#ifndef QT_NO_DEBUG
-    ExecLaterTimerList->removeOne(this);
-#endif
+    QMutexLocker locker(::ExecLaterTimerMapMutex());
+    ::ExecLaterTimerMap()->remove(m_id);
 }
 
 void ExecLaterTimer::setName(const QString &val)
@@ -64,6 +62,7 @@ void ExecLaterTimer::setName(const QString &val)
         return;
 
     m_name = val;
+    m_profileContextId = -1;
     emit nameChanged();
 }
 
@@ -73,22 +72,30 @@ void ExecLaterTimer::setRepeat(bool val)
         return;
 
     m_repeat = val;
-    m_timer.setSingleShot(!m_repeat);
     emit repeatChanged();
 }
 
-void ExecLaterTimer::start(int msec, QObject *object)
+void ExecLaterTimer::setPriority(Priority val)
 {
-    if(m_timer.isActive())
-        this->stop();
+    if(m_priority == val)
+        return;
 
+    m_priority = val;
+    emit priorityChanged();
+}
+
+void ExecLaterTimer::start(int msec, QObject *object)
+{
     if(object == nullptr || m_destroyed)
+    {
+        this->stop();
         return;
+    }
 
     if(object != m_object)
     {
-        if(object)
-            disconnect(object, &QObject::destroyed, this, &ExecLaterTimer::onObjectDestroyed);
+        if(m_object)
+            disconnect(m_object, &QObject::destroyed, this, &ExecLaterTimer::onObjectDestroyed);
 
         m_object = object;
 
@@ -96,30 +103,55 @@ void ExecLaterTimer::start(int msec, QObject *object)
             connect(object, &QObject::destroyed, this, &ExecLaterTimer::onObjectDestroyed);
     }
 
-    if(this->thread() != nullptr && this->thread()->eventDispatcher() != nullptr)
+    QThread *thread = QThread::currentThread();
+    if(thread->eventDispatcher() != nullptr)
     {
-        m_timer.start(msec);
-        m_timerId = m_timer.timerId();
+        m_interval = qMax(msec, 0);
+        ExecLaterScheduler::instance()->schedule(this, m_interval);
     }
     else
-        m_timerId = -1;
+        this->stop();
 }
 
 void ExecLaterTimer::stop()
 {
-    m_timer.stop();
+    if(m_scheduler != nullptr)
+        m_scheduler->cancel(this);
+
     m_timerId = -1;
 }
 
-void ExecLaterTimer::onTimeout()
+void ExecLaterTimer::deliver()
 {
-    if(m_object != nullptr && m_timerId >= 0)
-    {
+    if(m_object == nullptr || m_timerId < 0)
+        return;
+
 #ifndef QT_NO_DEBUG
-        qDebug() << "Posting Timer [" << m_name << "]." << m_timerId << " to " << m_object;
+    qDebug() << "Delivering Timer [" << m_name << "]." << m_timerId << " to " << m_object;
 #endif
+
+    if(m_object->thread() != QThread::currentThread())
+    {
         qApp->postEvent(m_object, new QTimerEvent(m_timerId));
+        return;
     }
+
+    // Deferred work shows up in time profiles (and in stall reports) under
+    // the name of the timer that triggered it.
+    if(m_profileContextId == -1)
+        m_profileContextId = TimeProfileTrace::registerContext(QStringLiteral("ExecLaterTimer ") + m_name);
+
+    // The receiver could delete this timer while handling the event.
+    const int profileContextId = m_profileContextId;
+    const QString name = m_name;
+    const qint64 startTime = TimeProfileTrace::timestamp();
+
+    QTimerEvent event(m_timerId);
+    QCoreApplication::sendEvent(m_object, &event);
+
+    const qint64 duration = TimeProfileTrace::timestamp()-startTime;
+    TimeProfileTrace::record(profileContextId, startTime, duration);
+    StallWatchdog::recordTimerDelivery(name, duration);
 }
 
 void ExecLaterTimer::onObjectDestroyed(QObject *ptr)
@@ -130,3 +162,159 @@ void ExecLaterTimer::onObjectDestroyed(QObject *ptr)
         this->stop();
     }
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ExecLaterScheduler *ExecLaterScheduler::instance()
+{
+    static QThreadStorage<ExecLaterScheduler*> theInstances;
+    if(!theInstances.hasLocalData())
+        theInstances.setLocalData(new ExecLaterScheduler);
+    return theInstances.localData();
+}
+
+ExecLaterScheduler::ExecLaterScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+}
+
+ExecLaterScheduler::~ExecLaterScheduler()
+{
+    // Timers may outlive the scheduler of their thread, if they are destroyed
+    // after the thread's local storage is cleaned up.
+    for(ExecLaterTimer *timer : qAsConst(m_queue))
+    {
+        timer->m_scheduler = nullptr;
+        timer->m_timerId = -1;
+    }
+    m_queue.clear();
+}
+
+void ExecLaterScheduler::setFrameBudget(int val)
+{
+    val = qMax(1, val);
+    if(m_frameBudget == val)
+        return;
+
+    m_frameBudget = val;
+    emit frameBudgetChanged();
+}
+
+void ExecLaterScheduler::schedule(ExecLaterTimer *timer, int msec)
+{
+    const qint64 dueTime = this->now() + msec;
+
+    if(timer->m_scheduler == this)
+    {
+        ++m_coalescedCount;
+        if(timer->m_dueTime == dueTime)
+            return;
+
+        m_queue.remove(timer->m_dueTime, timer);
+    }
+    else if(timer->m_scheduler != nullptr)
+        timer->m_scheduler->cancel(timer);
+
+    timer->m_scheduler = this;
+    timer->m_dueTime = dueTime;
+    timer->m_timerId = timer->m_id;
+    m_queue.insert(dueTime, timer);
+
+    this->arm();
+}
+
+void ExecLaterScheduler::cancel(ExecLaterTimer *timer)
+{
+    if(timer->m_scheduler != this)
+        return;
+
+    m_queue.remove(timer->m_dueTime, timer);
+    timer->m_scheduler = nullptr;
+
+    // If the timer is armed for an earlier deadline, it just finds nothing to
+    // do when it fires, and arms itself for the next one.
+    if(m_queue.isEmpty())
+    {
+        m_timer.stop();
+        m_armedFor = -1;
+    }
+}
+
+void ExecLaterScheduler::arm()
+{
+    if(m_queue.isEmpty())
+    {
+        m_timer.stop();
+        m_armedFor = -1;
+        return;
+    }
+
+    const qint64 dueTime = m_queue.firstKey();
+    if(m_timer.isActive() && m_armedFor <= dueTime)
+        return;
+
+    const qint64 delay = qBound<qint64>(0, dueTime-this->now(), INT_MAX);
+    m_timer.start(int(delay), this);
+    m_armedFor = dueTime;
+}
+
+void ExecLaterScheduler::timerEvent(QTimerEvent *event)
+{
+    if(event->timerId() != m_timer.timerId())
+    {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    m_timer.stop();
+    m_armedFor = -1;
+
+    // Timers that are due are delivered in priority order, and in the order
+    // of their due time within the same priority. Deliveries can start, stop
+    // or delete any timer, so each one is looked up afresh before delivery.
+    const qint64 currentTime = this->now();
+    QList< QPointer<ExecLaterTimer> > dueTimers[ExecLaterTimer::LowPriority+1];
+    for(auto it = m_queue.constBegin(); it != m_queue.constEnd() && it.key() <= currentTime; ++it)
+        dueTimers[it.value()->priority()].append( QPointer<ExecLaterTimer>(it.value()) );
+
+    QElapsedTimer budget;
+    budget.start();
+
+    bool budgetExhausted = false;
+    for(int p=ExecLaterTimer::HighPriority; p<=ExecLaterTimer::LowPriority && !budgetExhausted; p++)
+    {
+        for(const QPointer<ExecLaterTimer> &timerPtr : qAsConst(dueTimers[p]))
+        {
+            ExecLaterTimer *timer = timerPtr.data();
+            if(timer == nullptr || timer->m_scheduler != this || timer->m_dueTime > currentTime)
+                continue;
+
+            m_queue.remove(timer->m_dueTime, timer);
+            timer->m_scheduler = nullptr;
+            if(timer->m_repeat)
+            {
+                timer->m_scheduler = this;
+                timer->m_dueTime = currentTime + qMax(timer->m_interval, 1);
+                m_queue.insert(timer->m_dueTime, timer);
+            }
+
+            // The receiver may run a nested event loop (a modal dialog, or
+            // ScriteDocument::setBusy() processing events). Timers must keep
+            // firing in there, so the scheduler is armed for whatever is
+            // pending before handing over control.
+            this->arm();
+            timer->deliver();
+
+            if(budget.elapsed() >= m_frameBudget)
+            {
+                budgetExhausted = true;
+                break;
+            }
+        }
+    }
+
+    // Timers left over after the budget ran out are still due, so arm()
+    // schedules another round right after pending events are processed.
+    this->arm();
+}
@@ -14,9 +14,24 @@
 #ifndef EXECLATERTIMER_H
 #define EXECLATERTIMER_H
 
-#include <QTimer>
+#include <QMap>
+#include <QObject>
 #include <QString>
+#include <QBasicTimer>
+#include <QElapsedTimer>
 
+class ExecLaterScheduler;
+
+/**
+ * Delivers a QTimerEvent to an object, some time later. Receivers compare
+ * event->timerId() with timerId() in their timerEvent(), just like they would
+ * with a QBasicTimer.
+ *
+ * ExecLaterTimer instances don't own an OS timer. Pending timers of a thread are
+ * queued in that thread's ExecLaterScheduler, which runs on a single timer.
+ * Restarting a pending timer moves it in the queue, so repeated requests for the
+ * same deferred work coalesce into one.
+ */
 class ExecLaterTimer : public QObject
 {
     Q_OBJECT
@@ -27,6 +42,9 @@ public:
     ExecLaterTimer(const QString &name=QStringLiteral("Scrite ExecLaterTimer"), QObject *parent=nullptr);
     ~ExecLaterTimer();
 
+    enum Priority { HighPriority, NormalPriority, LowPriority };
+    Q_ENUM(Priority)
+
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     void setName(const QString &val);
     QString name() const { return m_name; }
@@ -37,23 +55,84 @@ public:
     bool isRepeat() const {return m_repeat; }
     Q_SIGNAL void repeatChanged();
 
+    // Among timers that are due at the same time, higher priority ones are
+    // delivered first. Lower priority ones may get pushed to the next slice.
+    Q_PROPERTY(Priority priority READ priority WRITE setPriority NOTIFY priorityChanged)
+    void setPriority(Priority val);
+    Priority priority() const { return m_priority; }
+    Q_SIGNAL void priorityChanged();
+
     void start(int msec, QObject *object);
     void stop();
     int timerId() const { return m_timerId; }
-    bool isActive() const { return m_timerId >= 0 && m_timer.isActive(); }
+    bool isActive() const { return m_timerId >= 0 && m_scheduler != nullptr; }
 
 private:
-    void onTimeout();
+    friend class ExecLaterScheduler;
+    void deliver();
     void onObjectDestroyed(QObject *ptr);
 
 private:
+    int m_id = -1;
     int m_timerId = -1;
+    int m_interval = 0;
+    int m_profileContextId = -1;
     bool m_repeat = false;
-    QTimer m_timer;
+    Priority m_priority = NormalPriority;
     QString m_name;
     bool m_destroyed = false;
     QObject *m_object = nullptr;
+
+    // Scheduler in which this timer is queued, and its due time in there.
+    ExecLaterScheduler *m_scheduler = nullptr;
+    qint64 m_dueTime = 0;
 };
 
-#endif // EXECLATERTIMER_H
+/**
+ * One per thread. Pending ExecLaterTimers are kept ordered by due time, and a
+ * single timer is armed for the earliest of them. Due timers are delivered in
+ * priority order, for at most frameBudget milliseconds at a time. Whatever
+ * remains is delivered after the event loop has had a chance to run.
+ */
+class ExecLaterScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ExecLaterScheduler *instance();
+    ~ExecLaterScheduler();
+
+    Q_PROPERTY(int frameBudget READ frameBudget WRITE setFrameBudget NOTIFY frameBudgetChanged)
+    void setFrameBudget(int val);
+    int frameBudget() const { return m_frameBudget; }
+    Q_SIGNAL void frameBudgetChanged();
 
+    Q_PROPERTY(int pendingCount READ pendingCount)
+    int pendingCount() const { return m_queue.size(); }
+
+    // Number of start() calls that moved an already pending timer,
+    // instead of queuing another one.
+    Q_PROPERTY(qint64 coalescedCount READ coalescedCount)
+    qint64 coalescedCount() const { return m_coalescedCount; }
+
+protected:
+    ExecLaterScheduler(QObject *parent=nullptr);
+    void timerEvent(QTimerEvent *event);
+
+private:
+    friend class ExecLaterTimer;
+    void schedule(ExecLaterTimer *timer, int msec);
+    void cancel(ExecLaterTimer *timer);
+    void arm();
+    qint64 now() const { return m_clock.elapsed(); }
+
+private:
+    QMultiMap<qint64,ExecLaterTimer*> m_queue;
+    QBasicTimer m_timer;
+    qint64 m_armedFor = -1;
+    QElapsedTimer m_clock;
+    int m_frameBudget = 10;
+    qint64 m_coalescedCount = 0;
+};
+
+#endif // EXECLATERTIMER_H
@@ -24,13 +24,24 @@ GarbageCollector::GarbageCollector(QObject *parent)
     : QObject(parent),
       m_timer("GarbageCollector.m_timer")
 {
-
+    // Sweeps can wait for more urgent deferred work.
+    m_timer.setPriority(ExecLaterTimer::LowPriority);
+    m_clock.start();
 }
 
 GarbageCollector::~GarbageCollector()
 {
     m_timer.stop();
-    qDeleteAll(m_objects);
+
+    // Deleting an object could delete others in the queue, which are then
+    // removed from m_objectSet by onObjectDestroyed().
+    while(!m_objectSet.isEmpty())
+    {
+        QSet<QObject*>::iterator it = m_objectSet.begin();
+        QObject *ptr = *it;
+        m_objectSet.erase(it);
+        delete ptr;
+    }
 }
 
 void GarbageCollector::avoidChildrenOf(QObject *parent)
@@ -38,13 +49,13 @@ void GarbageCollector::avoidChildrenOf(QObject *parent)
     if(parent != nullptr)
     {
         connect(parent, &QObject::destroyed, this, &GarbageCollector::onObjectDestroyed);
-        m_avoidList.append(parent);
+        m_avoidList.insert(parent);
     }
 }
 
 void GarbageCollector::add(QObject *ptr)
 {
-    if(ptr == nullptr || m_objects.contains(ptr) || m_shredder.contains(ptr))
+    if(ptr == nullptr || m_objectSet.contains(ptr))
         return;
 
     if(m_avoidList.contains(ptr->parent()))
@@ -55,8 +66,27 @@ void GarbageCollector::add(QObject *ptr)
 #endif
 
     connect(ptr, &QObject::destroyed, this, &GarbageCollector::onObjectDestroyed);
-    m_objects.append(ptr);
-    m_timer.start(100, this);
+
+    Entry entry;
+    entry.object = ptr;
+    entry.dueTime = m_clock.elapsed() + GracePeriod;
+    m_objects.append(entry);
+    m_objectSet.insert(ptr);
+    emit queueLengthChanged();
+
+    // If the timer is active, it is due no later than this object.
+    if(!m_timer.isActive())
+        m_timer.start(GracePeriod, this);
+}
+
+void GarbageCollector::setSweepBudget(int val)
+{
+    val = qMax(1, val);
+    if(m_sweepBudget == val)
+        return;
+
+    m_sweepBudget = val;
+    emit sweepBudgetChanged();
 }
 
 void GarbageCollector::timerEvent(QTimerEvent *event)
@@ -64,23 +94,73 @@ void GarbageCollector::timerEvent(QTimerEvent *event)
     if(event->timerId() == m_timer.timerId())
     {
         m_timer.stop();
-
-        m_shredder = m_objects;
-        m_objects.clear();
-
-        while(!m_shredder.isEmpty())
-        {
-            QDeferredDeleteEvent dde;
-            Application::instance()->sendEvent(m_shredder.takeFirst(), &dde);
-        }
+        this->sweep();
     }
 }
 
 void GarbageCollector::onObjectDestroyed(QObject *obj)
 {
-    if(m_objects.removeOne(obj))
-        m_timer.start(100, this);
+    if(m_objectSet.remove(obj))
+        emit queueLengthChanged();
+
+    m_avoidList.remove(obj);
+}
+
+void GarbageCollector::sweep()
+{
+    if(!m_sweeping)
+    {
+        m_sweeping = true;
+        m_sweepSlices = 0;
+        m_sweepCount = 0;
+        m_sweepDuration = 0;
+    }
+
+    const int countBefore = m_objectSet.size();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Objects are added in order of their due time, so the first one
+    // that isn't due yet ends the slice.
+    const qint64 now = m_clock.elapsed();
+    const qint64 budget = qint64(m_sweepBudget) * 1000000;
+    int index = 0;
+    while(index < m_objects.size() && m_objects.at(index).dueTime <= now)
+    {
+        QObject *ptr = m_objects.at(index++).object.data();
+        if(ptr == nullptr || !m_objectSet.remove(ptr))
+            continue;
+
+        QDeferredDeleteEvent dde;
+        Application::instance()->sendEvent(ptr, &dde);
+        ++m_sweepCount;
+
+        if(timer.nsecsElapsed() >= budget)
+            break;
+    }
+    m_objects.erase(m_objects.begin(), m_objects.begin()+index);
+
+    m_sweepDuration += timer.nsecsElapsed();
+    ++m_sweepSlices;
+
+    if(m_objectSet.size() != countBefore)
+        emit queueLengthChanged();
+
+    if(!m_objects.isEmpty() && m_objects.first().dueTime <= now)
+    {
+        // Let the event loop catch up before the next slice.
+        m_timer.start(0, this);
+        return;
+    }
+
+    m_sweeping = false;
+    m_lastSweepSlices = m_sweepSlices;
+    m_lastSweepCount = m_sweepCount;
+    m_lastSweepDuration = m_sweepDuration;
+    emit sweepFinished();
 
-    m_shredder.removeOne(obj);
-    m_avoidList.removeOne(obj);
+    // Objects added while sweeping are deleted once their grace period is over.
+    if(!m_objects.isEmpty())
+        m_timer.start(int(qMax<qint64>(m_objects.first().dueTime - m_clock.elapsed(), 0)), this);
 }
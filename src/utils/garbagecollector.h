@@ -14,14 +14,23 @@
 #ifndef GARBAGECOLLECTOR_H
 #define GARBAGECOLLECTOR_H
 
+#include <QSet>
 #include <QObject>
+#include <QVector>
+#include <QPointer>
+#include <QElapsedTimer>
 
 #include "execlatertimer.h"
 
 /**
  * We need a class that deletes a QObject much later than what
  * QObject::deleteLater() does for us. Thats what GarbageCollector
- * does for us.
+ * does for us. Every object is kept for at least GracePeriod
+ * milliseconds after it was added.
+ *
+ * Objects are deleted in slices, each of which runs for at most
+ * sweepBudget milliseconds, so that deleting a large number of
+ * objects doesn't freeze the UI.
  */
 
 class GarbageCollector : public QObject
@@ -32,19 +41,67 @@ public:
     static GarbageCollector *instance();
     ~GarbageCollector();
 
+    enum { GracePeriod = 100 }; // In milliseconds
+
     void avoidChildrenOf(QObject *parent);
     void add(QObject *ptr);
 
+    // In milliseconds
+    Q_PROPERTY(int sweepBudget READ sweepBudget WRITE setSweepBudget NOTIFY sweepBudgetChanged)
+    void setSweepBudget(int val);
+    int sweepBudget() const { return m_sweepBudget; }
+    Q_SIGNAL void sweepBudgetChanged();
+
+    Q_PROPERTY(int queueLength READ queueLength NOTIFY queueLengthChanged)
+    int queueLength() const { return m_objectSet.size(); }
+    Q_SIGNAL void queueLengthChanged();
+
+    // Time spent deleting objects in the last completed sweep, in milliseconds,
+    // and the number of slices it was spread over.
+    Q_PROPERTY(qreal lastSweepDuration READ lastSweepDuration NOTIFY sweepFinished)
+    qreal lastSweepDuration() const { return qreal(m_lastSweepDuration)/1e6; }
+
+    Q_PROPERTY(int lastSweepSlices READ lastSweepSlices NOTIFY sweepFinished)
+    int lastSweepSlices() const { return m_lastSweepSlices; }
+
+    Q_PROPERTY(int lastSweepCount READ lastSweepCount NOTIFY sweepFinished)
+    int lastSweepCount() const { return m_lastSweepCount; }
+
+    Q_SIGNAL void sweepFinished();
+
 protected:
     GarbageCollector(QObject *parent=nullptr);
     void timerEvent(QTimerEvent *event);
     void onObjectDestroyed(QObject *obj);
 
 private:
-    QObjectList m_objects;
-    QObjectList m_shredder;
-    QObjectList m_avoidList;
+    void sweep();
+
+private:
+    // m_objects keeps the order in which objects were added, along with
+    // the time at which each may be deleted. m_objectSet tells whether
+    // they are still due for deletion. Objects destroyed by other means
+    // are only taken out of m_objectSet, their entries in m_objects are
+    // skipped once the QPointer in there is null.
+    struct Entry
+    {
+        QPointer<QObject> object;
+        qint64 dueTime = 0;
+    };
+    QVector<Entry> m_objects;
+    QSet<QObject*> m_objectSet;
+    QSet<QObject*> m_avoidList;
     ExecLaterTimer m_timer;
+    QElapsedTimer m_clock;
+
+    int m_sweepBudget = 8;
+    bool m_sweeping = false;
+    int m_sweepSlices = 0;
+    int m_sweepCount = 0;
+    qint64 m_sweepDuration = 0;
+    int m_lastSweepSlices = 0;
+    int m_lastSweepCount = 0;
+    qint64 m_lastSweepDuration = 0;
 };
 
 #endif // GARBAGECOLLECTOR_H
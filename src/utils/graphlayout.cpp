@@ -1,11 +1,15 @@
 #include "graphlayout.h"
 
 #include <QMap>
+#include <QHash>
+#include <QVarLengthArray>
 #include <QtMath>
 #include <QLineF>
 #include <QTransform>
 #include <QElapsedTimer>
 
+#include <algorithm>
+
 using namespace GraphLayout;
 
 static const qreal fdg_constant = 0.0001;
@@ -171,3 +175,384 @@ bool ForceDirectedLayout::placeNodes(const QVector<QPointF> &forces, const Graph
 
     return moved;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const int bh_maxTreeDepth = 24;
+
+BarnesHutLayout::BarnesHutLayout()
+{
+
+}
+
+BarnesHutLayout::~BarnesHutLayout()
+{
+
+}
+
+bool BarnesHutLayout::layout(const Graph &graph)
+{
+    // Sanity checks
+    if(graph.nodes.isEmpty() || graph.edges.isEmpty())
+        return false;
+
+    const int nrNodes = graph.nodes.size();
+
+    QHash<const AbstractNode*,int> nodeIndexMap;
+    nodeIndexMap.reserve(nrNodes);
+    for(int i=0; i<nrNodes; i++)
+        nodeIndexMap.insert(graph.nodes.at(i), i);
+
+    // Place the nodes in a circle and figure out maximum size of nodes
+    GraphData data;
+    data.positions.resize(nrNodes);
+    data.movable.resize(nrNodes);
+
+    const qreal angleStep = 2*M_PI / qreal(nrNodes);
+    for(int i=0; i<nrNodes; i++)
+    {
+        const AbstractNode *node = graph.nodes.at(i);
+        data.movable[i] = node->canBeMoved();
+        if(data.movable[i])
+        {
+            const qreal angle = angleStep * qreal(i);
+            data.positions[i] = QPointF(qCos(angle), qSin(angle));
+        }
+        else
+            data.positions[i] = node->position();
+
+        const QSizeF nodeSize = node->size();
+        data.maxNodeSize.setWidth( qMax(nodeSize.width(),data.maxNodeSize.width()) );
+        data.maxNodeSize.setHeight( qMax(nodeSize.height(),data.maxNodeSize.height()) );
+    }
+
+    data.edges.reserve(graph.edges.size());
+    for(const AbstractEdge *edge : graph.edges)
+        data.edges.append( qMakePair(nodeIndexMap.value(edge->node1(), -1), nodeIndexMap.value(edge->node2(), -1)) );
+
+    if( !this->layout(data) )
+        return false;
+
+    for(int i=0; i<nrNodes; i++)
+    {
+        if(data.movable.at(i))
+            graph.nodes.at(i)->setPosition( data.positions.at(i) * data.scale );
+    }
+
+    // Get the edges to compute their paths
+    for(AbstractEdge *edge : graph.edges)
+        edge->evaluateEdge();
+
+    return true;
+}
+
+bool BarnesHutLayout::layout(GraphData &data, const ProgressFunction &progress)
+{
+    // Sanity checks
+    if(data.positions.isEmpty() || data.edges.isEmpty())
+        return false;
+
+    const int nrNodes = data.positions.size();
+    const int nrEdges = data.edges.size();
+    if(data.movable.size() != nrNodes)
+        data.movable.fill(true, nrNodes);
+
+    // Just like ForceDirectedLayout, we don't bother laying out graphs that have
+    // zombie nodes or edges connecting to nodes outside the graph.
+    m_edgeNode1.resize(nrEdges);
+    m_edgeNode2.resize(nrEdges);
+
+    QVector<int> refCounts(nrNodes, 0);
+    for(int i=0; i<nrEdges; i++)
+    {
+        const int i1 = data.edges.at(i).first;
+        const int i2 = data.edges.at(i).second;
+        if(i1 < 0 || i2 < 0 || i1 >= nrNodes || i2 >= nrNodes)
+            return false;
+        m_edgeNode1[i] = i1;
+        m_edgeNode2[i] = i2;
+        refCounts[i1]++;
+        refCounts[i2]++;
+    }
+
+    if(refCounts.contains(0))
+        return false;
+
+    m_x.resize(nrNodes);
+    m_y.resize(nrNodes);
+    m_fx.resize(nrNodes);
+    m_fy.resize(nrNodes);
+    m_movable = data.movable;
+    for(int i=0; i<nrNodes; i++)
+    {
+        m_x[i] = data.positions.at(i).x();
+        m_y[i] = data.positions.at(i).y();
+    }
+
+    // Scale the placement of nodes such that we consider the node sizes.
+    const qreal minNodeSpacingPx = this->minimumEdgeLength() + QLineF( QPointF(0,0), QPointF(data.maxNodeSize.width(),data.maxNodeSize.height()) ).length();
+    auto updateData = [&]() {
+        for(int i=0; i<nrNodes; i++)
+            data.positions[i] = QPointF(m_x.at(i), m_y.at(i));
+        const qreal minNodeSpacing = this->minimumNodeSpacing();
+        data.scale = minNodeSpacing > 0 ? minNodeSpacingPx / minNodeSpacing : 1.0;
+    };
+
+    // Perform force directed graph layout
+    int nrIterations = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+
+    if(progress)
+    {
+        updateData();
+        if( !progress(data) )
+            return false;
+    }
+
+    while(timer.elapsed() < this->maxTime())
+    {
+        std::fill(m_fx.begin(), m_fx.end(), 0.0);
+        std::fill(m_fy.begin(), m_fy.end(), 0.0);
+
+        this->buildQuadTree();
+        this->calculateRepulsion();
+        this->calculateAttraction();
+        const bool moved = this->placeNodes();
+
+        ++nrIterations;
+        if(!moved || (maxIterations() > 0 && nrIterations >= maxIterations()))
+            break;
+
+        if(progress && progressTimer.elapsed() >= m_progressInterval)
+        {
+            updateData();
+            if( !progress(data) )
+            {
+                m_cells.clear();
+                return false;
+            }
+            progressTimer.restart();
+        }
+    }
+
+    m_cells.clear();
+    updateData();
+
+    return true;
+}
+
+void BarnesHutLayout::buildQuadTree()
+{
+    const int nrNodes = m_x.size();
+
+    const auto xr = std::minmax_element(m_x.constBegin(), m_x.constEnd());
+    const auto yr = std::minmax_element(m_y.constBegin(), m_y.constEnd());
+    const qreal size = qMax( qMax(*xr.second - *xr.first, *yr.second - *yr.first), 1e-6 ) * 1.01;
+
+    QuadTreeCell root;
+    root.x = *xr.first - size*0.005;
+    root.y = *yr.first - size*0.005;
+    root.size = size;
+
+    m_cells.clear();
+    m_cells.reserve(nrNodes*4);
+    m_cells.append(root);
+
+    for(int i=0; i<nrNodes; i++)
+        this->insertBody(i);
+}
+
+void BarnesHutLayout::insertBody(int body)
+{
+    const qreal bx = m_x.at(body);
+    const qreal by = m_y.at(body);
+
+    int index = 0;
+    for(int depth=0; ; depth++)
+    {
+        if( qFuzzyIsNull(m_cells.at(index).mass) )
+        {
+            QuadTreeCell &cell = m_cells[index];
+            cell.body = body;
+            cell.mass = 1;
+            cell.cx = bx;
+            cell.cy = by;
+            return;
+        }
+
+        if(m_cells.at(index).firstChild < 0)
+        {
+            // Nodes that land on top of each other would otherwise cause endless
+            // subdivision. Beyond a certain depth, we just let them share a cell.
+            if(depth >= bh_maxTreeDepth)
+            {
+                QuadTreeCell &cell = m_cells[index];
+                cell.cx = (cell.cx*cell.mass + bx) / (cell.mass + 1);
+                cell.cy = (cell.cy*cell.mass + by) / (cell.mass + 1);
+                cell.mass += 1;
+                cell.body = -1;
+                return;
+            }
+
+            // Subdivide the leaf and push its body down into one of the children.
+            const QuadTreeCell leaf = m_cells.at(index);
+            const qreal half = leaf.size / 2.0;
+            const int firstChild = m_cells.size();
+            for(int q=0; q<4; q++)
+            {
+                QuadTreeCell child;
+                child.x = leaf.x + ((q & 1) ? half : 0);
+                child.y = leaf.y + ((q & 2) ? half : 0);
+                child.size = half;
+                m_cells.append(child);
+            }
+
+            QuadTreeCell &child = m_cells[firstChild + this->quadrant(leaf, leaf.cx, leaf.cy)];
+            child.body = leaf.body;
+            child.mass = leaf.mass;
+            child.cx = leaf.cx;
+            child.cy = leaf.cy;
+
+            m_cells[index].firstChild = firstChild;
+            m_cells[index].body = -1;
+        }
+
+        QuadTreeCell &cell = m_cells[index];
+        cell.cx = (cell.cx*cell.mass + bx) / (cell.mass + 1);
+        cell.cy = (cell.cy*cell.mass + by) / (cell.mass + 1);
+        cell.mass += 1;
+        index = cell.firstChild + this->quadrant(cell, bx, by);
+    }
+}
+
+int BarnesHutLayout::quadrant(const QuadTreeCell &cell, qreal x, qreal y) const
+{
+    const qreal half = cell.size / 2.0;
+    return (x >= cell.x + half ? 1 : 0) | (y >= cell.y + half ? 2 : 0);
+}
+
+void BarnesHutLayout::calculateRepulsion()
+{
+    const qreal k = fdg_constant;
+    const qreal theta2 = m_theta * m_theta;
+    const int nrNodes = m_x.size();
+
+    QVarLengthArray<int,128> stack;
+    for(int i=0; i<nrNodes; i++)
+    {
+        const qreal x = m_x.at(i);
+        const qreal y = m_y.at(i);
+        qreal fx = 0, fy = 0;
+
+        stack.clear();
+        stack.append(0);
+        while(!stack.isEmpty())
+        {
+            const QuadTreeCell &cell = m_cells.at(stack.last());
+            stack.removeLast();
+
+            if(qFuzzyIsNull(cell.mass) || cell.body == i)
+                continue;
+
+            const qreal dx = cell.cx - x;
+            const qreal dy = cell.cy - y;
+            const qreal d2 = dx*dx + dy*dy;
+
+            if(cell.firstChild < 0 || cell.size*cell.size < theta2*d2)
+            {
+                // Force is k/d along the unit vector (dx,dy)/d, which is
+                // k*(dx,dy)/d^2 -- no trigonometry needed.
+                if(qFuzzyIsNull(d2))
+                    continue;
+                const qreal f = k * cell.mass / d2;
+                fx -= f*dx;
+                fy -= f*dy;
+            }
+            else
+            {
+                for(int q=0; q<4; q++)
+                    stack.append(cell.firstChild + q);
+            }
+        }
+
+        m_fx[i] += fx;
+        m_fy[i] += fy;
+    }
+}
+
+void BarnesHutLayout::calculateAttraction()
+{
+    const qreal k = fdg_constant;
+    const int nrEdges = m_edgeNode1.size();
+    for(int e=0; e<nrEdges; e++)
+    {
+        const int i = m_edgeNode1.at(e);
+        const int j = m_edgeNode2.at(e);
+        const qreal dx = m_x.at(j) - m_x.at(i);
+        const qreal dy = m_y.at(j) - m_y.at(i);
+
+        // Force is k*d^2 along the unit vector (dx,dy)/d, which is k*d*(dx,dy).
+        const qreal f = k * qSqrt(dx*dx + dy*dy);
+        m_fx[i] += f*dx;
+        m_fy[i] += f*dy;
+        m_fx[j] -= f*dx;
+        m_fy[j] -= f*dy;
+    }
+}
+
+bool BarnesHutLayout::placeNodes()
+{
+    bool moved = false;
+    const int nrNodes = m_x.size();
+    for(int i=0; i<nrNodes; i++)
+    {
+        if(!m_movable.at(i))
+            continue;
+
+        const qreal fx = m_fx.at(i);
+        const qreal fy = m_fy.at(i);
+        if( qFuzzyIsNull(fx) && qFuzzyIsNull(fy) )
+            continue;
+
+        m_x[i] += fx;
+        m_y[i] += fy;
+        moved = true;
+    }
+
+    return moved;
+}
+
+qreal BarnesHutLayout::minimumNodeSpacing() const
+{
+    // Sweep over nodes sorted by x, so that we only compare nodes whose x
+    // distance is smaller than the smallest spacing found so far.
+    const int nrNodes = m_x.size();
+    QVector<int> order(nrNodes);
+    for(int i=0; i<nrNodes; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [=](int a, int b) {
+        return m_x.at(a) < m_x.at(b);
+    });
+
+    qreal minSpacing2 = 240000.0 * 240000.0;
+    for(int a=0; a<nrNodes; a++)
+    {
+        const int i = order.at(a);
+        for(int b=a+1; b<nrNodes; b++)
+        {
+            const int j = order.at(b);
+            const qreal dx = m_x.at(j) - m_x.at(i);
+            if(dx*dx >= minSpacing2)
+                break;
+            const qreal dy = m_y.at(j) - m_y.at(i);
+            minSpacing2 = qMin(minSpacing2, dx*dx + dy*dy);
+        }
+    }
+
+    return qSqrt(minSpacing2);
+}
@@ -15,10 +15,14 @@
 #define GRAPHLAYOUT_H
 
 #include <QSizeF>
+#include <QtGlobal>
+#include <QPair>
 #include <QPointF>
 #include <QVector>
 #include <QVector2D>
 
+#include <functional>
+
 namespace GraphLayout
 {
 
@@ -63,6 +67,17 @@ struct Graph
     QVector<AbstractEdge*> edges;
 };
 
+// Plain copy of a graph, which doesn't refer to any node or edge object. Layouts
+// that accept this can be run from a worker thread.
+struct GraphData
+{
+    QVector<QPointF> positions;         // in layout space
+    QVector<bool> movable;
+    QVector< QPair<int,int> > edges;    // indexes into positions
+    QSizeF maxNodeSize = QSizeF(0,0);
+    qreal scale = 1.0;                  // maps layout space to pixels
+};
+
 class AbstractLayout
 {
 public:
@@ -99,6 +114,68 @@ private:
     bool placeNodes(const QVector<QPointF> &forces, const Graph &graph);
 };
 
+// Same force model as ForceDirectedLayout, but repulsion is approximated using a
+// Barnes-Hut quadtree, making each iteration O(n log n) instead of O(n^2).
+// https://en.wikipedia.org/wiki/Barnes%E2%80%93Hut_simulation
+class BarnesHutLayout : public AbstractLayout
+{
+public:
+    BarnesHutLayout();
+    ~BarnesHutLayout();
+
+    // Cells whose size to distance ratio is below theta are treated as a single
+    // body. Zero makes this an exact (and slow) all-pairs computation.
+    void setTheta(qreal val) { m_theta = qMax(val, 0.0); }
+    qreal theta() const { return m_theta; }
+
+    // Interval (in milliseconds) at which intermediate positions are reported
+    // to the progress function.
+    void setProgressInterval(int val) { m_progressInterval = qMax(val, 0); }
+    int progressInterval() const { return m_progressInterval; }
+
+    // AbstractGraphLayout interface
+    bool layout(const Graph &graph);
+
+    // Positions already in data are used as starting positions, which allows an
+    // earlier layout to be refined. The progress function is called with
+    // intermediate positions; returning false from it cancels the layout.
+    typedef std::function<bool(const GraphData &)> ProgressFunction;
+    bool layout(GraphData &data, const ProgressFunction &progress=ProgressFunction());
+
+private:
+    struct QuadTreeCell
+    {
+        qreal x = 0, y = 0, size = 0;   // square region covered by the cell
+        qreal cx = 0, cy = 0;           // center of mass
+        qreal mass = 0;
+        int body = -1;                  // body index, if this is a leaf cell
+        int firstChild = -1;            // 4 children are stored contiguously
+    };
+
+    void buildQuadTree();
+    void insertBody(int body);
+    int quadrant(const QuadTreeCell &cell, qreal x, qreal y) const;
+    void calculateRepulsion();
+    void calculateAttraction();
+    bool placeNodes();
+    qreal minimumNodeSpacing() const;
+
+private:
+    qreal m_theta = 0.8;
+    int m_progressInterval = 50;
+
+    // Node data is kept in a struct-of-arrays form, so that the per-node loops
+    // work on contiguous memory.
+    QVector<qreal> m_x;
+    QVector<qreal> m_y;
+    QVector<qreal> m_fx;
+    QVector<qreal> m_fy;
+    QVector<bool> m_movable;
+    QVector<int> m_edgeNode1;
+    QVector<int> m_edgeNode2;
+    QVector<QuadTreeCell> m_cells;
+};
+
 }
 
 #endif // GRAPHLAYOUT_H
@@ -0,0 +1,258 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "stallwatchdog.h"
+#include "application.h"
+#include "timeprofiler.h"
+#include "execlatertimer.h"
+
+#include <cstdio>
+#include <QFile>
+#include <QThread>
+#include <QSettings>
+#include <QMetaEnum>
+#include <QDateTime>
+#include <QJsonDocument>
+
+StallWatchdog *StallWatchdog::m_active = nullptr;
+
+StallWatchdog *StallWatchdog::instance()
+{
+    static StallWatchdog *theInstance = new StallWatchdog(qApp);
+    return theInstance;
+}
+
+StallWatchdog::StallWatchdog(QObject *parent)
+    : QObject(parent)
+{
+    this->reset();
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    if(m_active == this)
+        m_active = nullptr;
+}
+
+void StallWatchdog::configure(QSettings *settings)
+{
+    bool enable = false;
+    int thresholdMs = m_threshold;
+
+    if(settings != nullptr)
+    {
+        enable = settings->value( QStringLiteral("Diagnostics/stallWatchdog"), false ).toBool();
+        thresholdMs = settings->value( QStringLiteral("Diagnostics/stallThreshold"), thresholdMs ).toInt();
+    }
+
+    bool ok = false;
+    const int envThreshold = qEnvironmentVariableIntValue("SCRITE_STALL_THRESHOLD", &ok);
+    if(ok && envThreshold > 0)
+    {
+        enable = true;
+        thresholdMs = envThreshold;
+    }
+
+    this->setThreshold(thresholdMs);
+    this->setEnabled(enable);
+}
+
+void StallWatchdog::setEnabled(bool val)
+{
+    if(m_enabled == val)
+        return;
+
+    m_enabled = val;
+
+    // Dispatches that are already in flight must finish against the
+    // depth counter they started with, so m_depth is left untouched here.
+    m_active = val ? this : nullptr;
+    if(val)
+        m_sessionStart = QDateTime::currentMSecsSinceEpoch();
+
+    emit enabledChanged();
+}
+
+void StallWatchdog::setThreshold(int val)
+{
+    val = qMax(1, val);
+    if(m_threshold == val)
+        return;
+
+    m_threshold = val;
+    m_thresholdNs = qint64(val) * 1000000;
+    emit thresholdChanged();
+}
+
+QJsonArray StallWatchdog::histogram() const
+{
+    QJsonArray ret;
+    for(int i=0; i<HistogramBuckets; i++)
+    {
+        QJsonObject item;
+        item.insert( QStringLiteral("from"), i == 0 ? 0 : (1 << (i-1)) );
+        item.insert( QStringLiteral("to"), i == HistogramBuckets-1 ? -1 : (1 << i) );
+        item.insert( QStringLiteral("count"), m_histogram[i] );
+        ret.append(item);
+    }
+
+    return ret;
+}
+
+QJsonObject StallWatchdog::report() const
+{
+    QJsonObject ret;
+    ret.insert( QStringLiteral("application"), qApp->applicationName() + QStringLiteral(" ") + qApp->applicationVersion() );
+    ret.insert( QStringLiteral("sessionStart"), QDateTime::fromMSecsSinceEpoch(m_sessionStart).toString(Qt::ISODate) );
+    ret.insert( QStringLiteral("threshold"), m_threshold );
+    ret.insert( QStringLiteral("dispatchCount"), m_dispatchCount );
+    ret.insert( QStringLiteral("stallCount"), m_stallCount );
+    ret.insert( QStringLiteral("maxDuration"), qreal(m_maxDuration)/1e6 );
+    ret.insert( QStringLiteral("histogram"), this->histogram() );
+    ret.insert( QStringLiteral("stalls"), m_stalls );
+    return ret;
+}
+
+bool StallWatchdog::exportReport(const QString &fileName) const
+{
+    QFile file(fileName);
+    if( !file.open(QFile::WriteOnly) )
+        return false;
+
+    file.write( QJsonDocument(this->report()).toJson() );
+    return true;
+}
+
+void StallWatchdog::reset()
+{
+    m_dispatchCount = 0;
+    m_maxDuration = 0;
+    for(int i=0; i<HistogramBuckets; i++)
+        m_histogram[i] = 0;
+    m_sessionStart = QDateTime::currentMSecsSinceEpoch();
+
+    if(m_stallCount > 0 || !m_stalls.isEmpty())
+    {
+        m_stallCount = 0;
+        m_stalls = QJsonArray();
+        emit stallsChanged();
+    }
+}
+
+void StallWatchdog::recordDispatch(const char *className, QEvent::Type eventType, const QString &timerName, qint64 startTime, qint64 duration)
+{
+    ++m_dispatchCount;
+    m_maxDuration = qMax(m_maxDuration, duration);
+
+    const qint64 durationMs = duration/1000000;
+    int bucket = 0;
+    while(bucket < HistogramBuckets-1 && (qint64(1) << bucket) <= durationMs)
+        ++bucket;
+    ++m_histogram[bucket];
+
+    if(duration < m_thresholdNs)
+        return;
+
+    qint64 scopeDuration = 0;
+    const QString scope = TimeProfileTrace::slowestScopeSince(startTime, &scopeDuration);
+
+    const char *eventName = QMetaEnum::fromType<QEvent::Type>().valueToKey(eventType);
+    const QString eventTypeName = eventName ? QString::fromLatin1(eventName) : QString::number(int(eventType));
+
+    // Release builds don't print qDebug() output, stalls must show up there too.
+    fprintf(stderr, "Stall: %.1f ms dispatching %s to %s%s%s%s%s\n",
+            qreal(duration)/1e6, qPrintable(eventTypeName), className,
+            timerName.isEmpty() ? "" : " from timer ", qPrintable(timerName),
+            scope.isEmpty() ? "" : ", slowest scope ", qPrintable(scope));
+    fflush(stderr);
+
+    QJsonObject stall;
+    stall.insert( QStringLiteral("timestamp"), QDateTime::currentDateTime().toString(Qt::ISODate) );
+    stall.insert( QStringLiteral("duration"), qreal(duration)/1e6 );
+    stall.insert( QStringLiteral("receiver"), QString::fromLatin1(className) );
+    stall.insert( QStringLiteral("event"), eventTypeName );
+    if(!timerName.isEmpty())
+        stall.insert( QStringLiteral("timer"), timerName );
+    if(!scope.isEmpty())
+    {
+        stall.insert( QStringLiteral("scope"), scope );
+        stall.insert( QStringLiteral("scopeDuration"), qreal(scopeDuration)/1e6 );
+    }
+
+    ++m_stallCount;
+    m_stalls.append(stall);
+    while(m_stalls.size() > MaxStallRecords)
+        m_stalls.removeFirst();
+
+    // Emitting synchronously would run QML handlers from within notify(),
+    // so we let them know from the next dispatch instead.
+    QMetaObject::invokeMethod(this, "stallsChanged", Qt::QueuedConnection);
+}
+
+void StallWatchdog::recordTimerDelivery(const QString &timerName, qint64 duration)
+{
+    StallWatchdog *watchdog = StallWatchdog::m_active;
+    if(watchdog == nullptr || watchdog->m_depth == 0 || QThread::currentThread() != watchdog->thread())
+        return;
+
+    if(duration > watchdog->m_timerDuration)
+    {
+        watchdog->m_timerName = timerName;
+        watchdog->m_timerDuration = duration;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+StallWatchdog::DispatchScope::DispatchScope(QObject *object, QEvent *event)
+{
+    StallWatchdog *watchdog = StallWatchdog::m_active;
+    if(watchdog == nullptr || QThread::currentThread() != watchdog->thread())
+        return;
+
+    m_watchdog = watchdog;
+    if(m_watchdog->m_depth++ > 0)
+        return;
+
+    // The receiver may be deleted by the time the dispatch is done,
+    // so whatever we want to report about it is captured now.
+    m_className = object->metaObject()->className();
+    m_eventType = event->type();
+    m_watchdog->m_timerName.clear();
+    m_watchdog->m_timerDuration = -1;
+
+    // Timers running on other threads post their events here directly. Those
+    // events carry the ExecLaterTimer's own ID.
+    if(m_eventType == QEvent::Timer && qobject_cast<ExecLaterScheduler*>(object) == nullptr)
+    {
+        ExecLaterTimer *timer = ExecLaterTimer::get( static_cast<QTimerEvent*>(event)->timerId() );
+        if(timer != nullptr)
+            m_watchdog->m_timerName = timer->name();
+    }
+
+    m_startTime = TimeProfileTrace::timestamp();
+}
+
+StallWatchdog::DispatchScope::~DispatchScope()
+{
+    if(m_watchdog == nullptr)
+        return;
+
+    --m_watchdog->m_depth;
+    if(m_startTime < 0)
+        return;
+
+    const qint64 duration = TimeProfileTrace::timestamp() - m_startTime;
+    if(m_watchdog->m_enabled)
+        m_watchdog->recordDispatch(m_className, m_eventType, m_watchdog->m_timerName, m_startTime, duration);
+}
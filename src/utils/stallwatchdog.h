@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QEvent>
+#include <QObject>
+#include <QJsonArray>
+#include <QJsonObject>
+
+class QSettings;
+
+/**
+ * Times every top-level event dispatch on the UI thread, which includes timer
+ * callbacks delivered by ExecLaterTimer. Dispatches that take longer than the
+ * threshold are logged as stalls, along with the receiver, event type and the
+ * slowest TimeProfiler scope that ran during the dispatch.
+ *
+ * The watchdog is off by default. It can be turned on by setting
+ * Diagnostics/stallWatchdog in settings, or by setting the SCRITE_STALL_THRESHOLD
+ * environment variable to a threshold in milliseconds.
+ */
+
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StallWatchdog *instance();
+    ~StallWatchdog();
+
+    enum { HistogramBuckets = 16, MaxStallRecords = 200 };
+
+    void configure(QSettings *settings);
+
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    void setEnabled(bool val);
+    bool isEnabled() const { return m_enabled; }
+    Q_SIGNAL void enabledChanged();
+
+    // In milliseconds
+    Q_PROPERTY(int threshold READ threshold WRITE setThreshold NOTIFY thresholdChanged)
+    void setThreshold(int val);
+    int threshold() const { return m_threshold; }
+    Q_SIGNAL void thresholdChanged();
+
+    Q_PROPERTY(int stallCount READ stallCount NOTIFY stallsChanged)
+    int stallCount() const { return m_stallCount; }
+
+    Q_PROPERTY(QJsonArray stalls READ stalls NOTIFY stallsChanged)
+    QJsonArray stalls() const { return m_stalls; }
+    Q_SIGNAL void stallsChanged();
+
+    // Histogram of all dispatches timed so far. Bucket N counts dispatches
+    // that took [2^(N-1), 2^N) milliseconds, bucket 0 counts those under 1ms.
+    Q_INVOKABLE QJsonArray histogram() const;
+
+    Q_INVOKABLE QJsonObject report() const;
+    Q_INVOKABLE bool exportReport(const QString &fileName) const;
+    Q_INVOKABLE void reset();
+
+    // ExecLaterTimers of a thread are all delivered from within a single
+    // dispatch to its ExecLaterScheduler, so the timer event seen here doesn't
+    // say which of them ran. ExecLaterTimer reports each delivery instead, and
+    // stalls are attributed to the slowest timer delivered during them.
+    static void recordTimerDelivery(const QString &timerName, qint64 duration);
+
+    class DispatchScope
+    {
+    public:
+        DispatchScope(QObject *object, QEvent *event);
+        ~DispatchScope();
+
+    private:
+        StallWatchdog *m_watchdog = nullptr;
+        qint64 m_startTime = -1;
+        const char *m_className = nullptr;
+        QEvent::Type m_eventType = QEvent::None;
+    };
+
+protected:
+    StallWatchdog(QObject *parent=nullptr);
+
+private:
+    void recordDispatch(const char *className, QEvent::Type eventType, const QString &timerName, qint64 startTime, qint64 duration);
+
+private:
+    static StallWatchdog *m_active;
+
+    int m_depth = 0;
+    bool m_enabled = false;
+    int m_threshold = 100;
+    qint64 m_thresholdNs = 100000000;
+    int m_stallCount = 0;
+    qint64 m_dispatchCount = 0;
+    qint64 m_maxDuration = 0;
+    qint64 m_histogram[HistogramBuckets];
+    QJsonArray m_stalls;
+    qint64 m_sessionStart = 0;
+
+    // Slowest ExecLaterTimer delivered during the current top-level dispatch.
+    QString m_timerName;
+    qint64 m_timerDuration = -1;
+};
+
+#endif // STALLWATCHDOG_H
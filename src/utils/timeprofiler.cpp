@@ -15,11 +15,13 @@
 
 #include <QDir>
 #include <QMap>
+#include <QHash>
 #include <QFile>
-#include <QStack>
+#include <QMutex>
+#include <QTextStream>
+#include <QVector>
 #include <QtDebug>
-#include <QReadWriteLock>
-#include <QThreadStorage>
+#include <QAtomicInteger>
 #include <QStandardPaths>
 #include <QCoreApplication>
 #include <QThread>
@@ -32,19 +34,416 @@ static void dump_time_profile_data()
     const QString desktopPath = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
     const QString csvFileName = QDir(desktopPath).absoluteFilePath( QString("%1.csv").arg(fileName) );
     const QString normalFileName = QDir(desktopPath).absoluteFilePath( QString("%1.txt").arg(fileName) );
+    const QString traceFileName = QDir(desktopPath).absoluteFilePath( QString("%1.json").arg(fileName) );
 
     TimeProfile::save(csvFileName, TimeProfile::SortByAverageTime, TimeProfile::CSVFormat);
     TimeProfile::save(normalFileName, TimeProfile::SortByAverageTime, TimeProfile::NormalFormat);
+    TimeProfileTrace::saveChromeTrace(traceFileName);
 }
 
-typedef QMap<QString,TimeProfile> TimeProfileMapType;
-Q_GLOBAL_STATIC(QReadWriteLock, TimeProfileMapLock)
-Q_GLOBAL_STATIC(TimeProfileMapType, TimeProfileMap)
+struct TimeProfileEvent
+{
+    qint64 startTime;
+    qint64 duration;
+    qint32 contextId;
+    qint16 depth;
+    qint16 source;
+};
+
+struct TimeProfileStat
+{
+    QAtomicInteger<qint64> time;
+    QAtomicInt counter;
+};
+
+/**
+ * Only the owning thread ever writes into a buffer. Readers (exporters) copy events
+ * out and then re-read the head to discard slots that may have been overwritten
+ * while they were copying. When a background thread finishes, its totals are moved
+ * into the registry and its buffer is handed to the next thread that records
+ * anything. Thread pools retire and create threads all the time, so this keeps the
+ * number of buffers down to the number of threads recording at once. Samples of
+ * finished threads stay in the ring until the next owner overwrites them.
+ */
+struct TimeProfileThreadBuffer
+{
+    int index = 0;
+    QString threadName;
+    bool mainThread = false;
+    int depth = 0;
+
+    QAtomicInteger<qint64> head;
+    TimeProfileEvent events[TimeProfileTrace::RingBufferSize];
+    TimeProfileStat stats[TimeProfileTrace::MaxContexts];
+
+    void record(int contextId, qint64 startTime, qint64 duration, int depth, TimeProfileTrace::Source source) {
+        const qint64 h = head.loadAcquire();
+        TimeProfileEvent &e = events[h & (TimeProfileTrace::RingBufferSize-1)];
+        e.startTime = startTime;
+        e.duration = duration;
+        e.contextId = contextId;
+        e.depth = qint16(depth);
+        e.source = qint16(source);
+        head.storeRelease(h+1);
+
+        TimeProfileStat &stat = stats[contextId];
+        stat.time.storeRelease(stat.time.loadAcquire() + duration);
+        stat.counter.storeRelease(stat.counter.loadAcquire() + 1);
+    }
+
+    QVector<TimeProfileEvent> snapshot() const {
+        const qint64 h1 = head.loadAcquire();
+        const qint64 first = qMax<qint64>(0, h1-TimeProfileTrace::RingBufferSize);
+
+        QVector<TimeProfileEvent> ret;
+        ret.reserve(int(h1-first));
+        for(qint64 i=first; i<h1; i++)
+            ret.append(events[i & (TimeProfileTrace::RingBufferSize-1)]);
+
+        // The writer may have lapped us while we were copying. Slots up to and
+        // including the one it is writing next cannot be trusted.
+        const qint64 h2 = head.loadAcquire();
+        const qint64 valid = qMax(first, h2-TimeProfileTrace::RingBufferSize+1);
+        if(valid > first)
+            ret.remove(0, int(qMin(valid-first, qint64(ret.size()))));
+
+        return ret;
+    }
+
+    static TimeProfileThreadBuffer *current();
+    static void release(TimeProfileThreadBuffer *buffer);
+};
+
+class TimeProfileRegistry
+{
+public:
+    QMutex mutex;
+    QHash<QString,int> contextIds;
+    QVector<QString> contextNames;
+    QList<TimeProfileThreadBuffer*> buffers;
+    QList<TimeProfileThreadBuffer*> freeBuffers;
+
+    // Totals of background threads that have finished, per context
+    QVector<qint64> retiredTimes;
+    QVector<int> retiredCounters;
+
+    bool postRoutineAdded = false;
+};
+Q_GLOBAL_STATIC(TimeProfileRegistry, TimeProfileRegistryInstance)
+
+// Gives the buffer back when the thread finishes.
+struct TimeProfileThreadBufferOwner
+{
+    TimeProfileThreadBuffer *buffer = nullptr;
+
+    ~TimeProfileThreadBufferOwner() {
+        if(buffer != nullptr)
+            TimeProfileThreadBuffer::release(buffer);
+    }
+};
+static thread_local TimeProfileThreadBufferOwner currentThreadBuffer;
+
+TimeProfileThreadBuffer *TimeProfileThreadBuffer::current()
+{
+    TimeProfileThreadBuffer *&buffer = ::currentThreadBuffer.buffer;
+    if(buffer != nullptr)
+        return buffer;
+
+    const bool mainThread = qApp != nullptr && qApp->thread() == QThread::currentThread();
+    const QString threadName = QThread::currentThread()->objectName();
+
+    TimeProfileRegistry *registry = ::TimeProfileRegistryInstance();
+    QMutexLocker locker(&registry->mutex);
+
+    if(!mainThread && !registry->freeBuffers.isEmpty())
+    {
+        buffer = registry->freeBuffers.takeLast();
+        if(!threadName.isEmpty())
+            buffer->threadName = threadName;
+        return buffer;
+    }
+
+    buffer = new TimeProfileThreadBuffer;
+    buffer->mainThread = mainThread;
+    buffer->threadName = threadName;
+    buffer->index = registry->buffers.size();
+    if(buffer->threadName.isEmpty())
+        buffer->threadName = buffer->mainThread ? QStringLiteral("MainThread") : QString("BackgroundThread %1").arg(buffer->index);
+    registry->buffers.append(buffer);
+
+    return buffer;
+}
+
+void TimeProfileThreadBuffer::release(TimeProfileThreadBuffer *buffer)
+{
+    // The main thread records until the very end, its buffer goes with the process.
+    if(buffer->mainThread || ::TimeProfileRegistryInstance.isDestroyed())
+        return;
+
+    TimeProfileRegistry *registry = ::TimeProfileRegistryInstance();
+    QMutexLocker locker(&registry->mutex);
+
+    if(registry->retiredTimes.isEmpty())
+    {
+        registry->retiredTimes.fill(0, TimeProfileTrace::MaxContexts);
+        registry->retiredCounters.fill(0, TimeProfileTrace::MaxContexts);
+    }
+
+    // This runs on the thread that owns the buffer, so nothing else writes
+    // into it. Readers of totals hold the mutex, so nothing is counted twice.
+    for(int i=0; i<registry->contextNames.size(); i++)
+    {
+        TimeProfileStat &stat = buffer->stats[i];
+        const int counter = stat.counter.loadAcquire();
+        if(counter == 0)
+            continue;
+
+        registry->retiredTimes[i] += stat.time.loadAcquire();
+        registry->retiredCounters[i] += counter;
+        stat.time.storeRelease(0);
+        stat.counter.storeRelease(0);
+    }
+
+    buffer->depth = 0;
+    registry->freeBuffers.append(buffer);
+}
+
+inline QString evaluateContextPrefix(bool mainThread)
+{
+    return mainThread ? QStringLiteral(" [MainThread]") : QStringLiteral(" [BackgroundThread]");
+}
+
+int TimeProfileTrace::registerContext(const char *context)
+{
+    return registerContext(QString::fromLatin1(context));
+}
+
+int TimeProfileTrace::registerContext(const QString &context)
+{
+    TimeProfileRegistry *registry = ::TimeProfileRegistryInstance();
+    QMutexLocker locker(&registry->mutex);
+
+#ifdef ENABLE_TIME_PROFILING
+    if(!registry->postRoutineAdded && qApp)
+    {
+        qAddPostRoutine(dump_time_profile_data);
+        registry->postRoutineAdded = true;
+    }
+#endif
+
+    const int existingId = registry->contextIds.value(context, -1);
+    if(existingId >= 0)
+        return existingId;
+
+    if(registry->contextNames.size() >= MaxContexts)
+    {
+        qWarning() << "TimeProfileTrace: too many contexts, not profiling" << context;
+        return -1;
+    }
+
+    const int id = registry->contextNames.size();
+    registry->contextNames.append(context);
+    registry->contextIds.insert(context, id);
+    return id;
+}
+
+QString TimeProfileTrace::contextName(int contextId)
+{
+    TimeProfileRegistry *registry = ::TimeProfileRegistryInstance();
+    QMutexLocker locker(&registry->mutex);
+    return registry->contextNames.value(contextId);
+}
+
+qint64 TimeProfileTrace::timestamp()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+void TimeProfileTrace::record(int contextId, qint64 startTime, qint64 duration, Source source)
+{
+    if(contextId < 0 || contextId >= MaxContexts)
+        return;
+
+    TimeProfileThreadBuffer *buffer = TimeProfileThreadBuffer::current();
+    buffer->record(contextId, startTime, duration, buffer->depth, source);
+}
+
+QString TimeProfileTrace::slowestScopeSince(qint64 startTime, qint64 *duration)
+{
+    // Only looks at this thread's buffer, and doesn't create one if the thread
+    // hasn't recorded anything yet.
+    const TimeProfileThreadBuffer *buffer = ::currentThreadBuffer.buffer;
+    if(buffer == nullptr)
+        return QString();
+
+    const qint64 head = buffer->head.loadAcquire();
+    const qint64 first = qMax<qint64>(0, head-RingBufferSize);
+
+    int contextId = -1;
+    qint64 maxDuration = -1;
+    for(qint64 i=head-1; i>=first; i--)
+    {
+        const TimeProfileEvent &e = buffer->events[i & (RingBufferSize-1)];
+        if(e.source != NativeSource)
+            continue;
+
+        // Native samples are recorded as they end. Once we reach one that began
+        // before startTime, the rest belong to whatever ran before.
+        if(e.startTime < startTime)
+            break;
+
+        if(e.duration > maxDuration)
+        {
+            maxDuration = e.duration;
+            contextId = e.contextId;
+        }
+    }
+
+    if(duration)
+        *duration = maxDuration;
+
+    return contextId < 0 ? QString() : contextName(contextId);
+}
+
+QList<TimeProfile> TimeProfileTrace::profiles()
+{
+    // Held throughout, so that totals of a thread that finishes meanwhile are
+    // counted either in its buffer or among retired totals, never both.
+    TimeProfileRegistry *registry = ::TimeProfileRegistryInstance();
+    QMutexLocker locker(&registry->mutex);
+
+    const QList<TimeProfileThreadBuffer*> &buffers = registry->buffers;
+    const QVector<QString> &contextNames = registry->contextNames;
+
+    QMap<QString,TimeProfile> map;
+    auto addProfile = [&map](const TimeProfile &profile) {
+        TimeProfile &existing = map[profile.context()];
+        if(existing.isValid())
+            existing += profile;
+        else
+            existing = profile;
+    };
+
+    for(int i=0; i<registry->retiredCounters.size() && i<contextNames.size(); i++)
+    {
+        const int counter = registry->retiredCounters.at(i);
+        if(counter > 0)
+            addProfile( TimeProfile(contextNames.at(i) + evaluateContextPrefix(false), registry->retiredTimes.at(i), counter) );
+    }
+
+    for(const TimeProfileThreadBuffer *buffer : buffers)
+    {
+        const QString suffix = evaluateContextPrefix(buffer->mainThread);
+        for(int i=0; i<contextNames.size(); i++)
+        {
+            const TimeProfileStat &stat = buffer->stats[i];
+            const int counter = stat.counter.loadAcquire();
+            if(counter == 0)
+                continue;
+
+            addProfile( TimeProfile(contextNames.at(i) + suffix, stat.time.loadAcquire(), counter) );
+        }
+    }
+
+    return map.values();
+}
+
+static QString jsonEscaped(const QString &text)
+{
+    QString ret;
+    ret.reserve(text.length());
+    for(const QChar ch : text)
+    {
+        if(ch == QChar('"') || ch == QChar('\\'))
+            ret += QChar('\\');
+        if(ch.unicode() < 0x20)
+            ret += QString("\\u%1").arg(ch.unicode(), 4, 16, QChar('0'));
+        else
+            ret += ch;
+    }
+    return ret;
+}
+
+bool TimeProfileTrace::saveChromeTrace(const QString &fileName)
+{
+    QList<TimeProfileThreadBuffer*> buffers;
+    QVector<QString> contextNames;
+
+    {
+        TimeProfileRegistry *registry = ::TimeProfileRegistryInstance();
+        QMutexLocker locker(&registry->mutex);
+        buffers = registry->buffers;
+        contextNames = registry->contextNames;
+    }
+
+    QFile file(fileName);
+    if( !file.open(QFile::WriteOnly) )
+        return false;
+
+    for(QString &name : contextNames)
+        name = jsonEscaped(name);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QTextStream ts(&file);
+    ts << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto writeThreadName = [&](int tid, const QString &name) {
+        ts << (first ? "" : ",\n")
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"tid\":" << tid << ",\"args\":{\"name\":\"" << jsonEscaped(name) << "\"}}";
+        first = false;
+    };
+
+    // QML samples dont nest with native ones (an item can stay active across
+    // event loop iterations), so they are given a track of their own per thread.
+    const int qmlTrackOffset = 10000;
+
+    for(const TimeProfileThreadBuffer *buffer : qAsConst(buffers))
+    {
+        writeThreadName(buffer->index+1, buffer->threadName);
+        writeThreadName(buffer->index+1+qmlTrackOffset, buffer->threadName + QStringLiteral(" (QML)"));
+
+        const QVector<TimeProfileEvent> events = buffer->snapshot();
+        for(const TimeProfileEvent &e : events)
+        {
+            if(e.contextId < 0 || e.contextId >= contextNames.size())
+                continue;
+
+            const bool qml = e.source == QmlSource;
+            ts << ",\n{\"name\":\"" << contextNames.at(e.contextId)
+               << "\",\"cat\":\"" << (qml ? "qml" : "native")
+               << "\",\"ph\":\"X\",\"pid\":" << pid
+               << ",\"tid\":" << (buffer->index + 1 + (qml ? qmlTrackOffset : 0))
+               << ",\"ts\":" << QString::number(qreal(e.startTime)/1000.0, 'f', 3)
+               << ",\"dur\":" << QString::number(qreal(e.duration)/1000.0, 'f', 3)
+               << ",\"args\":{\"depth\":" << e.depth << "}}";
+        }
+    }
+
+    ts << "\n]}\n";
+    ts.flush();
+    file.close();
+
+    return true;
+}
 
 TimeProfile TimeProfile::get(const QString &context)
 {
-    QReadLocker locker(::TimeProfileMapLock());
-    return ::TimeProfileMap()->value(context);
+    const QList<TimeProfile> profiles = TimeProfileTrace::profiles();
+    for(const TimeProfile &profile : profiles)
+    {
+        if(profile.context() == context)
+            return profile;
+    }
+
+    return TimeProfile();
 }
 
 static int timeSorter(const TimeProfile &a, const TimeProfile &b)
@@ -64,12 +463,7 @@ static int counterSorter(const TimeProfile &a, const TimeProfile &b)
 
 static QList< TimeProfile > sortedProfiles(TimeProfile::PrintSortOrder sortOrder)
 {
-    QList< TimeProfile > profiles;
-
-    {
-        QReadLocker locker(::TimeProfileMapLock());
-        profiles = ::TimeProfileMap()->values();
-    }
+    QList< TimeProfile > profiles = TimeProfileTrace::profiles();
 
     switch(sortOrder)
     {
@@ -167,67 +561,51 @@ void TimeProfile::printSelf(int indent, PrintFormat format) const
     fprintf(stderr, "%s\n", qPrintable(str));
 }
 
-TimeProfile TimeProfile::put(const TimeProfile &profile)
-{
-    if( !profile.isValid() )
-        return profile;
-
-    QWriteLocker locker(::TimeProfileMapLock());
-
-    TimeProfile existing = ::TimeProfileMap()->value(profile.context());
-    if( existing.isValid() )
-        ::TimeProfileMap()->insert( profile.context(), existing+profile );
-    else
-        ::TimeProfileMap()->insert( profile.context(), profile );
-
-    return profile;
-}
-
 #ifdef ENABLE_TIME_PROFILING
 
-Q_GLOBAL_STATIC( QThreadStorage< QStack<TimeProfiler*> >, TimeProfilerStack )
-
-static void addPostRoutine()
+TimeProfiler::TimeProfiler(int contextId, bool print)
+    : m_contextId(contextId), m_printInDestructor(print)
 {
-    static bool postRoutineAdded = false;
-    if( !postRoutineAdded && qApp )
-    {
-        qAddPostRoutine(dump_time_profile_data);
-        postRoutineAdded = true;
-    }
-}
+    if(m_contextId < 0 || m_contextId >= TimeProfileTrace::MaxContexts)
+        return;
 
-inline QString evaluateContextPrefix()
-{
-    return qApp->thread() == QThread::currentThread() ? QStringLiteral(" [MainThread]") : QStringLiteral(" [BackgroundThread]");
+    m_buffer = TimeProfileThreadBuffer::current();
+    ++m_buffer->depth;
+    m_startTime = TimeProfileTrace::timestamp();
 }
 
 TimeProfiler::TimeProfiler(const QString &context, bool print)
-    : m_context(context + evaluateContextPrefix()), m_printInDestructor(print)
-{
-    addPostRoutine();
-    ::TimeProfilerStack()->localData().push(this);
-    m_timer.start();
-}
+    : TimeProfiler(TimeProfileTrace::registerContext(context), print) { }
 
 TimeProfiler::~TimeProfiler()
 {
-    TimeProfile p = this->profile();
-    TimeProfile::put(p);
+    if(m_buffer == nullptr)
+        return;
 
-    int indent = 0;
-    Q_ASSERT( ::TimeProfilerStack()->localData().pop() == this );
-    indent = ::TimeProfilerStack()->localData().size();
+    const qint64 duration = TimeProfileTrace::timestamp() - m_startTime;
+    const int depth = --m_buffer->depth;
+    m_buffer->record(m_contextId, m_startTime, duration, depth, TimeProfileTrace::NativeSource);
 
     if( m_printInDestructor )
-        p.printSelf(indent);
+        TimeProfile(this->context(), duration).printSelf(depth);
+}
+
+QString TimeProfiler::context() const
+{
+    if(m_buffer == nullptr)
+        return QString();
+
+    return TimeProfileTrace::contextName(m_contextId) + evaluateContextPrefix(m_buffer->mainThread);
 }
 
 TimeProfile TimeProfiler::profile(bool aggregate) const
 {
-    TimeProfile p(m_context, m_timer.nsecsElapsed());
+    if(m_buffer == nullptr)
+        return TimeProfile();
+
+    TimeProfile p(this->context(), TimeProfileTrace::timestamp() - m_startTime);
     if( aggregate )
-        p += TimeProfile::get(m_context);
+        p += TimeProfile::get(p.context());
     return p;
 }
 
@@ -236,18 +614,14 @@ TimeProfile TimeProfiler::profile(bool aggregate) const
 ProfilerItem::ProfilerItem(QObject *parent)
     : QObject(parent)
 {
-    addPostRoutine();
     m_context = QString::fromLatin1(parent->metaObject()->className());
+    m_contextId = TimeProfileTrace::registerContext(m_context);
 }
 
 ProfilerItem::~ProfilerItem()
 {
     if(m_active)
         this->setActive(false);
-
-    if(m_timer)
-        delete m_timer;
-    m_timer = nullptr;
 }
 
 ProfilerItem *ProfilerItem::qmlAttachedProperties(QObject *object)
@@ -261,6 +635,7 @@ void ProfilerItem::setContext(const QString &val)
         return;
 
     m_context = val;
+    m_contextId = TimeProfileTrace::registerContext(m_context);
     emit contextChanged();
 }
 
@@ -271,25 +646,12 @@ void ProfilerItem::setActive(bool val)
 
     m_active = val;
 
+    // Samples from QML go into the same per-thread timeline as native ones,
+    // on a track of their own.
     if(m_active)
-    {
-        if(m_timer)
-            delete m_timer;
-        m_timer = new QElapsedTimer;
-        m_timer->start();
-    }
+        m_startTime = TimeProfileTrace::timestamp();
     else
-    {
-        if(m_timer)
-        {
-            const qint64 nsecs = m_timer->nsecsElapsed();
-            delete m_timer;
-            m_timer = nullptr;
-
-            const QString ctx = m_context + evaluateContextPrefix();
-            TimeProfile::put( TimeProfile(ctx, nsecs) );
-        }
-    }
+        TimeProfileTrace::record(m_contextId, m_startTime, TimeProfileTrace::timestamp()-m_startTime, TimeProfileTrace::QmlSource);
 
     emit activeChanged();
 }
@@ -21,6 +21,8 @@
 
 class TimeProfiler;
 class ProfilerItem;
+class TimeProfileTrace;
+struct TimeProfileThreadBuffer;
 
 class TimeProfile
 {
@@ -82,8 +84,7 @@ public:
 private:
     friend class TimeProfiler;
     friend class ProfilerItem;
-
-    static TimeProfile put(const TimeProfile &profile);
+    friend class TimeProfileTrace;
 
     TimeProfile operator + (const TimeProfile &other) const {
         if( this->m_context == other.m_context ) {
@@ -132,6 +133,42 @@ private:
     int m_counter = 1;
 };
 
+/**
+ * Samples are recorded into a fixed size ring buffer owned by the thread that
+ * records them, so recording never takes a lock. Each sample is a complete event
+ * (start time, duration and nesting depth) against an interned context ID.
+ * Per-thread, per-context totals are kept alongside, so aggregates are exact
+ * even after the ring buffer has wrapped around.
+ *
+ * Context IDs are meant to be registered once per call site (see the
+ * PROFILE_THIS_FUNCTION macro) and reused for every sample thereafter.
+ */
+class TimeProfileTrace
+{
+public:
+    enum { RingBufferSize = 65536, MaxContexts = 4096 };
+    enum Source { NativeSource, QmlSource };
+
+    static int registerContext(const char *context);
+    static int registerContext(const QString &context);
+    static QString contextName(int contextId);
+
+    // Nanoseconds since the first sample was recorded in this process
+    static qint64 timestamp();
+    static void record(int contextId, qint64 startTime, qint64 duration, Source source=NativeSource);
+
+    // Name of the longest native scope recorded by the calling thread, among those
+    // that began at or after startTime. Used to attribute stalls.
+    static QString slowestScopeSince(qint64 startTime, qint64 *duration=nullptr);
+
+    // Aggregates from all threads, one entry per context per thread-kind
+    static QList<TimeProfile> profiles();
+
+    // Writes samples currently in the ring buffers as Chrome trace-event JSON,
+    // which can be loaded in chrome://tracing or https://ui.perfetto.dev
+    static bool saveChromeTrace(const QString &fileName);
+};
+
 #ifdef ENABLE_TIME_PROFILING
 
 #include <QQmlEngine>
@@ -139,16 +176,18 @@ private:
 class TimeProfiler
 {
 public:
+    TimeProfiler(int contextId, bool print=false);
     TimeProfiler(const QString &context, bool print=false);
     ~TimeProfiler();
 
-    QString context() const { return m_context; }
+    QString context() const;
     TimeProfile profile(bool aggregate=false) const;
 
 private:
-    QString m_context;
-    QElapsedTimer m_timer;
+    int m_contextId = -1;
+    qint64 m_startTime = 0;
     bool m_printInDestructor = false;
+    TimeProfileThreadBuffer *m_buffer = nullptr;
 };
 
 class ProfilerItem : public QObject
@@ -174,20 +213,26 @@ public:
 private:
     bool m_active = false;
     QString m_context;
-    QElapsedTimer *m_timer = nullptr;
+    int m_contextId = -1;
+    qint64 m_startTime = 0;
 };
 
 Q_DECLARE_METATYPE(ProfilerItem*)
 QML_DECLARE_TYPEINFO(ProfilerItem, QML_HAS_ATTACHED_PROPERTIES)
 
-#define PROFILE_THIS_FUNCTION TimeProfiler profiler##__LINE__(Q_FUNC_INFO, false)
-#define PROFILE_THIS_FUNCTION2 TimeProfiler profiler##__LINE__(Q_FUNC_INFO, true)
+#define PROFILE_THIS_FUNCTION \
+    static const int profilerContextId##__LINE__ = TimeProfileTrace::registerContext(Q_FUNC_INFO); \
+    TimeProfiler profiler##__LINE__(profilerContextId##__LINE__, false)
+#define PROFILE_THIS_FUNCTION2 \
+    static const int profilerContextId##__LINE__ = TimeProfileTrace::registerContext(Q_FUNC_INFO); \
+    TimeProfiler profiler##__LINE__(profilerContextId##__LINE__, true)
 
 #else // #ifdef ENABLE_TIME_PROFILING
 
 class TimeProfiler
 {
 public:
+    TimeProfiler(int, bool=false) { }
     TimeProfiler(const QString &, bool=false) { }
     ~TimeProfiler() { }
 
@@ -0,0 +1,19 @@
+# Headless benchmarks for Scrite. This builds a separate console binary from the
+# same sources as the application (see scrite.pri), so it can be run on build
+# machines without a display. Run with --help for options.
+
+DESTDIR = $$PWD/../../../Release/
+TARGET = scrite-benchmark
+CONFIG += console
+CONFIG -= app_bundle
+
+include($$PWD/../../scrite.pri)
+
+HEADERS += \
+    syntheticdocument.h \
+    benchmarkrunner.h
+
+SOURCES += \
+    main.cpp \
+    syntheticdocument.cpp \
+    benchmarkrunner.cpp
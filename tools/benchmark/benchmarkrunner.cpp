@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "benchmarkrunner.h"
+
+#include <QVector>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+
+#include <algorithm>
+
+BenchmarkRunner::BenchmarkRunner(int iterations)
+    : m_iterations(qMax(iterations,1))
+{
+
+}
+
+BenchmarkRunner::~BenchmarkRunner()
+{
+
+}
+
+bool BenchmarkRunner::isEnabled(const QString &name) const
+{
+    return m_filter.isEmpty() || m_filter.contains(name);
+}
+
+void BenchmarkRunner::run(const QString &name, const Function &body, const Function &prepare, int iterations)
+{
+    m_skipped = !this->isEnabled(name);
+    if(m_skipped)
+        return;
+
+    if(iterations <= 0)
+        iterations = m_iterations;
+
+    fprintf(stderr, "Running %s ...\n", qPrintable(name));
+
+    m_metrics = QJsonObject();
+    m_running = true;
+
+    QVector<qreal> samples;
+    samples.reserve(iterations);
+
+    QElapsedTimer timer;
+    for(int i=0; i<iterations; i++)
+    {
+        if(prepare)
+            prepare();
+
+        // Deferred deletes and zero timers queued by the previous iteration
+        // must not be counted against this one.
+        qApp->sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        qApp->processEvents();
+
+        timer.start();
+        body();
+        samples.append(qreal(timer.nsecsElapsed())/1000000.0);
+    }
+
+    m_running = false;
+
+    QVector<qreal> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    qreal total = 0;
+    QJsonArray samplesJson;
+    for(qreal sample : qAsConst(samples))
+    {
+        total += sample;
+        samplesJson.append(sample);
+    }
+
+    const int mid = sorted.size()/2;
+    const qreal median = sorted.size()%2 ? sorted.at(mid) : (sorted.at(mid-1)+sorted.at(mid))/2.0;
+
+    QJsonObject result;
+    result.insert("name", name);
+    result.insert("unit", "ms");
+    result.insert("iterations", iterations);
+    result.insert("min", sorted.first());
+    result.insert("max", sorted.last());
+    result.insert("mean", total/qreal(iterations));
+    result.insert("median", median);
+    result.insert("samples", samplesJson);
+    if(!m_metrics.isEmpty())
+        result.insert("metrics", m_metrics);
+    m_results.append(result);
+
+    fprintf(stderr, "    median %.3f ms (min %.3f, max %.3f)\n", median, sorted.first(), sorted.last());
+}
+
+void BenchmarkRunner::addMetric(const QString &key, const QJsonValue &value)
+{
+    if(m_skipped)
+        return;
+
+    m_metrics.insert(key, value);
+
+    // Outside of run(), metrics are meant for the benchmark that just completed.
+    if(!m_running && !m_results.isEmpty())
+    {
+        QJsonObject last = m_results.last().toObject();
+        last.insert("metrics", m_metrics);
+        m_results[m_results.size()-1] = last;
+    }
+}
@@ -0,0 +1,56 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <functional>
+
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(int iterations=3);
+    ~BenchmarkRunner();
+
+    int iterations() const { return m_iterations; }
+
+    // When set, only benchmarks whose names are in the list are run.
+    void setFilter(const QStringList &names) { m_filter = names; }
+    bool isEnabled(const QString &name) const;
+
+    // Calls prepare (not timed) and then body (timed) once per iteration. Results
+    // are reported in milliseconds.
+    typedef std::function<void()> Function;
+    void run(const QString &name, const Function &body, const Function &prepare=Function(), int iterations=-1);
+
+    // Attaches a value (page count, number of results, etc.) to the benchmark
+    // that is currently running, or was run last. Ignored if that benchmark was
+    // filtered out.
+    void addMetric(const QString &key, const QJsonValue &value);
+
+    QJsonArray results() const { return m_results; }
+
+private:
+    int m_iterations = 3;
+    bool m_running = false;
+    bool m_skipped = false;
+    QStringList m_filter;
+    QJsonArray m_results;
+    QJsonObject m_metrics;
+};
+
+#endif // BENCHMARKRUNNER_H
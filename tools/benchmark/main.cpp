@@ -0,0 +1,416 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "application.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtMath>
+#include <QThread>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QTextDocument>
+#include <QTemporaryDir>
+#include <QRandomGenerator>
+#include <QCommandLineParser>
+
+#include "scene.h"
+#include "structure.h"
+#include "scritetypes.h"
+#include "screenplay.h"
+#include "graphlayout.h"
+#include "imageprinter.h"
+#include "scritedocument.h"
+#include "benchmarkrunner.h"
+#include "qobjectserializer.h"
+#include "syntheticdocument.h"
+#include "documentfilesystem.h"
+#include "screenplaytextdocument.h"
+
+/**
+ * Runs a fixed set of operations against synthetic documents and writes timings
+ * as JSON, so that numbers can be compared across commits. For example
+ *
+ *    scrite-benchmark --scenes 2000 --languages English,Kannada --output results.json
+ *
+ * Benchmarks can be picked using --only, whose value is a comma separated list
+ * of benchmark names (see the "results" array in the output for names).
+ */
+
+class BenchmarkNode : public GraphLayout::AbstractNode
+{
+public:
+    QSizeF size() const { return QSizeF(120, 40); }
+
+protected:
+    void move(const QPointF &) { }
+};
+
+class BenchmarkEdge : public GraphLayout::AbstractEdge
+{
+public:
+    BenchmarkEdge(BenchmarkNode *n1=nullptr, BenchmarkNode *n2=nullptr) : m_node1(n1), m_node2(n2) { }
+
+    GraphLayout::AbstractNode *node1() const { return m_node1; }
+    GraphLayout::AbstractNode *node2() const { return m_node2; }
+    void evaluateEdge() { }
+
+private:
+    BenchmarkNode *m_node1 = nullptr;
+    BenchmarkNode *m_node2 = nullptr;
+};
+
+static void benchmarkGraphLayout(BenchmarkRunner &runner, const QString &name, GraphLayout::AbstractLayout &layout, int nrNodes, quint32 seed)
+{
+    // Nodes start out on a grid, with each node connected to a couple of others,
+    // similar to a character relationship graph.
+    QRandomGenerator random(seed);
+    QVector<BenchmarkNode> nodes(nrNodes);
+    QVector<BenchmarkEdge> edges;
+    edges.reserve(nrNodes*2);
+    for(int i=1; i<nrNodes; i++)
+    {
+        edges.append( BenchmarkEdge(&nodes[i], &nodes[random.bounded(i)]) );
+        if(i > 2 && random.bounded(2) == 0)
+            edges.append( BenchmarkEdge(&nodes[i], &nodes[random.bounded(i)]) );
+    }
+
+    GraphLayout::Graph graph;
+    for(BenchmarkNode &node : nodes)
+        graph.nodes.append(&node);
+    for(BenchmarkEdge &edge : edges)
+        graph.edges.append(&edge);
+
+    const int columns = qMax(1, qCeil(qSqrt(nrNodes)));
+    layout.setMaxTime(60*1000);
+    layout.setMaxIterations(200);
+    layout.setMinimumEdgeLength(50);
+
+    runner.run(name, [&]() {
+        layout.layout(graph);
+    }, [&]() {
+        for(int i=0; i<nrNodes; i++)
+            nodes[i].setPosition( QPointF((i%columns)*200, (i/columns)*100) );
+    });
+    runner.addMetric("nodes", nrNodes);
+    runner.addMetric("edges", edges.size());
+}
+
+int main(int argc, char **argv)
+{
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("offscreen"));
+
+    const QVersionNumber applicationVersion(0, 5, 8);
+
+    // A name of its own, so that running benchmarks doesn't touch Scrite's settings.
+    Application::setApplicationName("ScriteBenchmark");
+    Application::setOrganizationName("TERIFLIX");
+    Application::setOrganizationDomain("teriflix.com");
+    Application::setApplicationVersion(applicationVersion.toString());
+
+    Application a(argc, argv, applicationVersion);
+
+    // Documents can't be saved or loaded without the types their lists hold.
+    registerScriteTypes();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times common Scrite operations on synthetic screenplays.");
+    parser.addHelpOption();
+
+    const QCommandLineOption scenesOption("scenes", "Number of scenes.", "count", "500");
+    const QCommandLineOption paragraphsOption("paragraphs", "Paragraphs per scene.", "count", "12");
+    const QCommandLineOption charactersOption("characters", "Number of characters.", "count", "40");
+    const QCommandLineOption locationsOption("locations", "Number of locations (default: scenes/5).", "count", "0");
+    const QCommandLineOption photosOption("photos", "Number of characters with a photo.", "count", "10");
+    const QCommandLineOption languagesOption("languages", "Comma separated list of languages, from: " + SyntheticDocument::supportedLanguages().join(", "), "list", "English");
+    const QCommandLineOption seedOption("seed", "Seed for generating content.", "number", "1");
+    const QCommandLineOption iterationsOption("iterations", "Number of times each benchmark is run.", "count", "3");
+    const QCommandLineOption graphNodesOption("graph-nodes", "Number of nodes in graph layout benchmarks.", "count", "100");
+    const QCommandLineOption lookupScenesOption("lookup-scenes", "Number of scenes in the lookup benchmark.", "count", "5000");
+    const QCommandLineOption largeLoadScenesOption("large-load-scenes", "Number of scenes in the large-load benchmark.", "count", "5000");
+    const QCommandLineOption pageImageScenesOption("page-image-scenes", "Number of scenes in page image benchmarks.", "count", "150");
+    const QCommandLineOption onlyOption("only", "Comma separated list of benchmarks to run.", "list");
+    const QCommandLineOption outputOption("output", "JSON file to write results into (default: stdout).", "file");
+    const QCommandLineOption commitOption("commit", "Commit ID to record with the results.", "id");
+    parser.addOptions({scenesOption, paragraphsOption, charactersOption, locationsOption, photosOption,
+                       languagesOption, seedOption, iterationsOption, graphNodesOption, lookupScenesOption,
+                       largeLoadScenesOption, pageImageScenesOption, onlyOption, outputOption, commitOption});
+    parser.process(a);
+
+    SyntheticDocument::Parameters params;
+    params.scenes = qMax(1, parser.value(scenesOption).toInt());
+    params.paragraphsPerScene = qMax(1, parser.value(paragraphsOption).toInt());
+    params.characters = qMax(0, parser.value(charactersOption).toInt());
+    params.locations = qMax(0, parser.value(locationsOption).toInt());
+    params.photos = qMax(0, parser.value(photosOption).toInt());
+    params.languages = parser.value(languagesOption).split(",", QString::SkipEmptyParts);
+    params.seed = parser.value(seedOption).toUInt();
+
+    BenchmarkRunner runner(parser.value(iterationsOption).toInt());
+    if(parser.isSet(onlyOption))
+        runner.setFilter(parser.value(onlyOption).split(",", QString::SkipEmptyParts));
+
+    QTemporaryDir tempDir;
+    if(!tempDir.isValid())
+    {
+        fprintf(stderr, "Could not create a temporary directory.\n");
+        return 1;
+    }
+
+    DocumentFileSystem::setMarker( QByteArrayLiteral("SCRITE") );
+
+    ScriteDocument *document = ScriteDocument::instance();
+    document->setAutoSave(false);
+
+    const QString scriteFile = tempDir.filePath("benchmark.scrite");
+    auto reloadDocument = [=]() {
+        document->openAnonymously(scriteFile);
+    };
+
+    runner.run("generate", [&]() {
+        SyntheticDocument::generate(document, params);
+    });
+    runner.addMetric("scenes", document->screenplay()->elementCount());
+
+    // Everything else needs a saved document to start from.
+    if(!runner.isEnabled("generate"))
+        SyntheticDocument::generate(document, params);
+    document->saveAs(scriteFile);
+
+    runner.run("save", [&]() {
+        document->saveAs(scriteFile);
+    });
+    runner.addMetric("fileSize", QFileInfo(scriteFile).size());
+
+    // An autosave is a save() of an already saved document, after an edit.
+    runner.run("autosave", [&]() {
+        document->save();
+    }, [&]() {
+        SceneElement *para = document->screenplay()->elementAt(0)->scene()->elementAt(0);
+        para->setText(para->text() + QStringLiteral(" edit"));
+    });
+
+    runner.run("load", [&]() {
+        document->openAnonymously(scriteFile);
+    });
+
+    QJsonObject json;
+    runner.run("serializer-tojson", [&]() {
+        json = QObjectSerializer::toJson(document);
+    });
+    runner.addMetric("bytes", QJsonDocument(json).toJson(QJsonDocument::Compact).size());
+
+    runner.run("serializer-fromjson", [&]() {
+        QObjectSerializer::fromJson(json, document);
+    }, [&]() {
+        document->reset();
+    });
+    reloadDocument();
+
+    runner.run("pagination", [&]() {
+        ScreenplayTextDocument textDocument;
+        textDocument.setFormatting(document->printFormat());
+        textDocument.setScreenplay(document->screenplay());
+        textDocument.syncNow();
+        runner.addMetric("pages", textDocument.textDocument()->pageCount());
+    });
+
+    const int findFlags = QTextDocument::FindCaseSensitively|QTextDocument::FindWholeWords;
+    runner.run("search", [&]() {
+        const QJsonArray results = document->screenplay()->search(SyntheticDocument::searchWord(), findFlags);
+        runner.addMetric("results", results.size());
+    });
+
+    const QString replacementWord = QStringLiteral("benchscrite");
+    runner.run("replace", [&]() {
+        document->screenplay()->replace(SyntheticDocument::searchWord(), replacementWord, findFlags);
+    }, [&]() {
+        document->screenplay()->replace(replacementWord, SyntheticDocument::searchWord(), findFlags);
+    });
+    reloadDocument();
+
+    struct ImportExportFormat
+    {
+        QString name;
+        QString exportFormat;
+        QString importFormat;
+        QString suffix;
+    };
+    const QList<ImportExportFormat> formats = QList<ImportExportFormat>()
+            << ImportExportFormat{"fdx", "Screenplay/Final Draft", "Final Draft", "fdx"}
+            << ImportExportFormat{"fountain", "Screenplay/Fountain", "Fountain", "fountain"}
+            << ImportExportFormat{"pdf", "Screenplay/Adobe PDF", QString(), "pdf"};
+    for(const ImportExportFormat &format : formats)
+    {
+        const QString fileName = tempDir.filePath("benchmark." + format.suffix);
+        runner.run(format.name + "-export", [&]() {
+            document->exportFile(fileName, format.exportFormat);
+        });
+        runner.addMetric("fileSize", QFileInfo(fileName).size());
+
+        if(format.importFormat.isEmpty() || !QFile::exists(fileName))
+            continue;
+
+        runner.run(format.name + "-import", [&]() {
+            document->importFile(fileName, format.importFormat);
+        });
+        runner.addMetric("scenes", document->screenplay()->elementCount());
+        reloadDocument();
+    }
+
+    GraphLayout::ForceDirectedLayout forceDirectedLayout;
+    benchmarkGraphLayout(runner, "force-directed-layout", forceDirectedLayout, parser.value(graphNodesOption).toInt(), params.seed);
+
+    GraphLayout::BarnesHutLayout barnesHutLayout;
+    benchmarkGraphLayout(runner, "barnes-hut-layout", barnesHutLayout, parser.value(graphNodesOption).toInt(), params.seed);
+
+    // Scene lookups by pointer and ID, across a large document. These used to be
+    // linear scans, called once per scene in many places.
+    if(runner.isEnabled("lookups"))
+    {
+        SyntheticDocument::Parameters lookupParams = params;
+        lookupParams.scenes = qMax(1, parser.value(lookupScenesOption).toInt());
+        lookupParams.paragraphsPerScene = 1;
+        lookupParams.photos = 0;
+        SyntheticDocument::generate(document, lookupParams);
+
+        Structure *structure = document->structure();
+        Screenplay *screenplay = document->screenplay();
+
+        QList<Scene*> scenes;
+        QStringList sceneIds;
+        for(int i=0; i<structure->elementCount(); i++)
+        {
+            Scene *scene = structure->elementAt(i)->scene();
+            scenes << scene;
+            sceneIds << scene->id();
+        }
+
+        int hits = 0;
+        runner.run("lookups", [&]() {
+            hits = 0;
+            for(int i=0; i<scenes.size(); i++)
+            {
+                Scene *scene = scenes.at(i);
+                hits += structure->indexOfScene(scene) == i ? 1 : 0;
+                hits += structure->findElementBySceneID(sceneIds.at(i)) != nullptr ? 1 : 0;
+                hits += screenplay->indexOfElement(screenplay->elementAt(i)) == i ? 1 : 0;
+                hits += screenplay->sceneElementIndexes(scene).size();
+            }
+        });
+        runner.addMetric("scenes", scenes.size());
+        runner.addMetric("hits", hits);
+    }
+
+    // Loading creates thousands of objects in one go, which is where the cost
+    // of per-object event traffic shows up.
+    if(runner.isEnabled("large-load"))
+    {
+        SyntheticDocument::Parameters largeParams = params;
+        largeParams.scenes = qMax(1, parser.value(largeLoadScenesOption).toInt());
+        largeParams.photos = 0;
+        SyntheticDocument::generate(document, largeParams);
+
+        const QString largeFile = tempDir.filePath("large.scrite");
+        document->saveAs(largeFile);
+
+        runner.run("large-load", [&]() {
+            document->openAnonymously(largeFile);
+        });
+        runner.addMetric("scenes", document->screenplay()->elementCount());
+        runner.addMetric("fileSize", QFileInfo(largeFile).size());
+    }
+
+    // Page images, as shown in print preview and as written to image files.
+    // The sequential variants paint through ImagePrinter's paint engine, one
+    // page after another, which is how all pages used to be painted.
+    const QStringList pageImageBenchmarks = QStringList() << "page-images-sequential" << "page-images-parallel"
+                                                          << "page-image-export-sequential" << "page-image-export-parallel";
+    bool pageImageBenchmarksEnabled = false;
+    for(const QString &name : pageImageBenchmarks)
+        pageImageBenchmarksEnabled |= runner.isEnabled(name);
+
+    if(pageImageBenchmarksEnabled)
+    {
+        SyntheticDocument::Parameters pageImageParams = params;
+        pageImageParams.scenes = qMax(1, parser.value(pageImageScenesOption).toInt());
+        SyntheticDocument::generate(document, pageImageParams);
+
+        ScreenplayTextDocument textDocument;
+        textDocument.setPurpose(ScreenplayTextDocument::ForPrinting);
+        textDocument.setFormatting(document->printFormat());
+        textDocument.setScreenplay(document->screenplay());
+        textDocument.syncNow();
+
+        const QString exportDirectory = tempDir.filePath("pages");
+        for(int i=0; i<pageImageBenchmarks.size(); i++)
+        {
+            const bool parallel = i%2 == 1;
+            const bool exportFiles = i >= 2;
+
+            QScopedPointer<ImagePrinter> imagePrinter;
+            runner.run(pageImageBenchmarks.at(i), [&]() {
+                if(parallel)
+                    textDocument.print(imagePrinter.data());
+                else
+                {
+                    QTextDocumentPagedPrinter docPrinter;
+                    docPrinter.print(textDocument.textDocument(), imagePrinter.data());
+                }
+            }, [&]() {
+                QDir(exportDirectory).removeRecursively();
+
+                imagePrinter.reset(new ImagePrinter);
+                imagePrinter->setScale(2);
+                imagePrinter->setDirectory(exportFiles ? exportDirectory : QString());
+                document->printFormat()->pageLayout()->configure(imagePrinter.data());
+                imagePrinter->setPageMargins(QMarginsF(0.2,0.1,0.2,0.1), QPageLayout::Inch);
+            });
+            runner.addMetric("pages", imagePrinter->pageCount());
+            runner.addMetric("threads", parallel ? QThread::idealThreadCount() : 1);
+        }
+
+        reloadDocument();
+    }
+
+    QJsonObject report;
+    report.insert("benchmark", "scrite");
+    report.insert("version", applicationVersion.toString());
+    report.insert("commit", parser.isSet(commitOption) ? parser.value(commitOption) : QString::fromLatin1(qgetenv("SCRITE_COMMIT")));
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("qtVersion", QString::fromLatin1(qVersion()));
+    report.insert("platform", QSysInfo::prettyProductName());
+    report.insert("cpuArchitecture", QSysInfo::currentCpuArchitecture());
+    report.insert("iterations", runner.iterations());
+    report.insert("parameters", params.toJson());
+    report.insert("results", runner.results());
+
+    const QByteArray bytes = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if(parser.isSet(outputOption))
+    {
+        QFile file(parser.value(outputOption));
+        if(!file.open(QFile::WriteOnly))
+        {
+            fprintf(stderr, "Could not write to %s\n", qPrintable(file.fileName()));
+            return 1;
+        }
+
+        file.write(bytes);
+    }
+    else
+        fprintf(stdout, "%s", bytes.constData());
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "syntheticdocument.h"
+
+#include "scene.h"
+#include "structure.h"
+#include "screenplay.h"
+#include "scritedocument.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QJsonArray>
+
+struct SyntheticScript
+{
+    const char *language;
+    ushort firstLetter;
+    ushort lastLetter;
+};
+
+// Consonant blocks of each script. Words are made up of letters picked from these,
+// which is enough to exercise font fallback and complex text shaping.
+static const SyntheticScript syntheticScripts[] = {
+    { "English", 'a', 'z' },
+    { "Bengali", 0x0995, 0x09A8 },
+    { "Gujarati", 0x0A95, 0x0AA8 },
+    { "Hindi", 0x0915, 0x0939 },
+    { "Kannada", 0x0C95, 0x0CA8 },
+    { "Malayalam", 0x0D15, 0x0D28 },
+    { "Marathi", 0x0915, 0x0939 },
+    { "Oriya", 0x0B15, 0x0B28 },
+    { "Punjabi", 0x0A15, 0x0A28 },
+    { "Sanskrit", 0x0915, 0x0939 },
+    { "Tamil", 0x0B95, 0x0B9A },
+    { "Telugu", 0x0C15, 0x0C28 }
+};
+static const int syntheticScriptCount = int(sizeof(syntheticScripts)/sizeof(SyntheticScript));
+
+QJsonObject SyntheticDocument::Parameters::toJson() const
+{
+    QJsonObject ret;
+    ret.insert("scenes", scenes);
+    ret.insert("paragraphsPerScene", paragraphsPerScene);
+    ret.insert("characters", characters);
+    ret.insert("locations", locations);
+    ret.insert("photos", photos);
+    ret.insert("languages", QJsonArray::fromStringList(languages));
+    ret.insert("seed", qint64(seed));
+    return ret;
+}
+
+QStringList SyntheticDocument::supportedLanguages()
+{
+    QStringList ret;
+    for(int i=0; i<syntheticScriptCount; i++)
+        ret << QString::fromLatin1(syntheticScripts[i].language);
+    return ret;
+}
+
+SyntheticDocument::SyntheticDocument(const Parameters &params)
+    : m_params(params), m_random(params.seed)
+{
+    // Language names are resolved to indexes into syntheticScripts once, so that
+    // word() doesn't have to look them up.
+    const QStringList known = supportedLanguages();
+    for(const QString &language : qAsConst(m_params.languages))
+    {
+        const int index = known.indexOf(language);
+        if(index >= 0)
+            m_scripts.append(index);
+    }
+
+    if(m_scripts.isEmpty())
+        m_scripts.append(0);
+}
+
+QString SyntheticDocument::word(int language)
+{
+    const SyntheticScript &script = syntheticScripts[m_scripts.at(language % m_scripts.size())];
+    const int length = m_random.bounded(2, 9);
+
+    QString ret;
+    ret.reserve(length);
+    for(int i=0; i<length; i++)
+        ret += QChar(ushort(m_random.bounded(int(script.firstLetter), int(script.lastLetter)+1)));
+    return ret;
+}
+
+QString SyntheticDocument::sentence(int language, int minWords, int maxWords)
+{
+    const int nrWords = m_random.bounded(minWords, maxWords+1);
+
+    QStringList words;
+    words.reserve(nrWords);
+    for(int i=0; i<nrWords; i++)
+        words << this->word(language);
+
+    QString ret = words.join(QStringLiteral(" "));
+    if(!ret.isEmpty())
+        ret[0] = ret.at(0).toUpper();
+    return ret + QStringLiteral(".");
+}
+
+QString SyntheticDocument::name(int language)
+{
+    return this->word(language).toUpper();
+}
+
+void SyntheticDocument::generate(ScriteDocument *document, const Parameters &params)
+{
+    SyntheticDocument generator(params);
+    const Parameters &p = generator.m_params;
+    QRandomGenerator &random = generator.m_random;
+    const int nrLanguages = generator.m_scripts.size();
+
+    document->reset();
+    document->blockUI();
+
+    Structure *structure = document->structure();
+    Screenplay *screenplay = document->screenplay();
+    screenplay->setTitle(QStringLiteral("Synthetic Screenplay"));
+
+    QStringList characterNames;
+    for(int i=0; i<p.characters; i++)
+    {
+        QString name = generator.name(i % nrLanguages);
+        while(characterNames.contains(name))
+            name += QChar('A' + (characterNames.size() % 26));
+        characterNames << name;
+
+        Character *character = structure->addCharacter(name);
+        if(character == nullptr || i >= p.photos)
+            continue;
+
+        QImage photo(512, 512, QImage::Format_RGB32);
+        photo.fill(QColor::fromHsv(random.bounded(360), 128, 200));
+
+        QPainter paint(&photo);
+        for(int j=0; j<32; j++)
+        {
+            const QColor color = QColor::fromHsv(random.bounded(360), random.bounded(256), random.bounded(256));
+            paint.fillRect(random.bounded(448), random.bounded(448), random.bounded(16,64), random.bounded(16,64), color);
+        }
+        paint.end();
+
+        const QString dstPath = QStringLiteral("characters/synthetic_") + QString::number(i) + QStringLiteral(".jpg");
+        const QString dfsPath = document->fileSystem()->addImage(photo, dstPath, QSize(512,512), true);
+        if(!dfsPath.isEmpty())
+            character->setPhotos(QStringList() << dfsPath);
+    }
+
+    if(characterNames.isEmpty())
+        characterNames << QStringLiteral("SOMEONE");
+
+    const int nrLocations = p.locations > 0 ? p.locations : qMax(1, p.scenes/5);
+    QStringList locations;
+    for(int i=0; i<nrLocations; i++)
+        locations << generator.name(i % nrLanguages) + QStringLiteral(" ") + generator.name(i % nrLanguages);
+
+    static const QStringList locationTypes = QStringList() << QStringLiteral("INT") << QStringLiteral("EXT") << QStringLiteral("I/E");
+    static const QStringList moments = QStringList() << QStringLiteral("DAY") << QStringLiteral("NIGHT") << QStringLiteral("MORNING") << QStringLiteral("EVENING");
+
+    for(int i=0; i<p.scenes; i++)
+    {
+        const int language = i % nrLanguages;
+
+        StructureElement *structureElement = new StructureElement(structure);
+        Scene *scene = new Scene(structureElement);
+        scene->setColor(QColor::fromHsv(random.bounded(360), 160, 230));
+        scene->setTitle(generator.sentence(language, 4, 12));
+        structureElement->setScene(scene);
+        structureElement->setX(100 + (i%2 ? 400 : 0));
+        structureElement->setY(100 + 200*i);
+        structure->addElement(structureElement);
+
+        ScreenplayElement *screenplayElement = new ScreenplayElement(screenplay);
+        screenplayElement->setScene(scene);
+        screenplay->addElement(screenplayElement);
+
+        SceneHeading *heading = scene->heading();
+        heading->setEnabled(true);
+        heading->setLocationType(locationTypes.at(random.bounded(locationTypes.size())));
+        heading->setLocation(locations.at(random.bounded(locations.size())));
+        heading->setMoment(moments.at(random.bounded(moments.size())));
+
+        // Paragraphs follow the usual rhythm of a screenplay: some action,
+        // followed by an exchange of dialogues, with the occasional parenthetical.
+        int paragraphIndex = 0;
+        while(paragraphIndex < p.paragraphsPerScene)
+        {
+            const bool action = paragraphIndex == 0 || random.bounded(4) == 0;
+            if(action)
+            {
+                QString text = generator.sentence(language, 8, 40);
+                if(random.bounded(8) == 0)
+                    text += QStringLiteral(" ") + searchWord() + QStringLiteral(".");
+
+                SceneElement *para = new SceneElement;
+                para->setType(SceneElement::Action);
+                para->setText(text);
+                scene->addElement(para);
+                ++paragraphIndex;
+                continue;
+            }
+
+            SceneElement *character = new SceneElement;
+            character->setType(SceneElement::Character);
+            character->setText(characterNames.at(random.bounded(characterNames.size())));
+            scene->addElement(character);
+            ++paragraphIndex;
+
+            if(paragraphIndex < p.paragraphsPerScene && random.bounded(5) == 0)
+            {
+                SceneElement *parenthetical = new SceneElement;
+                parenthetical->setType(SceneElement::Parenthetical);
+                parenthetical->setText(QStringLiteral("(") + generator.word(language) + QStringLiteral(")"));
+                scene->addElement(parenthetical);
+                ++paragraphIndex;
+            }
+
+            if(paragraphIndex < p.paragraphsPerScene)
+            {
+                SceneElement *dialogue = new SceneElement;
+                dialogue->setType(SceneElement::Dialogue);
+                dialogue->setText(generator.sentence(language, 3, 30));
+                scene->addElement(dialogue);
+                ++paragraphIndex;
+            }
+        }
+    }
+
+    document->unblockUI();
+}
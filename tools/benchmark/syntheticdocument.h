@@ -0,0 +1,65 @@
+/****************************************************************************
+**
+** Copyright (C) TERIFLIX Entertainment Spaces Pvt. Ltd. Bengaluru
+** Author: Prashanth N Udupa (prashanth.udupa@teriflix.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef SYNTHETICDOCUMENT_H
+#define SYNTHETICDOCUMENT_H
+
+#include <QJsonObject>
+#include <QVector>
+#include <QStringList>
+#include <QRandomGenerator>
+
+class ScriteDocument;
+
+/**
+ * Fills a ScriteDocument with made-up (but screenplay shaped) content. The same
+ * parameters and seed always produce the same document, so that numbers from
+ * different commits can be compared.
+ */
+class SyntheticDocument
+{
+public:
+    struct Parameters
+    {
+        int scenes = 500;
+        int paragraphsPerScene = 12;
+        int characters = 40;
+        int locations = 0;              // 0 means scenes/5
+        int photos = 0;                 // characters that get a photo
+        QStringList languages = QStringList() << QStringLiteral("English");
+        quint32 seed = 1;
+
+        QJsonObject toJson() const;
+    };
+
+    // Resets the document and generates content into it. Words that look like
+    // searchWord() are sprinkled into action paragraphs, so that search and
+    // replace have something to find.
+    static void generate(ScriteDocument *document, const Parameters &params);
+
+    static QString searchWord() { return QStringLiteral("scritebench"); }
+    static QStringList supportedLanguages();
+
+private:
+    SyntheticDocument(const Parameters &params);
+
+    QString word(int language);
+    QString sentence(int language, int minWords, int maxWords);
+    QString name(int language);
+
+    Parameters m_params;
+    QVector<int> m_scripts;
+    QRandomGenerator m_random;
+};
+
+#endif // SYNTHETICDOCUMENT_H